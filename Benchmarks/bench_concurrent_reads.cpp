@@ -0,0 +1,130 @@
+/*
+    Lock-free readers on the versions of a 100k objects fpSet<int, std::less<>, fpConcurrentSlots<>>.
+    Every reader thread runs contains_unchecked on random objects of random published versions,
+    the total number of lookups is the same for every row.
+        readers only    - the set does not change while it is read.
+        + 1 writer      - one more thread inserts up to 20000 new versions while the readers run.
+    The ms column is the wall time of all the readers, the last column is the read throughput.
+    A flat engine row (readers only, one thread) shows the cost of the concurrent engine itself.
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+
+#include <atomic>
+#include <optional>
+#include <thread>
+
+#define PDS_BENCH_OBJS 100000
+#define PDS_BENCH_UPDATES 1000
+#define PDS_BENCH_LOOKUPS 1000000
+#define PDS_BENCH_WRITES 20000
+
+template <class SET>
+void fill(SET& fps, std::mt19937& gen){
+
+    for(std::size_t i = 0; i < PDS_BENCH_UPDATES; ++i){
+
+        int obj = static_cast<int>(gen() % (2 * PDS_BENCH_OBJS));
+
+        if(fps.contains_unchecked(obj, fps.curr_version()))
+            fps.remove(obj);
+        else
+            fps.insert(obj);
+    }
+}
+
+template <class SET>
+double bench_readers(SET& fps, unsigned threads, bool with_writer){
+
+    std::atomic<bool> done = false;
+    std::thread writer;
+
+    if(with_writer){
+
+        writer = std::thread([&]{
+            // objects that were never inserted, above all the objects of the readers.
+            static int next_obj = 2 * PDS_BENCH_OBJS;
+
+            for(int i = 0; i < PDS_BENCH_WRITES && !done; ++i)
+                fps.insert(next_obj++);
+        });
+    }
+
+    std::vector<std::thread> readers;
+    std::atomic<std::size_t> found = 0;
+    pds_bench::Timer timer;
+
+    for(unsigned t = 0; t < threads; ++t){
+
+        readers.emplace_back([&, t]{
+
+            std::mt19937 gen(t);
+            std::size_t hits = 0;
+
+            for(std::size_t i = 0; i < PDS_BENCH_LOOKUPS / threads; ++i){
+
+                pds::version_t v = 2 + gen() % (fps.curr_version() - 1);
+                hits += fps.contains_unchecked(static_cast<int>(gen() % (2 * PDS_BENCH_OBJS)), v);
+            }
+            found += hits;
+        });
+    }
+
+    for(std::thread& reader : readers)
+        reader.join();
+
+    double ms = timer.ms();
+    done = true;
+
+    if(writer.joinable())
+        writer.join();
+
+    pds_bench::do_not_optimize(found.load());
+    return ms;
+}
+
+void print_throughput(const std::string& name, double ms){
+
+    std::printf("  %-36s %10.2f ms %9.2f Mlookups/s\n", name.c_str(), ms, PDS_BENCH_LOOKUPS / ms / 1000);
+}
+
+int main(){
+
+    std::vector<int> objs(PDS_BENCH_OBJS);
+
+    for(std::size_t i = 0; i < objs.size(); ++i)
+        objs[i] = static_cast<int>(2 * i);
+
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("bench_concurrent_reads: %d objects, %d versions, %d lookups, %u hardware threads\n",
+        PDS_BENCH_OBJS, PDS_BENCH_UPDATES, PDS_BENCH_LOOKUPS, cores);
+
+    {
+        using fpBenchSet = pds::fpSet<int, std::less<>, pds::fpFlatSlots<>>;
+
+        std::optional<fpBenchSet> fps;
+        fps.emplace(fpBenchSet::from_sorted(objs.begin(), objs.end()));
+
+        std::mt19937 gen(42);
+        fill(*fps, gen);
+
+        print_throughput("flat, 1 reader", bench_readers(*fps, 1, false));
+    }
+
+    using fpBenchSet = pds::fpSet<int, std::less<>, pds::fpConcurrentSlots<>>;
+
+    std::optional<fpBenchSet> fps;
+    fps.emplace(fpBenchSet::from_sorted(objs.begin(), objs.end()));
+
+    std::mt19937 gen(42);
+    fill(*fps, gen);
+
+    for(unsigned threads = 1; threads <= std::max(4u, cores); threads *= 2){
+
+        print_throughput("concurrent, " + std::to_string(threads) + " readers", bench_readers(*fps, threads, false));
+        print_throughput("concurrent, " + std::to_string(threads) + " readers + 1 writer", bench_readers(*fps, threads, true));
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*
+    One million lookups on random versions.
+        contains            - validates the version, then descends with the checked trackers.
+        contains_unchecked  - the caller validated the version already, the descent does a
+                              single lookup per level and has no exception machinery.
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+#include "pSet.hpp"
+
+#define PDS_BENCH_OBJS 10000
+#define PDS_BENCH_LOOKUPS 1000000
+
+template <class SET, class LOOKUP>
+double bench_lookups(SET& set, const std::vector<int>& objs, LOOKUP&& lookup){
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<pds::version_t> version(1, set.curr_version());
+    std::uniform_int_distribution<std::size_t> obj(0, objs.size() - 1);
+
+    std::size_t found = 0;
+    pds_bench::Timer timer;
+
+    for(std::size_t i = 0; i < PDS_BENCH_LOOKUPS; ++i)
+        found += lookup(set, objs[obj(gen)], version(gen));
+
+    double ms = timer.ms();
+    pds_bench::do_not_optimize(found);
+    return ms;
+}
+
+int main(){
+
+    std::vector<int> objs(PDS_BENCH_OBJS);
+
+    for(std::size_t i = 0; i < objs.size(); ++i)
+        objs[i] = static_cast<int>(i);
+
+    std::shuffle(objs.begin(), objs.end(), std::mt19937(42));
+
+    pds::fpSet<int, std::less<>, pds::fpFlatSlots<>> fps;
+    pds::pSet<int> ps;
+
+    for(int obj : objs){
+
+        fps.insert(obj);
+        ps.insert(obj);
+    }
+
+    std::printf("bench_contains: %d objects, %d lookups on random versions\n", PDS_BENCH_OBJS, PDS_BENCH_LOOKUPS);
+
+    pds_bench::print_row("fpSet::contains", bench_lookups(fps, objs, 
+        [](auto& s, int obj, pds::version_t v){ return s.contains(obj, v); }), 0);
+
+    pds_bench::print_row("fpSet::contains_unchecked", bench_lookups(fps, objs, 
+        [](auto& s, int obj, pds::version_t v){ return s.contains_unchecked(obj, v); }), 0);
+
+    pds_bench::print_row("pSet::contains", bench_lookups(ps, objs, 
+        [](auto& s, int obj, pds::version_t v){ return s.contains(obj, v); }), 0);
+
+    pds_bench::print_row("pSet::contains_unchecked", bench_lookups(ps, objs, 
+        [](auto& s, int obj, pds::version_t v){ return s.contains_unchecked(obj, v); }), 0);
+
+    return 0;
+}
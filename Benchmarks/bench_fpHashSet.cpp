@@ -0,0 +1,65 @@
+/*
+    Unordered keys (random 32 hex digit ids): fpHashSet vs fpSet.
+
+    Rows:
+        <set> insert        - PDS_BENCH_KEYS inserts, one version each (bytes: the growth).
+        <set> contains      - PDS_BENCH_LOOKUPS lookups of random ids (half of them inserted) in random versions.
+*/
+#include "bench_utils.h"
+#include "fpHashSet.hpp"
+
+#include <vector>
+
+#define PDS_BENCH_KEYS 100000
+#define PDS_BENCH_LOOKUPS 100000
+
+template <class SET>
+void bench_set(const std::string& name, const std::vector<std::string>& ids){
+
+    SET set;
+
+    pds_bench::Timer insert_timer;
+    std::size_t insert_bytes = pds_bench::bytes_of([&]{
+
+        for(int i = 0; i < PDS_BENCH_KEYS; ++i)
+            set.insert(ids[i]);
+    });
+    double insert_ms = insert_timer.ms();
+
+    std::mt19937 gen(7);
+    std::size_t found = 0;
+
+    pds_bench::Timer contains_timer;
+    for(int i = 0; i < PDS_BENCH_LOOKUPS; ++i){
+
+        pds::version_t version = 2 + gen() % (set.curr_version() - 1);
+        found += set.contains(ids[gen() % ids.size()], version);
+    }
+    double contains_ms = contains_timer.ms();
+    pds_bench::do_not_optimize(found);
+
+    pds_bench::print_row(name + " insert", insert_ms, insert_bytes);
+    pds_bench::print_row(name + " contains", contains_ms, 0);
+}
+
+int main(){
+
+    std::mt19937_64 gen(42);
+    std::vector<std::string> ids(2 * PDS_BENCH_KEYS);
+
+    for(std::string& id : ids){
+
+        char buf[33];
+        std::snprintf(buf, sizeof(buf), "%016llx%016llx", (unsigned long long)gen(), (unsigned long long)gen());
+        id = buf;
+    }
+
+    std::printf("bench_fpHashSet: %d ids, %d lookups\n", PDS_BENCH_KEYS, PDS_BENCH_LOOKUPS);
+
+    bench_set<pds::fpHashSet<std::string>>("fpHashSet<fpHashSlots>", ids);
+    bench_set<pds::fpHashSet<std::string, std::hash<std::string>, pds::fpFlatSlots<2>>>("fpHashSet<fpFlatSlots<2>>", ids);
+    bench_set<pds::fpSet<std::string>>("fpSet<fpHashSlots>", ids);
+    bench_set<pds::fpSet<std::string, std::less<>, pds::fpFlatSlots<2>>>("fpSet<fpFlatSlots<2>>", ids);
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+    Versioned edits of a sequence: fpList vs a std::vector that is copied for every version.
+
+    Rows:
+        <list> edit         - PDS_BENCH_EDITS inserts and erases at random positions of the last version,
+                              on a sequence of PDS_BENCH_SIZE objects, one version each (bytes: the growth).
+        <list> at           - the object at a random position of a random version, PDS_BENCH_EDITS times.
+*/
+#include "bench_utils.h"
+#include "fpList.hpp"
+
+#include <vector>
+
+#define PDS_BENCH_SIZE 10000
+#define PDS_BENCH_EDITS 10000
+
+template <class SLOTS>
+void bench_list(const std::string& name){
+
+    pds::fpList<int, SLOTS> list;
+    std::mt19937 gen(42);
+
+    for(int i = 0; i < PDS_BENCH_SIZE; ++i)
+        list.push_back(i);
+
+    pds::version_t first = list.curr_version();
+
+    pds_bench::Timer edit_timer;
+    std::size_t edit_bytes = pds_bench::bytes_of([&]{
+
+        for(int i = 0; i < PDS_BENCH_EDITS; ++i){
+
+            if(i % 2 == 0)
+                list.insert_at(gen() % (list.size() + 1), i);
+            else
+                list.erase_at(gen() % list.size());
+        }
+    });
+    double edit_ms = edit_timer.ms();
+
+    long sum = 0;
+
+    pds_bench::Timer at_timer;
+    for(int i = 0; i < PDS_BENCH_EDITS; ++i){
+
+        pds::version_t version = first + gen() % (list.curr_version() - first + 1);
+        sum += list.at(gen() % list.size(version), version);
+    }
+    double at_ms = at_timer.ms();
+    pds_bench::do_not_optimize(sum);
+
+    pds_bench::print_row(name + " edit", edit_ms, edit_bytes);
+    pds_bench::print_row(name + " at", at_ms, 0);
+}
+
+void bench_vector_copies(){
+
+    std::vector<std::vector<int>> versions(1);
+    std::mt19937 gen(42);
+
+    for(int i = 0; i < PDS_BENCH_SIZE; ++i)
+        versions[0].push_back(i);
+
+    pds_bench::Timer edit_timer;
+    std::size_t edit_bytes = pds_bench::bytes_of([&]{
+
+        versions.reserve(PDS_BENCH_EDITS + 1);
+
+        for(int i = 0; i < PDS_BENCH_EDITS; ++i){
+
+            std::vector<int> next = versions.back();
+
+            if(i % 2 == 0)
+                next.insert(next.begin() + gen() % (next.size() + 1), i);
+            else
+                next.erase(next.begin() + gen() % next.size());
+
+            versions.push_back(std::move(next));
+        }
+    });
+    double edit_ms = edit_timer.ms();
+
+    long sum = 0;
+
+    pds_bench::Timer at_timer;
+    for(int i = 0; i < PDS_BENCH_EDITS; ++i){
+
+        const std::vector<int>& version = versions[gen() % versions.size()];
+        sum += version[gen() % version.size()];
+    }
+    double at_ms = at_timer.ms();
+    pds_bench::do_not_optimize(sum);
+
+    pds_bench::print_row("std::vector copies edit", edit_ms, edit_bytes);
+    pds_bench::print_row("std::vector copies at", at_ms, 0);
+}
+
+int main(){
+
+    std::printf("bench_fpList: %d objects, %d edits\n", PDS_BENCH_SIZE, PDS_BENCH_EDITS);
+
+    bench_list<pds::fpHashSlots>("fpList<fpHashSlots>");
+    bench_list<pds::fpFlatSlots<2>>("fpList<fpFlatSlots<2>>");
+    bench_vector_copies();
+
+    return 0;
+}
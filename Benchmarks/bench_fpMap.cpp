@@ -0,0 +1,119 @@
+/*
+    Versioned key -> value updates: fpMap::put vs an fpSet of (key, value) pairs,
+    where a new value is a remove of the old pair and an insert of the new one.
+
+    Rows:
+        <map> build         - PDS_BENCH_KEYS new keys, one version each.
+        <map> update        - PDS_BENCH_UPDATES new values of random keys of the last version (bytes: the growth).
+        <map> get           - the value of a random key in a random version, PDS_BENCH_UPDATES times.
+*/
+#include "bench_utils.h"
+#include "fpMap.hpp"
+
+#include <malloc.h>
+
+#define PDS_BENCH_KEYS 10000
+#define PDS_BENCH_UPDATES 100000
+
+template <class SLOTS>
+void bench_map(const std::string& name, const std::vector<int>& keys){
+
+    pds::fpMap<int, int, SLOTS> map;
+
+    pds_bench::Timer build_timer;
+    std::size_t build_bytes = pds_bench::bytes_of([&]{
+
+        for(int k = 0; k < PDS_BENCH_KEYS; ++k)
+            map.put(k, 0);
+    });
+    double build_ms = build_timer.ms();
+
+    pds_bench::Timer update_timer;
+    std::size_t update_bytes = pds_bench::bytes_of([&]{
+
+        for(std::size_t i = 0; i < keys.size(); ++i)
+            map.put(keys[i], i + 1);
+    });
+    double update_ms = update_timer.ms();
+
+    std::mt19937 gen(7);
+    long sum = 0;
+
+    pds_bench::Timer get_timer;
+    for(std::size_t i = 0; i < keys.size(); ++i){
+
+        pds::version_t version = PDS_BENCH_KEYS + 1 + gen() % (map.curr_version() - PDS_BENCH_KEYS);
+        sum += map.get(keys[i], version);
+    }
+    double get_ms = get_timer.ms();
+    pds_bench::do_not_optimize(sum);
+
+    pds_bench::print_row(name + " build", build_ms, build_bytes);
+    pds_bench::print_row(name + " update", update_ms, update_bytes);
+    pds_bench::print_row(name + " get", get_ms, 0);
+}
+
+template <class SLOTS>
+void bench_pairs(const std::string& name, const std::vector<int>& keys){
+
+    pds::fpSet<std::pair<int, int>, std::less<>, SLOTS> set;
+    std::vector<int> values(PDS_BENCH_KEYS, 0);
+
+    pds_bench::Timer build_timer;
+    std::size_t build_bytes = pds_bench::bytes_of([&]{
+
+        for(int k = 0; k < PDS_BENCH_KEYS; ++k)
+            set.insert({k, 0});
+    });
+    double build_ms = build_timer.ms();
+
+    pds_bench::Timer update_timer;
+    std::size_t update_bytes = pds_bench::bytes_of([&]{
+
+        for(std::size_t i = 0; i < keys.size(); ++i){
+
+            set.remove({keys[i], values[keys[i]]});
+            set.insert({keys[i], values[keys[i]] = i + 1});
+        }
+    });
+    double update_ms = update_timer.ms();
+
+    std::mt19937 gen(7);
+    long sum = 0;
+
+    pds_bench::Timer get_timer;
+    for(std::size_t i = 0; i < keys.size(); ++i){
+
+        pds::version_t version = PDS_BENCH_KEYS + 1 + gen() % (set.curr_version() - PDS_BENCH_KEYS);
+        sum += set.lower_bound({keys[i], 0}, version)->second;
+    }
+    double get_ms = get_timer.ms();
+    pds_bench::do_not_optimize(sum);
+
+    pds_bench::print_row(name + " build", build_ms, build_bytes);
+    pds_bench::print_row(name + " update", update_ms, update_bytes);
+    pds_bench::print_row(name + " get", get_ms, 0);
+}
+
+int main(){
+
+    std::mt19937 gen(42);
+    std::vector<int> keys(PDS_BENCH_UPDATES);
+
+    for(int& k : keys)
+        k = static_cast<int>(gen() % PDS_BENCH_KEYS);
+
+    std::printf("bench_fpMap: %d keys, %d value updates\n", PDS_BENCH_KEYS, PDS_BENCH_UPDATES);
+
+    // Every run frees a few hundred MB. malloc_trim returns them before the next run, 
+    // which would pay for consolidating the free chunks in its first allocations otherwise.
+    bench_map<pds::fpHashSlots>("fpMap<fpHashSlots>", keys);
+    malloc_trim(0);
+    bench_pairs<pds::fpHashSlots>("fpSet<pair, fpHashSlots>", keys);
+    malloc_trim(0);
+    bench_map<pds::fpFlatSlots<2>>("fpMap<fpFlatSlots<2>>", keys);
+    malloc_trim(0);
+    bench_pairs<pds::fpFlatSlots<2>>("fpSet<pair, fpFlatSlots<2>>", keys);
+
+    return 0;
+}
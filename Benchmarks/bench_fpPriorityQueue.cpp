@@ -0,0 +1,99 @@
+/*
+    A scheduler history: fpPriorityQueue vs a std::priority_queue that is copied for every version.
+
+    Rows:
+        <queue> run         - PDS_BENCH_OPS pushes and pops on the last version (two pushes for every pop),
+                              one version each, so the queue grows to PDS_BENCH_OPS / 3 objects (bytes: the growth).
+        <queue> top         - "what was pending first at time T": the top of a random version, PDS_BENCH_OPS times.
+*/
+#include "bench_utils.h"
+#include "fpPriorityQueue.hpp"
+
+#include <queue>
+#include <vector>
+
+#define PDS_BENCH_OPS 30000
+
+template <class SLOTS>
+void bench_queue(const std::string& name){
+
+    pds::fpPriorityQueue<int, SLOTS> queue;
+    std::mt19937 gen(42);
+
+    pds_bench::Timer run_timer;
+    std::size_t run_bytes = pds_bench::bytes_of([&]{
+
+        for(int i = 0; i < PDS_BENCH_OPS; ++i){
+
+            if(i % 3 == 2)
+                queue.pop();
+            else
+                queue.push(gen() % 1000000);
+        }
+    });
+    double run_ms = run_timer.ms();
+
+    long sum = 0;
+
+    pds_bench::Timer top_timer;
+    for(int i = 0; i < PDS_BENCH_OPS; ++i){
+
+        pds::version_t version = 2 + gen() % (queue.curr_version() - 1);
+        sum += queue.top(version);
+    }
+    double top_ms = top_timer.ms();
+    pds_bench::do_not_optimize(sum);
+
+    pds_bench::print_row(name + " run", run_ms, run_bytes);
+    pds_bench::print_row(name + " top", top_ms, 0);
+}
+
+void bench_queue_copies(){
+
+    using Queue = std::priority_queue<int, std::vector<int>, std::greater<int>>;
+
+    std::vector<Queue> versions(1);
+    std::mt19937 gen(42);
+
+    pds_bench::Timer run_timer;
+    std::size_t run_bytes = pds_bench::bytes_of([&]{
+
+        versions.reserve(PDS_BENCH_OPS + 1);
+
+        for(int i = 0; i < PDS_BENCH_OPS; ++i){
+
+            Queue next = versions.back();
+
+            if(i % 3 == 2)
+                next.pop();
+            else
+                next.push(gen() % 1000000);
+
+            versions.push_back(std::move(next));
+        }
+    });
+    double run_ms = run_timer.ms();
+
+    long sum = 0;
+
+    pds_bench::Timer top_timer;
+    for(int i = 0; i < PDS_BENCH_OPS; ++i)
+        sum += versions[1 + gen() % (versions.size() - 1)].top();
+
+    double top_ms = top_timer.ms();
+    pds_bench::do_not_optimize(sum);
+
+    pds_bench::print_row("std::priority_queue copies run", run_ms, run_bytes);
+    pds_bench::print_row("std::priority_queue copies top", top_ms, 0);
+}
+
+int main(){
+
+    std::printf("bench_fpPriorityQueue: %d pushes and pops\n", PDS_BENCH_OPS);
+
+    bench_queue<pds::fpHashSlots>("fpPriorityQueue<fpHashSlots>");
+    bench_queue<pds::fpFlatSlots<2>>("fpPriorityQueue<fpFlatSlots<2>>");
+    bench_queue_copies();
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*
+    Loading a snapshot of N objects into fpSet:
+        insert  - one version per object, N versions.
+        apply   - one batch, a single version.
+        from_sorted - one linear pass over the sorted objects.
+    Then a nightly-import style update: a batch of 1% inserts and removes on the last version.
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+
+#include <optional>
+
+#define PDS_BENCH_OBJS 100000
+
+using fpBenchSet = pds::fpSet<int, std::less<>, pds::fpFlatSlots<>>;
+
+int main(){
+
+    std::vector<int> objs(PDS_BENCH_OBJS);
+
+    for(std::size_t i = 0; i < objs.size(); ++i)
+        objs[i] = static_cast<int>(2 * i);
+
+    std::shuffle(objs.begin(), objs.end(), std::mt19937(42));
+
+    std::printf("bench_fpSet_apply: snapshot of %d objects\n", PDS_BENCH_OBJS);
+
+    {
+        std::optional<fpBenchSet> fps;
+        pds_bench::Timer timer;
+
+        std::size_t bytes = pds_bench::bytes_of([&]{
+            fps.emplace();
+            for(int obj : objs)
+                fps->insert(obj);
+        });
+        pds_bench::print_row("insert one by one", timer.ms(), bytes);
+    }
+
+    {
+        std::vector<int> sorted = objs;
+        std::sort(sorted.begin(), sorted.end());
+
+        std::optional<fpBenchSet> fps;
+        pds_bench::Timer timer;
+
+        std::size_t bytes = pds_bench::bytes_of([&]{
+            fps.emplace(fpBenchSet::from_sorted(sorted.begin(), sorted.end()));
+        });
+        pds_bench::print_row("from_sorted", timer.ms(), bytes);
+    }
+
+    std::optional<fpBenchSet> fps;
+    std::vector<pds::fpBatchOp<int>> snapshot;
+
+    for(int obj : objs)
+        snapshot.push_back({pds::fpOp::insert, obj});
+
+    pds_bench::Timer timer;
+
+    std::size_t bytes = pds_bench::bytes_of([&]{
+        fps.emplace();
+        fps->apply(std::move(snapshot));
+    });
+    pds_bench::print_row("apply one batch", timer.ms(), bytes);
+
+    // 1% of the objects are replaced by new ones:
+    std::vector<pds::fpBatchOp<int>> update;
+
+    for(std::size_t i = 0; i < objs.size() / 100; ++i){
+
+        update.push_back({pds::fpOp::remove, objs[i]});
+        update.push_back({pds::fpOp::insert, objs[i] + 1});
+    }
+
+    pds_bench::Timer update_timer;
+
+    bytes = pds_bench::bytes_of([&]{
+        fps->apply(std::move(update));
+    });
+    pds_bench::print_row("apply 1% update batch", update_timer.ms(), bytes);
+
+    return 0;
+}
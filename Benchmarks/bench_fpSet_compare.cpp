@@ -0,0 +1,70 @@
+/*
+    One million lookups of string keys that arrive as std::string_view (slices of a request buffer),
+    on random versions of an fpSet<std::string>.
+        std::string(key)    - the only way before the transparent comparator: every lookup builds
+                              a std::string, which allocates for keys longer than the small string buffer.
+        key                 - std::less<> compares the std::string_view with the objects as it is.
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+
+#include <string_view>
+
+#define PDS_BENCH_OBJS 10000
+#define PDS_BENCH_LOOKUPS 1000000
+
+template <class SET, class LOOKUP>
+void bench_lookups(const std::string& name, SET& set, const std::vector<std::string_view>& keys, LOOKUP&& lookup){
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<pds::version_t> version(1, set.curr_version());
+    std::uniform_int_distribution<std::size_t> key(0, keys.size() - 1);
+
+    std::size_t found = 0;
+    std::size_t allocations = pds_bench::allocations;
+    pds_bench::Timer timer;
+
+    for(std::size_t i = 0; i < PDS_BENCH_LOOKUPS; ++i)
+        found += lookup(set, keys[key(gen)], version(gen));
+
+    double ms = timer.ms();
+    pds_bench::do_not_optimize(found);
+
+    std::printf("  %-36s %10.2f ms %12zu allocations\n", name.c_str(), ms, pds_bench::allocations - allocations);
+}
+
+int main(){
+
+    std::vector<std::string> ids(PDS_BENCH_OBJS);
+
+    for(std::size_t i = 0; i < ids.size(); ++i)
+        ids[i] = "session-" + std::to_string(1000000007ULL * (i + 1)) + "-user";
+
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(42));
+
+    // the keys are slices of one buffer, like the fields of a parsed request:
+    std::string request;
+
+    for(const std::string& id : ids)
+        request += id + ",";
+
+    std::vector<std::string_view> keys;
+
+    for(std::size_t pos = 0, next; (next = request.find(',', pos)) != std::string::npos; pos = next + 1)
+        keys.push_back(std::string_view(request).substr(pos, next - pos));
+
+    pds::fpSet<std::string, std::less<>, pds::fpFlatSlots<>> fps;
+
+    for(const std::string& id : ids)
+        fps.insert(id);
+
+    std::printf("bench_fpSet_compare: %d string objects, %d lookups on random versions\n", PDS_BENCH_OBJS, PDS_BENCH_LOOKUPS);
+
+    bench_lookups("fpSet::contains(std::string(key))", fps, keys,
+        [](auto& s, std::string_view key, pds::version_t v){ return s.contains(std::string(key), v); });
+
+    bench_lookups("fpSet::contains(key)", fps, keys,
+        [](auto& s, std::string_view key, pds::version_t v){ return s.contains(key, v); });
+
+    return 0;
+}
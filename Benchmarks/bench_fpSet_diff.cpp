@@ -0,0 +1,80 @@
+/*
+    Change-data-capture between versions of a 100k objects fpSet:
+        diff            - walks both versions and skips their shared subtrees.
+        to_vector diff  - materializes both versions and runs std::set_difference twice.
+    'consecutive' compares versions that differ by one object,
+    'far' compares the loaded version with the last one (1000 changes).
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+
+#include <optional>
+
+#define PDS_BENCH_OBJS 100000
+#define PDS_BENCH_UPDATES 1000
+
+using fpBenchSet = pds::fpSet<int, std::less<>, pds::fpFlatSlots<>>;
+
+std::size_t to_vector_diff(fpBenchSet& fps, pds::version_t a, pds::version_t b){
+
+    std::vector<int> va = fps.to_vector(a), vb = fps.to_vector(b), inserted, removed;
+
+    std::set_difference(vb.begin(), vb.end(), va.begin(), va.end(), std::back_inserter(inserted));
+    std::set_difference(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(removed));
+
+    return inserted.size() + removed.size();
+}
+
+std::size_t fp_diff(fpBenchSet& fps, pds::version_t a, pds::version_t b){
+
+    pds::fpDiff<int> changes = fps.diff(a, b);
+    return changes.inserted.size() + changes.removed.size();
+}
+
+template <class DIFF>
+void bench_diff(const std::string& name, fpBenchSet& fps, DIFF&& diff){
+
+    std::size_t changes = 0;
+    pds_bench::Timer consecutive_timer;
+
+    for(pds::version_t v = 2; v < fps.curr_version(); ++v)
+        changes += diff(fps, v, v + 1);
+
+    pds_bench::print_row(name + " consecutive x" + std::to_string(PDS_BENCH_UPDATES), consecutive_timer.ms(), 0);
+
+    pds_bench::Timer far_timer;
+    changes += diff(fps, 2, fps.curr_version());
+    pds_bench::print_row(name + " far", far_timer.ms(), 0);
+
+    pds_bench::do_not_optimize(changes);
+}
+
+int main(){
+
+    std::vector<int> objs(PDS_BENCH_OBJS);
+
+    for(std::size_t i = 0; i < objs.size(); ++i)
+        objs[i] = static_cast<int>(2 * i);
+
+    std::optional<fpBenchSet> fps;
+    fps.emplace(fpBenchSet::from_sorted(objs.begin(), objs.end()));
+
+    std::mt19937 gen(42);
+
+    for(std::size_t i = 0; i < PDS_BENCH_UPDATES; ++i){
+
+        int obj = static_cast<int>(gen() % (2 * PDS_BENCH_OBJS));
+
+        if(fps->contains(obj, fps->curr_version()))
+            fps->remove(obj);
+        else
+            fps->insert(obj);
+    }
+
+    std::printf("bench_fpSet_diff: %d objects, %d single-object versions\n", PDS_BENCH_OBJS, PDS_BENCH_UPDATES);
+
+    bench_diff("diff", *fps, fp_diff);
+    bench_diff("to_vector diff", *fps, to_vector_diff);
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*
+    Cold start from a file: fpSet::load rebuilds the set, fpSetImage::open maps a frozen image.
+
+    Rows:
+        <set> load          - fpSet::load of a snapshot file (bytes: the size of the file).
+        <set> contains      - PDS_BENCH_LOOKUPS contains on random versions of the loaded set.
+        image open          - fpSetImage::open of the frozen file (bytes: the size of the file).
+        image contains      - the same contains on the image.
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+#include "fpSetImage.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+#define PDS_BENCH_VERSIONS 200000
+#define PDS_BENCH_OBJS 20000
+#define PDS_BENCH_LOOKUPS 100000
+
+template <class SET>
+std::size_t lookups(SET& set, const std::vector<std::pair<int, pds::version_t>>& queries){
+
+    std::size_t found = 0;
+
+    for(const auto& [obj, version] : queries)
+        found += set.contains(obj, version);
+
+    return found;
+}
+
+int main(){
+
+    std::mt19937 gen(42);
+
+    pds::fpSet<int, std::less<>, pds::fpFlatSlots<2>> set;
+    std::vector<bool> in(PDS_BENCH_OBJS, false);
+
+    for(int i = 0; i < PDS_BENCH_VERSIONS; ++i){
+
+        int obj = static_cast<int>(gen() % PDS_BENCH_OBJS);
+
+        if(in[obj])
+            set.remove(obj);
+        else
+            set.insert(obj);
+
+        in[obj] = !in[obj];
+    }
+
+    std::vector<std::pair<int, pds::version_t>> queries(PDS_BENCH_LOOKUPS);
+
+    for(auto& [obj, version] : queries){
+
+        obj = static_cast<int>(gen() % PDS_BENCH_OBJS);
+        version = 1 + gen() % set.curr_version();
+    }
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::string snapshot_path = (dir / "bench_fpSet_image.snapshot").string();
+    std::string image_path = (dir / "bench_fpSet_image.img").string();
+    {
+        std::ofstream snapshot(snapshot_path, std::ios::binary);
+        set.save(snapshot);
+
+        std::ofstream image(image_path, std::ios::binary);
+        set.freeze(image);
+    }
+
+    std::printf("bench_fpSet_image: %d versions of %d objects, load vs open, %d lookups\n",
+        PDS_BENCH_VERSIONS, PDS_BENCH_OBJS, PDS_BENCH_LOOKUPS);
+
+    pds_bench::Timer load_timer;
+    std::ifstream snapshot(snapshot_path, std::ios::binary);
+    auto loaded = pds::fpSet<int, std::less<>, pds::fpFlatSlots<2>>::load(snapshot);
+    double load_ms = load_timer.ms();
+
+    pds_bench::Timer set_timer;
+    std::size_t set_found = lookups(loaded, queries);
+    double set_ms = set_timer.ms();
+
+    pds_bench::Timer open_timer;
+    pds::fpSetImage<int> image = pds::fpSetImage<int>::open(image_path);
+    double open_ms = open_timer.ms();
+
+    pds_bench::Timer image_timer;
+    std::size_t image_found = lookups(image, queries);
+    double image_ms = image_timer.ms();
+
+    if(set_found != image_found)
+        std::printf("  the image does not answer like the set\n");
+
+    pds_bench::print_row("fpSet<fpFlatSlots<2>> load", load_ms, std::filesystem::file_size(snapshot_path));
+    pds_bench::print_row("fpSet<fpFlatSlots<2>> contains", set_ms, 0);
+    pds_bench::print_row("fpSetImage open", open_ms, std::filesystem::file_size(image_path));
+    pds_bench::print_row("fpSetImage contains", image_ms, 0);
+
+    std::filesystem::remove(snapshot_path);
+    std::filesystem::remove(image_path);
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*
+    Durable updates: inserts into a set with a write-ahead log, by the size of the group commit.
+
+    Rows:
+        no log              - PDS_BENCH_UPDATES inserts without a log.
+        group <G>           - the same inserts with an fpSetLog that syncs every G records (bytes: the size of the log).
+                              The name also shows the updates per second.
+        replay <G>          - recovery of the set from the log of group <G>.
+*/
+#include "bench_utils.h"
+#include "fpSetLog.hpp"
+
+#include <filesystem>
+
+#define PDS_BENCH_UPDATES 10000
+
+/// @brief " (<updates>/s)"
+std::string rate(std::size_t updates, double ms){
+
+    return " (" + std::to_string(static_cast<long>(updates / (ms / 1000))) + "/s)";
+}
+
+void bench_group(const std::string& path, std::size_t group, const std::vector<int>& objs){
+
+    std::filesystem::remove(path);
+
+    pds::fpSet<int, std::less<>, pds::fpFlatSlots<2>> set;
+    pds::fpSetLog<int> wal(path, group);
+    set.set_log(&wal);
+
+    pds_bench::Timer timer;
+
+    for(int obj : objs)
+        set.insert(obj);
+
+    wal.sync();
+    double ms = timer.ms();
+
+    pds::fpSet<int, std::less<>, pds::fpFlatSlots<2>> recovered;
+
+    pds_bench::Timer replay_timer;
+    std::size_t records = pds::fpSetLog<int>::replay(recovered, path);
+    double replay_ms = replay_timer.ms();
+
+    if(records != objs.size() || recovered.size() != set.size())
+        std::printf("  the replayed set is not the logged one\n");
+
+    pds_bench::print_row("group " + std::to_string(group) + rate(objs.size(), ms), ms, std::filesystem::file_size(path));
+    pds_bench::print_row("replay " + std::to_string(group), replay_ms, 0);
+}
+
+int main(){
+
+    std::mt19937 gen(42);
+    std::vector<int> objs(PDS_BENCH_UPDATES);
+
+    for(int& obj : objs)
+        obj = static_cast<int>(gen());
+
+    std::sort(objs.begin(), objs.end());
+    objs.erase(std::unique(objs.begin(), objs.end()), objs.end());
+    std::shuffle(objs.begin(), objs.end(), gen);
+
+    std::printf("bench_fpSet_log: %zu inserts, synced every G records\n", objs.size());
+
+    pds::fpSet<int, std::less<>, pds::fpFlatSlots<2>> set;
+
+    pds_bench::Timer timer;
+
+    for(int obj : objs)
+        set.insert(obj);
+
+    double ms = timer.ms();
+    pds_bench::print_row("no log" + rate(objs.size(), ms), ms, 0);
+
+    std::string path = (std::filesystem::temp_directory_path() / "bench_fpSet_log.wal").string();
+
+    for(std::size_t group : {1, 64, 4096})
+        bench_group(path, group, objs);
+
+    std::filesystem::remove(path);
+
+    return 0;
+}
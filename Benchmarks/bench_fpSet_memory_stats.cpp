@@ -0,0 +1,68 @@
+/*
+    An fpSet of 100k objects after 200k updates on random versions, for every slot storage engine:
+    the parts of pds::fpMemoryStats next to the heap bytes that were measured while building the set,
+    and the time of one memory_stats() call (the average of 100 calls).
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+
+#include <optional>
+
+#define PDS_BENCH_OBJS 100000
+#define PDS_BENCH_UPDATES 200000
+#define PDS_BENCH_CALLS 100
+
+template <class SLOTS>
+void bench_engine(const std::string& name){
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> obj(0, PDS_BENCH_OBJS - 1);
+
+    std::optional<pds::fpSet<int, std::less<>, SLOTS>> fps;
+
+    std::size_t bytes = pds_bench::bytes_of([&]{
+
+        fps.emplace();
+
+        for(std::size_t i = 0; i < PDS_BENCH_UPDATES; ++i){
+
+            // most updates go to the last version, some branch from an old one.
+            pds::version_t base = (gen() % 4 == 0) ? 1 + gen() % fps->curr_version() : fps->curr_version();
+            int x = obj(gen);
+
+            if(fps->contains(x, base))
+                fps->remove(x, base);
+            else
+                fps->insert(x, base);
+        }
+    });
+
+    pds::fpMemoryStats stats;
+    pds_bench::Timer timer;
+
+    for(int i = 0; i < PDS_BENCH_CALLS; ++i){
+
+        stats = fps->memory_stats();
+        pds_bench::do_not_optimize(stats);
+    }
+    double us = timer.ms() * 1000 / PDS_BENCH_CALLS;
+
+    std::printf(" %s: %zu versions, %zu nodes, %zu slots\n", name.c_str(), stats.versions, stats.nodes, stats.slots);
+    std::printf("  %-20s %12zu bytes\n", "objects", stats.object_bytes);
+    std::printf("  %-20s %12zu bytes\n", "nodes", stats.node_bytes);
+    std::printf("  %-20s %12zu bytes\n", "slots", stats.slot_bytes);
+    std::printf("  %-20s %12zu bytes\n", "versions index", stats.index_bytes);
+    std::printf("  %-20s %12zu bytes (heap growth while building: %zu bytes)\n", "total", stats.total_bytes(), bytes);
+    std::printf("  %-20s %12.3f us\n", "memory_stats()", us);
+}
+
+int main(){
+
+    std::printf("bench_fpSet_memory_stats: %d objects, %d updates on random versions\n", PDS_BENCH_OBJS, PDS_BENCH_UPDATES);
+
+    bench_engine<pds::fpHashSlots>("fpHashSlots");
+    bench_engine<pds::fpFlatSlots<>>("fpFlatSlots<>");
+    bench_engine<pds::fpConcurrentSlots<>>("fpConcurrentSlots<>");
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+/*
+    Many short-lived sets: every set gets 1000 inserts on random versions and is dropped,
+    first on one thread and then on four threads at once, with the memory of the sets from
+        default resource        - every fat node block and slot table from operator new (malloc).
+        monotonic buffer        - one std::pmr::monotonic_buffer_resource per thread, released after every set.
+        unsynchronized pool     - one std::pmr::unsynchronized_pool_resource per thread, for all its sets.
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+#define PDS_BENCH_SETS 2000
+#define PDS_BENCH_INSERTS 1000
+#define PDS_BENCH_THREADS 4
+
+/// @brief build and drop 'sets' sets with the memory of 'resource'. 'after_set' runs after every set.
+template <class AFTER>
+std::size_t build_sets(std::size_t sets, std::pmr::memory_resource* resource, unsigned seed, AFTER&& after_set){
+
+    std::mt19937 gen(seed);
+    std::size_t objs = 0;
+
+    for(std::size_t s = 0; s < sets; ++s){
+        {
+            pds::fpSet<int, std::less<>, pds::fpFlatSlots<>> fps(resource);
+
+            for(int i = 0; i < PDS_BENCH_INSERTS; ++i){
+
+                pds::version_t base = (i % 4 == 0) ? 1 + gen() % fps.curr_version() : fps.curr_version();
+
+                if(!fps.contains(i, base))
+                    fps.insert(i, base);
+            }
+            objs += fps.size(fps.curr_version());
+        }
+        after_set();
+    }
+    return objs;
+}
+
+/// @brief run 'job(thread)' on 'threads' threads, print its time and the operator new calls of all of them.
+template <class JOB>
+void bench_row(const std::string& name, unsigned threads, JOB&& job){
+
+    std::size_t allocations = pds_bench::allocations;
+    pds_bench::Timer timer;
+
+    std::vector<std::thread> workers;
+
+    for(unsigned t = 0; t < threads; ++t)
+        workers.emplace_back(job, t);
+
+    for(std::thread& w : workers)
+        w.join();
+
+    double ms = timer.ms();
+    std::printf("  %-36s %10.2f ms %12zu allocations\n", name.c_str(), ms, pds_bench::allocations - allocations);
+}
+
+template <unsigned THREADS>
+void bench_resources(){
+
+    std::size_t sets = PDS_BENCH_SETS / THREADS;
+
+    std::printf(" %u thread(s), %zu sets each:\n", THREADS, sets);
+
+    bench_row("default resource", THREADS, [sets](unsigned t){
+
+        pds_bench::do_not_optimize(build_sets(sets, std::pmr::get_default_resource(), t, []{}));
+    });
+
+    bench_row("monotonic buffer", THREADS, [sets](unsigned t){
+
+        std::pmr::monotonic_buffer_resource buffer(1 << 20);
+        pds_bench::do_not_optimize(build_sets(sets, &buffer, t, [&buffer]{ buffer.release(); }));
+    });
+
+    bench_row("unsynchronized pool", THREADS, [sets](unsigned t){
+
+        std::pmr::unsynchronized_pool_resource pool;
+        pds_bench::do_not_optimize(build_sets(sets, &pool, t, []{}));
+    });
+}
+
+int main(){
+
+    std::printf("bench_fpSet_pmr: %d sets of %d inserts on random versions, fpFlatSlots<>\n",
+        PDS_BENCH_SETS, PDS_BENCH_INSERTS);
+
+    bench_resources<1>();
+    bench_resources<PDS_BENCH_THREADS>();
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+    Merging two branches of a 100k objects fpSet into one version.
+    Both branches are made from the loaded version by one batch of 1000 random changes.
+        merge_union / intersect / subtract  - one new version, the shared subtrees are kept as they are.
+        to_vector + apply                   - materializes both branches, finds the objects that are 
+                                              missing in the first one and applies them as a batch.
+    The bytes column is the memory that every new version adds to the set.
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+
+#include <optional>
+#include <set>
+
+#define PDS_BENCH_OBJS 100000
+#define PDS_BENCH_CHANGES 1000
+#define PDS_BENCH_REPEATS 100
+
+using fpBenchSet = pds::fpSet<int, std::less<>, pds::fpFlatSlots<>>;
+
+pds::version_t make_branch(fpBenchSet& fps, std::mt19937& gen){
+
+    std::set<int> touched;
+    std::vector<pds::fpBatchOp<int>> batch;
+
+    while(batch.size() < PDS_BENCH_CHANGES){
+
+        int obj = static_cast<int>(gen() % (2 * PDS_BENCH_OBJS));
+
+        if(!touched.insert(obj).second)
+            continue;
+
+        batch.push_back({fps.contains_unchecked(obj, 2) ? pds::fpOp::remove : pds::fpOp::insert, obj});
+    }
+    return fps.apply(batch, 2);
+}
+
+pds::version_t to_vector_union(fpBenchSet& fps, pds::version_t a, pds::version_t b){
+
+    std::vector<int> va = fps.to_vector(a), vb = fps.to_vector(b), missing;
+    std::set_difference(vb.begin(), vb.end(), va.begin(), va.end(), std::back_inserter(missing));
+
+    std::vector<pds::fpBatchOp<int>> batch;
+
+    for(int obj : missing)
+        batch.push_back({pds::fpOp::insert, obj});
+
+    return fps.apply(batch, a);
+}
+
+template <class OP>
+void bench_op(const std::string& name, fpBenchSet& fps, pds::version_t a, pds::version_t b, OP&& op){
+
+    std::size_t size = 0;
+    pds_bench::Timer timer;
+
+    std::size_t bytes = pds_bench::bytes_of([&]{
+        for(int i = 0; i < PDS_BENCH_REPEATS; ++i)
+            size += fps.size(op(fps, a, b));
+    });
+    pds_bench::print_row(name + " x" + std::to_string(PDS_BENCH_REPEATS), timer.ms(), bytes / PDS_BENCH_REPEATS);
+
+    pds_bench::do_not_optimize(size);
+}
+
+int main(){
+
+    std::vector<int> objs(PDS_BENCH_OBJS);
+
+    for(std::size_t i = 0; i < objs.size(); ++i)
+        objs[i] = static_cast<int>(2 * i);
+
+    std::optional<fpBenchSet> fps;
+    fps.emplace(fpBenchSet::from_sorted(objs.begin(), objs.end()));
+
+    std::mt19937 gen(42);
+    pds::version_t a = make_branch(*fps, gen);
+    pds::version_t b = make_branch(*fps, gen);
+
+    std::printf("bench_fpSet_set_algebra: %d objects, two branches of %d changes\n", PDS_BENCH_OBJS, PDS_BENCH_CHANGES);
+
+    bench_op("merge_union", *fps, a, b, [](fpBenchSet& s, pds::version_t x, pds::version_t y){ return s.merge_union(x, y); });
+    bench_op("intersect", *fps, a, b, [](fpBenchSet& s, pds::version_t x, pds::version_t y){ return s.intersect(x, y); });
+    bench_op("subtract", *fps, a, b, [](fpBenchSet& s, pds::version_t x, pds::version_t y){ return s.subtract(x, y); });
+    bench_op("to_vector + apply (union)", *fps, a, b, to_vector_union);
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*
+    Restarting from a snapshot vs replaying the log of inserts and removes that made the set.
+
+    Rows:
+        <set> replay    - PDS_BENCH_VERSIONS random inserts and removes of PDS_BENCH_OBJS objects, one version each.
+        <set> save      - fpSet::save to a memory stream (bytes: the size of the snapshot).
+        <set> load      - fpSet::load from the memory stream.
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+
+#include <optional>
+#include <sstream>
+
+#define PDS_BENCH_VERSIONS 200000
+#define PDS_BENCH_OBJS 20000
+
+template <class SET>
+void bench_set(const std::string& name, const std::vector<int>& log){
+
+    std::optional<SET> set;
+    std::vector<bool> in(PDS_BENCH_OBJS, false);
+
+    pds_bench::Timer replay_timer;
+    std::size_t bytes = pds_bench::bytes_of([&]{
+
+        set.emplace();
+
+        for(int obj : log){
+
+            if(in[obj])
+                set->remove(obj);
+            else
+                set->insert(obj);
+
+            in[obj] = !in[obj];
+        }
+    });
+    double replay_ms = replay_timer.ms();
+
+    std::stringstream snapshot(std::ios::in | std::ios::out | std::ios::binary);
+
+    pds_bench::Timer save_timer;
+    set->save(snapshot);
+    double save_ms = save_timer.ms();
+
+    std::size_t snapshot_bytes = snapshot.tellp();
+
+    pds_bench::Timer load_timer;
+    SET loaded = SET::load(snapshot);
+    double load_ms = load_timer.ms();
+
+    if(loaded.size(loaded.curr_version()) != set->size(set->curr_version()))
+        std::printf("  %s: the loaded set is not the saved one\n", name.c_str());
+
+    pds_bench::print_row(name + " replay", replay_ms, bytes);
+    pds_bench::print_row(name + " save", save_ms, snapshot_bytes);
+    pds_bench::print_row(name + " load", load_ms, 0);
+}
+
+int main(){
+
+    std::mt19937 gen(42);
+    std::vector<int> log(PDS_BENCH_VERSIONS);
+
+    for(int& obj : log)
+        obj = static_cast<int>(gen() % PDS_BENCH_OBJS);
+
+    std::printf("bench_fpSet_snapshot: %d versions of %d objects, replay vs load\n",
+        PDS_BENCH_VERSIONS, PDS_BENCH_OBJS);
+
+    bench_set<pds::fpSet<int>>("fpSet<fpHashSlots>", log);
+    bench_set<pds::fpSet<int, std::less<>, pds::fpFlatSlots<2>>>("fpSet<fpFlatSlots<2>>", log);
+    bench_set<pds::fpSet<int, std::less<>, pds::fpConcurrentSlots<2>>>("fpSet<fpConcurrentSlots<2>>", log);
+
+    return 0;
+}
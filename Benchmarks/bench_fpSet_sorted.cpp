@@ -0,0 +1,40 @@
+/*
+    Sorted insertion (monotonically increasing IDs) into fpSet.
+    An unbalanced BST turns every version into a linked list, so the time for N inserts grows as N^2.
+    With the treap the depth stays O(log(N)) and doubling N roughly doubles the time.
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+
+#define PDS_BENCH_MIN_OBJS 1000
+#define PDS_BENCH_MAX_OBJS 16000
+
+int main(){
+
+    std::printf("bench_fpSet_sorted: N sorted inserts, then N contains on the last version\n");
+
+    for(int n = PDS_BENCH_MIN_OBJS; n <= PDS_BENCH_MAX_OBJS; n *= 2){
+
+        pds::fpSet<int> fps;
+
+        pds_bench::Timer insert_timer;
+
+        for(int i = 0; i < n; ++i)
+            fps.insert(i);
+
+        double insert_ms = insert_timer.ms();
+
+        std::size_t found = 0;
+        pds_bench::Timer contains_timer;
+
+        for(int i = 0; i < n; ++i)
+            found += fps.contains(i, fps.curr_version());
+
+        double contains_ms = contains_timer.ms();
+        pds_bench::do_not_optimize(found);
+
+        pds_bench::print_row("insert N=" + std::to_string(n), insert_ms, 0);
+        pds_bench::print_row("contains N=" + std::to_string(n), contains_ms, 0);
+    }
+    return 0;
+}
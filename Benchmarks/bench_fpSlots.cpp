@@ -0,0 +1,71 @@
+/*
+    Slot storage engines of fpFatNodePtr:
+        pds::fpHashSlots          - std::unordered_map slots + pds::fpVersionIndex versions map.
+        pds::fpFlatSlots<N>       - sorted small-vector of resolved slots, N of them inline.
+        pds::fpConcurrentSlots<N> - the flat layout in append-only blocks, for lock-free readers.
+
+    Builds the same fpSet with every engine, then runs the same lookups on random versions.
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+
+#include <optional>
+
+#define PDS_BENCH_OBJS 5000
+#define PDS_BENCH_LOOKUPS 200000
+
+template <class SLOTS>
+void bench_engine(const std::string& name, const std::vector<int>& objs, const std::vector<pds::version_t>& bases){
+
+    std::optional<pds::fpSet<int, std::less<>, SLOTS>> fps;
+
+    pds_bench::Timer build_timer;
+    std::size_t bytes = pds_bench::bytes_of([&]{
+
+        fps.emplace();
+
+        for(std::size_t i = 0; i < objs.size(); ++i)
+            fps->insert(objs[i], bases[i]);
+    });
+    double build_ms = build_timer.ms();
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<pds::version_t> version(1, fps->curr_version());
+    std::uniform_int_distribution<std::size_t> obj(0, objs.size() - 1);
+
+    std::size_t found = 0;
+    pds_bench::Timer lookup_timer;
+
+    for(std::size_t i = 0; i < PDS_BENCH_LOOKUPS; ++i)
+        found += fps->contains(objs[obj(gen)], version(gen));
+
+    double lookup_ms = lookup_timer.ms();
+    pds_bench::do_not_optimize(found);
+
+    pds_bench::print_row(name + " build", build_ms, bytes);
+    pds_bench::print_row(name + " contains", lookup_ms, 0);
+}
+
+int main(){
+
+    std::mt19937 gen(42);
+    std::vector<int> objs(PDS_BENCH_OBJS);
+    std::vector<pds::version_t> bases(PDS_BENCH_OBJS);
+
+    for(std::size_t i = 0; i < objs.size(); ++i){
+
+        objs[i] = static_cast<int>(i);
+        // most inserts go to the last version, some branch from an old one.
+        bases[i] = (i > 0 && gen() % 4 == 0) ? 1 + gen() % (i + 1) : pds::default_version;
+    }
+    std::shuffle(objs.begin(), objs.end(), gen);
+
+    std::printf("bench_fpSlots: %d inserts, %d contains on random versions\n", PDS_BENCH_OBJS, PDS_BENCH_LOOKUPS);
+
+    bench_engine<pds::fpHashSlots>("fpHashSlots", objs, bases);
+    bench_engine<pds::fpFlatSlots<2>>("fpFlatSlots<2>", objs, bases);
+    bench_engine<pds::fpFlatSlots<4>>("fpFlatSlots<4>", objs, bases);
+    bench_engine<pds::fpConcurrentSlots<2>>("fpConcurrentSlots<2>", objs, bases);
+
+    return 0;
+}
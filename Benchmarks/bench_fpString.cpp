@@ -0,0 +1,136 @@
+/*
+    Versioned edits of a text: fpString vs a std::string that is copied for every version.
+
+    Rows:
+        <text> edit         - PDS_BENCH_EDITS inserts and erases of a few characters at random positions
+                              of a PDS_BENCH_TEXT characters text, one version each (bytes: the growth).
+        <text> read         - every version is read to an std::ostream: fpString::write streams the chunks,
+                              fpString::to_string builds a std::string first.
+*/
+#include "bench_utils.h"
+#include "fpString.hpp"
+
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#define PDS_BENCH_TEXT (256 * 1024)
+#define PDS_BENCH_EDITS 1000
+
+/// @brief a stream buffer that copies its characters to a small ring, like a socket buffer would.
+struct NullBuf : std::streambuf{
+
+    char ring[64 * 1024];
+    std::size_t count = 0;
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+
+        for(std::streamsize done = 0; done < n; ){
+
+            std::size_t at = count % sizeof(ring);
+            std::size_t part = std::min<std::size_t>(n - done, sizeof(ring) - at);
+
+            std::memcpy(ring + at, s + done, part);
+            done += part;
+            count += part;
+        }
+        return n;
+    }
+    int overflow(int c) override { ring[count++ % sizeof(ring)] = c; return c; }
+};
+
+template <class SLOTS>
+void bench_string(const std::string& name, const std::string& text){
+
+    pds::fpString<SLOTS> doc;
+    std::mt19937 gen(42);
+
+    doc.insert(0, text);
+
+    pds_bench::Timer edit_timer;
+    std::size_t edit_bytes = pds_bench::bytes_of([&]{
+
+        for(int i = 0; i < PDS_BENCH_EDITS; ++i){
+
+            if(i % 2 == 0)
+                doc.insert(gen() % (doc.size() + 1), "edit " + std::to_string(i));
+            else
+                doc.erase(gen() % doc.size(), 8);
+        }
+    });
+    double edit_ms = edit_timer.ms();
+
+    NullBuf buf;
+    std::ostream out(&buf);
+
+    pds_bench::Timer write_timer;
+    for(pds::version_t v = 2; v <= doc.curr_version(); ++v)
+        doc.write(out, v);
+    double write_ms = write_timer.ms();
+
+    pds_bench::Timer to_string_timer;
+    for(pds::version_t v = 2; v <= doc.curr_version(); ++v)
+        out << doc.to_string(v);
+    double to_string_ms = to_string_timer.ms();
+
+    pds_bench::do_not_optimize(buf.count);
+
+    pds_bench::print_row(name + " edit", edit_ms, edit_bytes);
+    pds_bench::print_row(name + " read (write)", write_ms, 0);
+    pds_bench::print_row(name + " read (to_string)", to_string_ms, 0);
+}
+
+void bench_string_copies(const std::string& text){
+
+    std::vector<std::string> versions = {text};
+    std::mt19937 gen(42);
+
+    pds_bench::Timer edit_timer;
+    std::size_t edit_bytes = pds_bench::bytes_of([&]{
+
+        versions.reserve(PDS_BENCH_EDITS + 1);
+
+        for(int i = 0; i < PDS_BENCH_EDITS; ++i){
+
+            std::string next = versions.back();
+
+            if(i % 2 == 0)
+                next.insert(gen() % (next.size() + 1), "edit " + std::to_string(i));
+            else
+                next.erase(gen() % next.size(), 8);
+
+            versions.push_back(std::move(next));
+        }
+    });
+    double edit_ms = edit_timer.ms();
+
+    NullBuf buf;
+    std::ostream out(&buf);
+
+    pds_bench::Timer read_timer;
+    for(const std::string& version : versions)
+        out << version;
+    double read_ms = read_timer.ms();
+
+    pds_bench::do_not_optimize(buf.count);
+
+    pds_bench::print_row("std::string copies edit", edit_ms, edit_bytes);
+    pds_bench::print_row("std::string copies read", read_ms, 0);
+}
+
+int main(){
+
+    std::mt19937 gen(7);
+    std::string text(PDS_BENCH_TEXT, ' ');
+
+    for(char& c : text)
+        c = 'a' + gen() % 26;
+
+    std::printf("bench_fpString: %d characters, %d edits\n", PDS_BENCH_TEXT, PDS_BENCH_EDITS);
+
+    bench_string<pds::fpHashSlots>("fpString<fpHashSlots>", text);
+    bench_string<pds::fpFlatSlots<2>>("fpString<fpFlatSlots<2>>", text);
+    bench_string_copies(text);
+
+    return 0;
+}
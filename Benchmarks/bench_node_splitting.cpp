@@ -0,0 +1,77 @@
+/*
+    Node splitting: a small set that is updated over and over, so a few fat nodes see every version.
+    Without splitting their fat pointers grow with the number of versions, with splitting a full
+    node is copied and every fat pointer below the root holds a bounded number of versions.
+
+    Rows:
+        <set> build     - PDS_BENCH_UPDATES insert/remove toggles of PDS_BENCH_OBJS objects on the last version.
+        <set> contains  - PDS_BENCH_LOOKUPS lookups on random versions.
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+#include "pSet.hpp"
+
+#include <optional>
+
+#define PDS_BENCH_OBJS 64
+#define PDS_BENCH_UPDATES 100000
+#define PDS_BENCH_LOOKUPS 200000
+
+template <class SET>
+void bench_set(const std::string& name, const std::vector<int>& toggles){
+
+    std::optional<SET> set;
+
+    pds_bench::Timer build_timer;
+    std::size_t bytes = pds_bench::bytes_of([&]{
+
+        set.emplace();
+        std::vector<bool> in(PDS_BENCH_OBJS, false);
+
+        for(int obj : toggles){
+
+            if(in[obj])
+                set->remove(obj);
+            else
+                set->insert(obj);
+
+            in[obj] = !in[obj];
+        }
+    });
+    double build_ms = build_timer.ms();
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<pds::version_t> version(1, set->curr_version());
+    std::uniform_int_distribution<int> obj(0, PDS_BENCH_OBJS - 1);
+
+    std::size_t found = 0;
+    pds_bench::Timer lookup_timer;
+
+    for(std::size_t i = 0; i < PDS_BENCH_LOOKUPS; ++i)
+        found += set->contains(obj(gen), version(gen));
+
+    double lookup_ms = lookup_timer.ms();
+    pds_bench::do_not_optimize(found);
+
+    pds_bench::print_row(name + " build", build_ms, bytes);
+    pds_bench::print_row(name + " contains", lookup_ms, 0);
+}
+
+int main(){
+
+    std::mt19937 gen(42);
+    std::vector<int> toggles(PDS_BENCH_UPDATES);
+
+    for(int& obj : toggles)
+        obj = static_cast<int>(gen() % PDS_BENCH_OBJS);
+
+    std::printf("bench_node_splitting: %d updates of %d objects, %d contains on random versions\n", 
+        PDS_BENCH_UPDATES, PDS_BENCH_OBJS, PDS_BENCH_LOOKUPS);
+
+    bench_set<pds::fpSet<int>>("fpSet<fpHashSlots>", toggles);
+    bench_set<pds::fpSet<int, std::less<>, pds::fpFlatSlots<2>>>("fpSet<fpFlatSlots<2>>", toggles);
+    bench_set<pds::fpSet<int, std::less<>, pds::fpConcurrentSlots<2>>>("fpSet<fpConcurrentSlots<2>>", toggles);
+    bench_set<pds::pSet<int>>("pSet", toggles);
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*
+    Version garbage collection: a set that keeps only its last versions and a few pinned snapshots.
+    Without retiring, every version and every object ever inserted stays in memory.
+
+    Rows:
+        <set> build         - PDS_BENCH_UPDATES inserts and removes on the last version, that keep a window 
+                              of PDS_BENCH_WINDOW objects (bytes: the whole set).
+        <set> retain_only   - keep the last PDS_BENCH_KEEP versions and every PDS_BENCH_PIN-th version
+                              (bytes: the set after retiring the rest).
+*/
+#include "bench_utils.h"
+#include "fpSet.hpp"
+
+#include <optional>
+
+#define PDS_BENCH_UPDATES 100000
+#define PDS_BENCH_WINDOW 64
+#define PDS_BENCH_KEEP 1000
+#define PDS_BENCH_PIN 10000
+
+template <class SET>
+void bench_set(const std::string& name){
+
+    std::optional<SET> set;
+    std::size_t before = pds_bench::live_bytes;
+
+    pds_bench::Timer build_timer;
+    std::size_t bytes = pds_bench::bytes_of([&]{
+
+        set.emplace();
+
+        for(int obj = 0; set->curr_version() < PDS_BENCH_UPDATES; ++obj){
+
+            set->insert(obj);
+
+            if(obj >= PDS_BENCH_WINDOW)
+                set->remove(obj - PDS_BENCH_WINDOW);
+        }
+    });
+    double build_ms = build_timer.ms();
+
+    pds::version_t last = set->curr_version();
+
+    pds_bench::Timer retire_timer;
+    std::size_t retired = set->retain_only([last](pds::version_t v){
+
+        return v + PDS_BENCH_KEEP > last || v % PDS_BENCH_PIN == 0;
+    });
+    double retire_ms = retire_timer.ms();
+
+    pds_bench::do_not_optimize(retired);
+
+    pds_bench::print_row(name + " build", build_ms, bytes);
+    pds_bench::print_row(name + " retain_only", retire_ms, pds_bench::live_bytes - before);
+}
+
+int main(){
+
+    std::printf("bench_retire: %d updates, keep the last %d versions and every %d-th version\n",
+        PDS_BENCH_UPDATES, PDS_BENCH_KEEP, PDS_BENCH_PIN);
+
+    bench_set<pds::fpSet<int>>("fpSet<fpHashSlots>");
+    bench_set<pds::fpSet<int, std::less<>, pds::fpFlatSlots<2>>>("fpSet<fpFlatSlots<2>>");
+    bench_set<pds::fpSet<int, std::less<>, pds::fpConcurrentSlots<2>>>("fpSet<fpConcurrentSlots<2>>");
+
+    return 0;
+}
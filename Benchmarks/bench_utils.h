@@ -0,0 +1,115 @@
+#ifndef PERSISTENT_DATA_STRUCTURE_BENCH_UTILS_H
+#define PERSISTENT_DATA_STRUCTURE_BENCH_UTILS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+
+/*
+    Every benchmark is a single translation unit that includes this header once,
+    so the global allocation counters below are defined here.
+    The counters are atomic, so a benchmark may allocate from several threads.
+*/
+
+namespace pds_bench{
+
+    inline std::atomic<std::size_t> live_bytes = 0;     ///< bytes currently allocated with operator new.
+    inline std::atomic<std::size_t> allocations = 0;    ///< number of calls to operator new.
+
+    class Timer{
+        std::chrono::steady_clock::time_point start;
+    public:
+        Timer() : start(std::chrono::steady_clock::now()) {}
+
+        double ms() const {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    };
+
+    /// @brief growth of the live heap bytes while running 'func'.
+    template <class FUNC>
+    std::size_t bytes_of(FUNC&& func){
+
+        std::size_t before = live_bytes;
+        func();
+        return live_bytes - before;
+    }
+
+    /// @brief keep 'value' alive so the optimizer can not drop the benchmarked work.
+    template <class T>
+    void do_not_optimize(const T& value){
+
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    inline void print_row(const std::string& name, double ms, std::size_t bytes){
+
+        std::printf("  %-36s %10.2f ms %12zu bytes\n", name.c_str(), ms, bytes);
+    }
+};
+
+// Every block carries its size in a header, so the live bytes can be counted back on delete.
+static constexpr std::size_t pds_bench_header = alignof(std::max_align_t);
+
+// Not inlined, so GCC does not mistake the header arithmetic for mismatched allocations.
+__attribute__((noinline)) void* operator new(std::size_t size){
+
+    pds_bench::live_bytes.fetch_add(size, std::memory_order_relaxed);
+    pds_bench::allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if(char* p = static_cast<char*>(std::malloc(size + pds_bench_header))){
+
+        *reinterpret_cast<std::size_t*>(p) = size;
+        return p + pds_bench_header;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+
+    if(p == nullptr)
+        return;
+
+    char* block = static_cast<char*>(p) - pds_bench_header;
+    pds_bench::live_bytes.fetch_sub(*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+
+// The aligned forms (e.g. of std::pmr::new_delete_resource) keep the size right before the block they return.
+__attribute__((noinline)) void* operator new(std::size_t size, std::align_val_t align){
+
+    std::size_t header = std::max(static_cast<std::size_t>(align), pds_bench_header);
+
+    pds_bench::live_bytes.fetch_add(size, std::memory_order_relaxed);
+    pds_bench::allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if(char* p = static_cast<char*>(std::aligned_alloc(header, (size + 2 * header - 1) / header * header))){
+
+        reinterpret_cast<std::size_t*>(p + header)[-1] = size;
+        return p + header;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::align_val_t align) noexcept {
+
+    if(p == nullptr)
+        return;
+
+    std::size_t header = std::max(static_cast<std::size_t>(align), pds_bench_header);
+
+    pds_bench::live_bytes.fetch_sub(static_cast<std::size_t*>(p)[-1], std::memory_order_relaxed);
+    std::free(static_cast<char*>(p) - header);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t align) noexcept { operator delete(p, align); }
+
+#endif /* PERSISTENT_DATA_STRUCTURE_BENCH_UTILS_H */
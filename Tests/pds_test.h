@@ -3,11 +3,21 @@
 
 #include "pSet.hpp"
 #include "fpSet.hpp"
+#include "fpMap.hpp"
+#include "fpList.hpp"
+#include "fpString.hpp"
+#include "fpPriorityQueue.hpp"
+#include "fpHashSet.hpp"
 
-#define PDS_TESTS_NUM 2
+#define PDS_TESTS_NUM 7
 
 void test_pSet();
 void test_fpSet();
+void test_fpMap();
+void test_fpList();
+void test_fpString();
+void test_fpPriorityQueue();
+void test_fpHashSet();
 
 
 namespace pds{
@@ -16,12 +26,22 @@ namespace pds{
 
     TestFunc_t TestFuncArr[PDS_TESTS_NUM] = {
         test_pSet,
-        test_fpSet
+        test_fpSet,
+        test_fpMap,
+        test_fpList,
+        test_fpString,
+        test_fpPriorityQueue,
+        test_fpHashSet
     };
 
     const std::string tests_name[PDS_TESTS_NUM] = {
         "test_pSet", 
-        "test_fpSet"
+        "test_fpSet",
+        "test_fpMap",
+        "test_fpList",
+        "test_fpString",
+        "test_fpPriorityQueue",
+        "test_fpHashSet"
     };
 };
 
@@ -0,0 +1,187 @@
+#include "fpHashSet.hpp"
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+using namespace pds;
+using namespace std;
+
+#define PDS_RAND_ARR_SIZE 1000
+
+void test_fpHashSet_basic();
+void test_fpHashSet_collisions();
+void test_fpHashSet_random();
+void test_fpHashSet_exceptions();
+
+void test_fpHashSet(){
+
+    try{
+        test_fpHashSet_basic();
+        test_fpHashSet_collisions();
+        test_fpHashSet_random();
+        test_fpHashSet_exceptions();
+    }
+    catch(const pdsExcept& e){
+
+        throw pdsExcept("test_fpHashSet: pdsExcept: " + string(e.what()));
+    }
+    catch(const exception& e){
+
+        throw pdsExcept("test_fpHashSet: std::Exception: " + string(e.what()));
+    }
+    cout << "ALL fpHashSet tests " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+vector<OBJ> fpHashSet_sorted(fpHashSet<OBJ, HASH, SLOTS>& fphs, version_t version){
+
+    vector<OBJ> objs = fphs.to_vector(version);
+    sort(objs.begin(), objs.end());
+    return objs;
+}
+
+
+void test_fpHashSet_basic(){
+
+    fpHashSet<string> ids;
+
+    assert(ids.curr_version() == 1 && ids.size() == 0);
+
+    assert(ids.insert("3f2a") == 2);
+    assert(ids.insert("9c41") == 3);
+    assert(ids.remove("3f2a", 3) == 4);
+    assert(ids.insert("3f2a", 4) == 5);
+    assert(ids.insert("77e0", 2) == 6);
+
+    assert(ids.contains("3f2a", 3) && !ids.contains("3f2a", 4) && ids.contains("3f2a", 5));
+    assert(!ids.contains("9c41", 6) && ids.contains("77e0", 6) && !ids.contains("77e0", 5));
+    assert(as_const(ids).size(1) == 0 && ids.size(3) == 2 && ids.size(4) == 1 && ids.size(6) == 2);
+
+    assert(fpHashSet_sorted(ids, 5) == (vector<string>{"3f2a", "9c41"}));
+    assert(fpHashSet_sorted(ids, 6) == (vector<string>{"3f2a", "77e0"}));
+
+    cout << "fpHashSet::test_fpHashSet_basic " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+/// @brief a hash with few values, so many objects share a hash, and the trie goes below its last level.
+struct fpHashSet_BadHash{
+
+    size_t operator()(int obj) const { return obj % 3; }
+};
+
+
+void test_fpHashSet_collisions(){
+
+    fpHashSet<int, fpHashSet_BadHash> fphs;
+
+    for(int i = 0; i < 30; ++i)
+        fphs.insert(i);
+
+    version_t full = fphs.curr_version();
+
+    for(int i = 0; i < 30; i += 2)
+        fphs.remove(i);
+
+    for(int i = 0; i < 30; ++i){
+
+        assert(fphs.contains(i, full));
+        assert(fphs.contains(i) == (i % 2 == 1));
+    }
+    assert(fphs.size(full) == 30 && fphs.size() == 15);
+
+    // down to one object of every hash, and back:
+    for(int i = 1; i < 27; i += 2)
+        fphs.remove(i);
+
+    assert(fpHashSet_sorted(fphs, fphs.curr_version()) == (vector<int>{27, 29}));
+    assert(fphs.insert(0) > full && fphs.contains(0) && !fphs.contains(3));
+
+    cout << "fpHashSet::test_fpHashSet_collisions " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpHashSet_random(){
+
+    mt19937 gen(random_device{}());
+
+    fpHashSet<int, hash<int>, SLOTS> fphs;
+    vector<set<int>> versions = {{}, {}};   // Version 0 is not used.
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE * 4; ++i){
+
+        version_t base = (i % 4 == 0) ? 1 + gen() % fphs.curr_version() : fphs.curr_version();
+        int obj = gen() % (PDS_RAND_ARR_SIZE / 2);
+
+        set<int> next = versions[base];
+
+        if(next.count(obj)){
+
+            assert(fphs.remove(obj, base) == versions.size());
+            next.erase(obj);
+        }
+        else{
+            assert(fphs.insert(obj, base) == versions.size());
+            next.insert(obj);
+        }
+        versions.push_back(std::move(next));
+    }
+
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        assert(fphs.size(v) == versions[v].size());
+        assert(fpHashSet_sorted(fphs, v) == vector<int>(versions[v].begin(), versions[v].end()));
+
+        for(int obj = 0; obj < PDS_RAND_ARR_SIZE / 2; obj += 7)
+            assert(fphs.contains(obj, v) == (versions[v].count(obj) == 1));
+    }
+}
+
+
+void test_fpHashSet_random(){
+
+    fpHashSet_random<fpHashSlots>();
+    fpHashSet_random<fpFlatSlots<>>();
+    fpHashSet_random<fpConcurrentSlots<>>();
+
+    cout << "fpHashSet::test_fpHashSet_random " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class EXCEPT, class FUNC>
+bool fpHashSet_throws(FUNC&& func){
+
+    try{
+        func();
+    }
+    catch(const EXCEPT&){
+        return true;
+    }
+    return false;
+}
+
+
+void test_fpHashSet_exceptions(){
+
+    fpHashSet<int> fphs;
+    fphs.insert(1);
+
+    assert(fpHashSet_throws<VersionZeroIllegal>([&]{ fphs.insert(2, MasterVersion); }));
+    assert(fpHashSet_throws<VersionZeroIllegal>([&]{ fphs.contains(1, MasterVersion); }));
+    assert(fpHashSet_throws<VersionNotExist>([&]{ fphs.remove(1, 3); }));
+    assert(fpHashSet_throws<VersionNotExist>([&]{ fphs.to_vector(3); }));
+    assert(fpHashSet_throws<ObjectAlreadyExist>([&]{ fphs.insert(1); }));
+    assert(fpHashSet_throws<ObjectNotExist>([&]{ fphs.remove(1, 1); }));
+
+    // a failed update creates no version:
+    assert(fphs.curr_version() == 2 && fphs.size(MasterVersion) == 0 && fphs.size(3) == 0);
+
+    // a moved set keeps its versions:
+    fpHashSet<int> moved = std::move(fphs);
+    assert(moved.contains(1) && moved.remove(1) == 3 && moved.contains(1, 2));
+
+    cout << "fpHashSet::test_fpHashSet_exceptions " << PRINT_GREEN("PASSED") << endl;
+}
@@ -0,0 +1,222 @@
+#include "fpList.hpp"
+
+#include <random>
+
+using namespace pds;
+using namespace std;
+
+#define PDS_RAND_ARR_SIZE 1000
+
+void test_fpList_basic();
+void test_fpList_split_concat();
+void test_fpList_random();
+void test_fpList_exceptions();
+
+void test_fpList(){
+
+    try{
+        test_fpList_basic();
+        test_fpList_split_concat();
+        test_fpList_random();
+        test_fpList_exceptions();
+    }
+    catch(const pdsExcept& e){
+
+        throw pdsExcept("test_fpList: pdsExcept: " + string(e.what()));
+    }
+    catch(const exception& e){
+
+        throw pdsExcept("test_fpList: std::Exception: " + string(e.what()));
+    }
+    cout << "ALL fpList tests " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+void test_fpList_basic(){
+
+    fpList<char> text;
+
+    assert(text.curr_version() == 1 && text.size() == 0);
+
+    assert(text.push_back('a') == 2);
+    assert(text.insert_at(0, 'b') == 3);
+    assert(text.insert_at(1, 'c') == 4);
+    assert(text.erase_at(0) == 5);
+    assert(text.push_back('d', 3) == 6);
+
+    assert(text.to_vector(2) == (vector<char>{'a'}));
+    assert(text.to_vector(3) == (vector<char>{'b', 'a'}));
+    assert(text.to_vector(4) == (vector<char>{'b', 'c', 'a'}));
+    assert(text.to_vector(5) == (vector<char>{'c', 'a'}));
+    assert(text.to_vector() == (vector<char>{'b', 'a', 'd'}));
+
+    assert(text.at(1, 4) == 'c' && text.at(0, 5) == 'c' && text.at(2) == 'd');
+    assert(as_const(text).size(1) == 0 && text.size(4) == 3 && text.size() == 3);
+
+    string s;
+    for(auto it = text.begin(4); it != text.end(4); ++it)
+        s += *it;
+
+    assert(s == "bca");
+
+    cout << "fpList::test_fpList_basic " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+void test_fpList_split_concat(){
+
+    fpList<int> fpl;
+
+    for(int i = 0; i < PDS_RAND_ARR_SIZE; ++i)
+        fpl.push_back(i);
+
+    version_t full = fpl.curr_version();
+
+    auto [head, tail] = fpl.split(300, full);
+    assert(tail == head + 1 && fpl.size(head) == 300 && fpl.size(tail) == PDS_RAND_ARR_SIZE - 300);
+    assert(fpl.at(299, head) == 299 && fpl.at(0, tail) == 300);
+
+    // a version joined with itself holds every subtree twice:
+    version_t twice = fpl.concat(full, full);
+    assert(fpl.size(twice) == 2 * PDS_RAND_ARR_SIZE);
+
+    vector<int> objs = fpl.to_vector(twice);
+    for(int i = 0; i < 2 * PDS_RAND_ARR_SIZE; ++i)
+        assert(objs[i] == i % PDS_RAND_ARR_SIZE);
+
+    // and stays updatable in both copies, while the versions it is built from are kept:
+    version_t changed = fpl.erase_at(PDS_RAND_ARR_SIZE + 6, fpl.insert_at(5, -1, twice));
+    assert(fpl.at(5, changed) == -1 && fpl.at(6, changed) == 5);
+    assert(fpl.at(PDS_RAND_ARR_SIZE + 5, changed) == 4 && fpl.at(PDS_RAND_ARR_SIZE + 6, changed) == 6);
+    assert(fpl.to_vector(twice) == objs && fpl.size(full) == PDS_RAND_ARR_SIZE);
+
+    version_t swapped = fpl.concat(tail, head);
+    assert(fpl.at(0, swapped) == 300 && fpl.at(PDS_RAND_ARR_SIZE - 1, swapped) == 299);
+
+    auto [empty, all] = fpl.split(0, full);
+    assert(fpl.size(empty) == 0 && fpl.to_vector(all) == fpl.to_vector(full));
+
+    cout << "fpList::test_fpList_split_concat " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpList_random(){
+
+    mt19937 gen(random_device{}());
+
+    fpList<int, SLOTS> fpl;
+    vector<vector<int>> versions = {{}, {}};  // Version 0 is not used.
+
+    auto check = [&](version_t v){
+
+        assert(fpl.size(v) == versions[v].size());
+        assert(fpl.to_vector(v) == versions[v]);
+    };
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE * 2; ++i){
+
+        version_t base = (i % 4 == 0) ? 1 + gen() % fpl.curr_version() : fpl.curr_version();
+        vector<int> next = versions[base];
+
+        switch(gen() % 8){
+
+            case 0:{
+                // Concats of older versions make versions with shared and repeated subtrees.
+                version_t other = 1 + gen() % fpl.curr_version();
+
+                if(next.size() + versions[other].size() > 4 * PDS_RAND_ARR_SIZE)
+                    break;
+
+                next.insert(next.end(), versions[other].begin(), versions[other].end());
+                assert(fpl.concat(base, other) == versions.size());
+                versions.push_back(std::move(next));
+                continue;
+            }
+            case 1:{
+                size_t index = gen() % (next.size() + 1);
+
+                assert(fpl.split(index, base).first == versions.size());
+                versions.push_back(vector<int>(next.begin(), next.begin() + index));
+                versions.push_back(vector<int>(next.begin() + index, next.end()));
+                continue;
+            }
+            case 2:
+            case 3:
+                if(next.empty())
+                    break;
+                {
+                    size_t index = gen() % next.size();
+
+                    assert(fpl.at(index, base) == next[index]);
+                    assert(fpl.erase_at(index, base) == versions.size());
+                    next.erase(next.begin() + index);
+                    versions.push_back(std::move(next));
+                }
+                continue;
+        }
+        size_t index = gen() % (next.size() + 1);
+        int obj = gen();
+
+        assert(fpl.insert_at(index, obj, base) == versions.size());
+        next.insert(next.begin() + index, obj);
+        versions.push_back(std::move(next));
+
+        if(i % 64 == 0)
+            check(gen() % fpl.curr_version() + 1);
+    }
+
+    for(version_t v = 1; v < versions.size(); ++v)
+        check(v);
+}
+
+
+void test_fpList_random(){
+
+    fpList_random<fpHashSlots>();
+    fpList_random<fpFlatSlots<>>();
+    fpList_random<fpConcurrentSlots<>>();
+
+    cout << "fpList::test_fpList_random " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class EXCEPT, class FUNC>
+bool fpList_throws(FUNC&& func){
+
+    try{
+        func();
+    }
+    catch(const EXCEPT&){
+        return true;
+    }
+    return false;
+}
+
+
+void test_fpList_exceptions(){
+
+    fpList<int> fpl;
+    fpl.push_back(10);
+
+    assert(fpList_throws<VersionZeroIllegal>([&]{ fpl.push_back(20, MasterVersion); }));
+    assert(fpList_throws<VersionZeroIllegal>([&]{ fpl.at(0, MasterVersion); }));
+    assert(fpList_throws<VersionNotExist>([&]{ fpl.insert_at(0, 20, 3); }));
+    assert(fpList_throws<VersionNotExist>([&]{ fpl.concat(2, 3); }));
+    assert(fpList_throws<IndexOutOfRange>([&]{ fpl.insert_at(2, 20); }));
+    assert(fpList_throws<IndexOutOfRange>([&]{ fpl.erase_at(1); }));
+    assert(fpList_throws<IndexOutOfRange>([&]{ fpl.erase_at(0, 1); }));
+    assert(fpList_throws<IndexOutOfRange>([&]{ fpl.at(1); }));
+    assert(fpList_throws<IndexOutOfRange>([&]{ fpl.at(SIZE_MAX); }));
+    assert(fpList_throws<IndexOutOfRange>([&]{ fpl.erase_at(SIZE_MAX); }));
+    assert(fpList_throws<IndexOutOfRange>([&]{ fpl.split(2); }));
+
+    // a failed update creates no version:
+    assert(fpl.curr_version() == 2 && fpl.size(MasterVersion) == 0 && fpl.size(3) == 0);
+
+    // a moved list keeps its versions:
+    fpList<int> moved = std::move(fpl);
+    assert(moved.at(0) == 10 && moved.push_back(11) == 3 && moved.size(2) == 1);
+
+    cout << "fpList::test_fpList_exceptions " << PRINT_GREEN("PASSED") << endl;
+}
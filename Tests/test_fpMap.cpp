@@ -0,0 +1,195 @@
+#include "fpMap.hpp"
+
+#include <map>
+#include <random>
+
+using namespace pds;
+using namespace std;
+
+#define PDS_RAND_ARR_SIZE 1000
+
+void test_fpMap_basic();
+void test_fpMap_put_replaces();
+void test_fpMap_random();
+void test_fpMap_exceptions();
+
+void test_fpMap(){
+
+    try{
+        test_fpMap_basic();
+        test_fpMap_put_replaces();
+        test_fpMap_random();
+        test_fpMap_exceptions();
+    }
+    catch(const pdsExcept& e){
+
+        throw pdsExcept("test_fpMap: pdsExcept: " + string(e.what()));
+    }
+    catch(const exception& e){
+
+        throw pdsExcept("test_fpMap: std::Exception: " + string(e.what()));
+    }
+    cout << "ALL fpMap tests " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+void test_fpMap_basic(){
+
+    fpMap<string, int> prices;
+
+    assert(prices.curr_version() == 1 && prices.size() == 0);
+
+    assert(prices.put("apple", 3) == 2);
+    assert(prices.put("apple", 4) == 3);
+    assert(prices.put("pear", 7, 2) == 4);
+    assert(prices.erase("apple") == 5);
+
+    assert(prices.get("apple", 2) == 3);
+    assert(prices.get("apple", 3) == 4);
+    assert(prices.get("apple", 4) == 3 && prices.get("pear", 4) == 7);
+    assert(!prices.contains("apple", 5) && prices.contains("pear", 5));
+    assert(!prices.contains("pear", 3));
+
+    assert(as_const(prices).size(1) == 0 && prices.size(3) == 1 && prices.size(4) == 2 && prices.size(5) == 1);
+
+    assert(prices.to_vector(4) == (vector<pair<string, int>>{{"apple", 3}, {"pear", 7}}));
+    assert(prices.to_vector() == (vector<pair<string, int>>{{"pear", 7}}));
+
+    vector<string> keys;
+    for(auto it = prices.begin(4); it != prices.end(4); ++it)
+        keys.push_back(it->key);
+
+    assert(keys == (vector<string>{"apple", "pear"}));
+
+    cout << "fpMap::test_fpMap_basic " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpMap_put_replaces(){
+
+    fpMap<int, string, SLOTS> fpm;
+
+    for(int k = 0; k < PDS_RAND_ARR_SIZE; ++k)
+        fpm.put(k, to_string(k));
+
+    version_t full = fpm.curr_version();
+
+    // Many updates to the same keys: the old versions keep their values, and the nodes are split when full.
+    for(int round = 0; round < 4 * (int)fpFatNodeCapacity; ++round){
+
+        for(int k = 0; k < PDS_RAND_ARR_SIZE; k += 97)
+            fpm.put(k, to_string(k) + "." + to_string(round));
+    }
+
+    for(int k = 0; k < PDS_RAND_ARR_SIZE; ++k){
+
+        assert(fpm.get(k, full) == to_string(k));
+        assert(fpm.get(k) == (k % 97 == 0 ? to_string(k) + "." + to_string(4 * fpFatNodeCapacity - 1) : to_string(k)));
+    }
+    assert(fpm.size() == PDS_RAND_ARR_SIZE);
+
+    vector<pair<int, string>> entries = fpm.to_vector(full + 1);
+    assert(entries.size() == PDS_RAND_ARR_SIZE && entries[0].second == "0.0" && entries[1].second == "1");
+}
+
+
+void test_fpMap_put_replaces(){
+
+    fpMap_put_replaces<fpHashSlots>();
+    fpMap_put_replaces<fpFlatSlots<>>();
+    fpMap_put_replaces<fpConcurrentSlots<>>();
+
+    cout << "fpMap::test_fpMap_put_replaces " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpMap_random(){
+
+    mt19937 gen(random_device{}());
+
+    const int keys = 64;
+    fpMap<int, int, SLOTS> fpm;
+    vector<map<int, int>> versions = {{}, {}};  // Version 0 is not used.
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE * 2; ++i){
+
+        version_t base = (i % 4 == 0) ? 1 + gen() % fpm.curr_version() : fpm.curr_version();
+        int key = gen() % keys;
+
+        map<int, int> next = versions[base];
+
+        if(gen() % 4 == 0 && next.count(key)){
+
+            assert(fpm.erase(key, base) == versions.size());
+            next.erase(key);
+        }
+        else{
+            int value = gen();
+            assert(fpm.put(key, value, base) == versions.size());
+            next[key] = value;
+        }
+        versions.push_back(std::move(next));
+    }
+
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        assert(fpm.size(v) == versions[v].size());
+        assert((fpm.to_vector(v) == vector<pair<int, int>>(versions[v].begin(), versions[v].end())));
+
+        for(int key = 0; key < keys; key += 7){
+
+            assert(fpm.contains(key, v) == (versions[v].count(key) == 1));
+
+            if(versions[v].count(key))
+                assert(fpm.get(key, v) == versions[v][key]);
+        }
+    }
+}
+
+
+void test_fpMap_random(){
+
+    fpMap_random<fpHashSlots>();
+    fpMap_random<fpFlatSlots<>>();
+    fpMap_random<fpConcurrentSlots<>>();
+
+    cout << "fpMap::test_fpMap_random " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class EXCEPT, class FUNC>
+bool fpMap_throws(FUNC&& func){
+
+    try{
+        func();
+    }
+    catch(const EXCEPT&){
+        return true;
+    }
+    return false;
+}
+
+
+void test_fpMap_exceptions(){
+
+    fpMap<int, int> fpm;
+    fpm.put(1, 10);
+
+    assert(fpMap_throws<VersionZeroIllegal>([&]{ fpm.put(2, 20, MasterVersion); }));
+    assert(fpMap_throws<VersionZeroIllegal>([&]{ fpm.get(1, MasterVersion); }));
+    assert(fpMap_throws<VersionNotExist>([&]{ fpm.put(2, 20, 3); }));
+    assert(fpMap_throws<VersionNotExist>([&]{ fpm.contains(1, 3); }));
+    assert(fpMap_throws<ObjectNotExist>([&]{ fpm.get(1, 1); }));
+    assert(fpMap_throws<ObjectNotExist>([&]{ fpm.erase(2); }));
+
+    // a failed update creates no version:
+    assert(fpm.curr_version() == 2 && fpm.size(MasterVersion) == 0 && fpm.size(3) == 0);
+
+    // a moved map keeps its versions:
+    fpMap<int, int> moved = std::move(fpm);
+    assert(moved.get(1) == 10 && moved.put(1, 11) == 3 && moved.get(1, 2) == 10);
+
+    cout << "fpMap::test_fpMap_exceptions " << PRINT_GREEN("PASSED") << endl;
+}
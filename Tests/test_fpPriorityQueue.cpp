@@ -0,0 +1,146 @@
+#include "fpPriorityQueue.hpp"
+
+#include <algorithm>
+#include <random>
+
+using namespace pds;
+using namespace std;
+
+#define PDS_RAND_ARR_SIZE 1000
+
+void test_fpPriorityQueue_basic();
+void test_fpPriorityQueue_random();
+void test_fpPriorityQueue_exceptions();
+
+void test_fpPriorityQueue(){
+
+    try{
+        test_fpPriorityQueue_basic();
+        test_fpPriorityQueue_random();
+        test_fpPriorityQueue_exceptions();
+    }
+    catch(const pdsExcept& e){
+
+        throw pdsExcept("test_fpPriorityQueue: pdsExcept: " + string(e.what()));
+    }
+    catch(const exception& e){
+
+        throw pdsExcept("test_fpPriorityQueue: std::Exception: " + string(e.what()));
+    }
+    cout << "ALL fpPriorityQueue tests " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+void test_fpPriorityQueue_basic(){
+
+    fpPriorityQueue<int> pending;
+
+    assert(pending.curr_version() == 1 && pending.empty());
+
+    assert(pending.push(5) == 2);
+    assert(pending.push(3) == 3);
+    assert(pending.push(3) == 4);
+    assert(pending.pop() == 5);
+    assert(pending.push(1, 2) == 6);
+    assert(pending.pop(3) == 7);
+
+    assert(pending.top(2) == 5 && pending.top(3) == 3 && pending.top(5) == 3);
+    assert(pending.top(6) == 1 && pending.top(7) == 5);
+    assert(pending.size(4) == 3 && pending.size(5) == 2 && pending.size(7) == 1 && as_const(pending).empty(1));
+
+    assert(pending.to_vector(4) == (vector<int>{3, 3, 5}));
+    assert(pending.to_vector(6) == (vector<int>{1, 5}));
+
+    vector<int> objs;
+    for(auto it = pending.begin(5); it != pending.end(5); ++it)
+        objs.push_back(*it);
+
+    assert(objs == (vector<int>{3, 5}));
+
+    cout << "fpPriorityQueue::test_fpPriorityQueue_basic " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpPriorityQueue_random(){
+
+    mt19937 gen(random_device{}());
+
+    fpPriorityQueue<int, SLOTS> fpq;
+    vector<vector<int>> versions = {{}, {}};    // Version 0 is not used. Every version is sorted.
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE * 4; ++i){
+
+        version_t base = (i % 4 == 0) ? 1 + gen() % fpq.curr_version() : fpq.curr_version();
+        vector<int> next = versions[base];
+
+        if(gen() % 3 == 0 && !next.empty()){
+
+            assert(fpq.top(base) == next.front());
+            assert(fpq.pop(base) == versions.size());
+            next.erase(next.begin());
+        }
+        else{
+            // Few different objects, so many of them are equal.
+            int obj = gen() % 64;
+
+            assert(fpq.push(obj, base) == versions.size());
+            next.insert(upper_bound(next.begin(), next.end(), obj), obj);
+        }
+        versions.push_back(std::move(next));
+    }
+
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        assert(fpq.size(v) == versions[v].size() && fpq.to_vector(v) == versions[v]);
+
+        if(!versions[v].empty())
+            assert(fpq.top(v) == versions[v].front());
+    }
+}
+
+
+void test_fpPriorityQueue_random(){
+
+    fpPriorityQueue_random<fpHashSlots>();
+    fpPriorityQueue_random<fpFlatSlots<>>();
+    fpPriorityQueue_random<fpConcurrentSlots<>>();
+
+    cout << "fpPriorityQueue::test_fpPriorityQueue_random " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class EXCEPT, class FUNC>
+bool fpPriorityQueue_throws(FUNC&& func){
+
+    try{
+        func();
+    }
+    catch(const EXCEPT&){
+        return true;
+    }
+    return false;
+}
+
+
+void test_fpPriorityQueue_exceptions(){
+
+    fpPriorityQueue<int> fpq;
+    fpq.push(10);
+
+    assert(fpPriorityQueue_throws<VersionZeroIllegal>([&]{ fpq.push(20, MasterVersion); }));
+    assert(fpPriorityQueue_throws<VersionZeroIllegal>([&]{ fpq.top(MasterVersion); }));
+    assert(fpPriorityQueue_throws<VersionNotExist>([&]{ fpq.pop(3); }));
+    assert(fpPriorityQueue_throws<VersionNotExist>([&]{ fpq.to_vector(3); }));
+    assert(fpPriorityQueue_throws<ObjectNotExist>([&]{ fpq.top(1); }));
+    assert(fpPriorityQueue_throws<ObjectNotExist>([&]{ fpq.pop(1); }));
+
+    // a failed update creates no version:
+    assert(fpq.curr_version() == 2 && fpq.size(MasterVersion) == 0 && fpq.empty(3));
+
+    // a moved queue keeps its versions:
+    fpPriorityQueue<int> moved = std::move(fpq);
+    assert(moved.top() == 10 && moved.pop() == 3 && moved.empty() && moved.top(2) == 10);
+
+    cout << "fpPriorityQueue::test_fpPriorityQueue_exceptions " << PRINT_GREEN("PASSED") << endl;
+}
@@ -1,4 +1,18 @@
 #include "fpSet.hpp"
+#include "fpSetImage.hpp"
+#include "fpSetLog.hpp"
+
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string_view>
+#include <thread>
+
+#include <sys/resource.h>
 
 using namespace pds;
 using namespace std;
@@ -12,6 +26,22 @@ void test_fpSet_insert_to_2_or_3();
 void test_fpSet_remove();
 void test_fpSet_contains();
 void test_fpSet_to_vector();
+void test_fpSet_flat_slots();
+void test_fpSet_apply();
+void test_fpSet_from_sorted();
+void test_fpSet_iterators();
+void test_fpSet_rank_select();
+void test_fpSet_diff();
+void test_fpSet_set_algebra();
+void test_fpSet_concurrent_readers();
+void test_fpSet_node_splitting();
+void test_fpSet_retire();
+void test_fpSet_save_load();
+void test_fpSet_image();
+void test_fpSet_log();
+void test_fpSet_compare();
+void test_fpSet_memory_resource();
+void test_fpSet_memory_stats();
 
 void test_fpSet(){
 
@@ -23,6 +53,22 @@ void test_fpSet(){
         test_fpSet_remove();
         test_fpSet_contains();
         test_fpSet_to_vector();
+        test_fpSet_flat_slots();
+        test_fpSet_apply();
+        test_fpSet_from_sorted();
+        test_fpSet_iterators();
+        test_fpSet_rank_select();
+        test_fpSet_diff();
+        test_fpSet_set_algebra();
+        test_fpSet_concurrent_readers();
+        test_fpSet_node_splitting();
+        test_fpSet_retire();
+        test_fpSet_save_load();
+        test_fpSet_image();
+        test_fpSet_log();
+        test_fpSet_compare();
+        test_fpSet_memory_resource();
+        test_fpSet_memory_stats();
     }
     catch(const pdsExcept& e){
 
@@ -63,6 +109,10 @@ void test_fpSet_basic(){
     }
     assert(fps.to_vector() == versions.back());
 
+    // the size is read through a const set:
+    const fpSet<string>& view = fps;
+    assert(view.size(3) == 2 && view.size() == objs.size() && view.size(curr_v + 1) == 0);
+
 
     string new_obj = "e";
     vector<vector<string>> new_versions = {{"a", "e"}, 
@@ -274,13 +324,132 @@ void test_fpSet_insert_to_2_or_3(){
 
 void test_fpSet_remove(){
 
-    // TODO
+    /*** preperation for the fpSet tests ***/
+    srand(time(NULL));
+
+    // versions[v] is the expected content of version v
+    vector<set<int>> versions(2);
+    /*** ***/
+
+    fpSet<int> fps;
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        version_t base = (rand() % 3 == 0) ? 1 + (rand() % fps.curr_version()) : fps.curr_version();
+        int obj = rand() % (PDS_RAND_ARR_SIZE / 10);
+
+        set<int> next = versions[base];
+
+        if(next.count(obj)){
+
+            assert(fps.remove(obj, base) == versions.size());
+            assert(fps.contains(obj, versions.size()) == false);
+            next.erase(obj);
+        }
+        else{
+            assert(fps.insert(obj, base) == versions.size());
+            next.insert(obj);
+        }
+        assert(fps.contains(obj) == true); // master version keep contains obj
+        versions.push_back(next);
+    }
+
+    // every old version remains the same:
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        assert(fps.size(v) == versions[v].size());
+        assert(fps.to_vector(v) == vector<int>(versions[v].begin(), versions[v].end()));
+    }
+
+    // sorted keys keep the tree balanced:
+    fpSet<int, less<>, fpFlatSlots<>> sorted_fps;
+
+    for(int i = 0; i < PDS_RAND_ARR_SIZE * 10; ++i){
+
+        assert(sorted_fps.insert(i) == version_t(i + 2));
+    }
+    for(int i = 0; i < PDS_RAND_ARR_SIZE * 10; i += 2){
+
+        sorted_fps.remove(i);
+    }
+    assert(sorted_fps.size(sorted_fps.curr_version()) == PDS_RAND_ARR_SIZE * 5);
+    assert(sorted_fps.contains(PDS_RAND_ARR_SIZE * 10 - 1, sorted_fps.curr_version()));
+    assert(sorted_fps.contains(0, sorted_fps.curr_version()) == false);
+
+    cout << "fpSet::test_fpSet_remove " << PRINT_GREEN("PASSED") << endl;
 }
 
 
 void test_fpSet_contains(){
 
-    // TODO
+    // every version v holds the objects [0, v - 1), inserted in shuffled order:
+    vector<int> objs(PDS_RAND_ARR_SIZE);
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        objs[i] = i;
+    }
+    shuffle(objs.begin(), objs.end(), mt19937(time(NULL)));
+
+    fpSet<int, less<>, fpFlatSlots<>> fps;
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        assert(fps.insert(objs[i]) == i + 2);
+    }
+
+    for(version_t v = 1; v <= fps.curr_version(); v += 7){
+
+        for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+            assert(fps.contains(objs[i], v) == (i + 2 <= v));
+            assert(fps.contains_unchecked(objs[i], v) == (i + 2 <= v));
+        }
+        assert(fps.contains_unchecked(-1, v) == false);
+    }
+
+    bool thrown = false;
+    try{
+        fps.contains(objs[0], fps.curr_version() + 1);
+    }
+    catch(const VersionNotExist&){
+        thrown = true;
+    }
+    assert(thrown);
+
+    // a checked tracker throws on a child that has no slot of its version, and does not read it:
+    fpFatNodeArena<int> arena;
+    fpFatNodePtr<int> root(1);
+    root.slot(1) = {arena.make(5, version_t(2), uint64_t(0)), 1};
+
+    fpSetTracker<int> tracker(root, 1);
+    assert(tracker.obj() == 5);
+
+    for(bool left : {true, false}){
+
+        thrown = false;
+        try{
+            left ? tracker.get_left() : tracker.get_right();
+        }
+        catch(const VersionNotExist&){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    // an unchecked tracker returns the node it resolved, without a second lookup:
+    fpSetTracker<int, fpHashSlots, false> unchecked(root, 1);
+    assert(*unchecked == *tracker && (*unchecked)->get_obj() == 5);
+
+    // the nodes stay in place when the set is moved:
+    fpSet<int, less<>, fpFlatSlots<>> moved = std::move(fps);
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        assert(moved.contains(objs[i], moved.curr_version()));
+    }
+
+    cout << "fpSet::test_fpSet_contains " << PRINT_GREEN("PASSED") << endl;
 }
 
 
@@ -289,3 +458,1949 @@ void test_fpSet_to_vector(){
     // TODO
 }
 
+
+template <class SLOTS>
+vector<vector<int>> fpSet_insert_history(const vector<int>& objs, const vector<version_t>& insert_to){
+
+    fpSet<int, less<>, SLOTS> fps;
+
+    for(size_t i = 0; i < objs.size(); ++i){
+
+        assert(fps.insert(objs[i], insert_to[i]) == i + 2);
+    }
+
+    vector<vector<int>> history;
+
+    for(version_t v = 0; v <= fps.curr_version(); ++v){
+
+        history.push_back(fps.to_vector(v));
+
+        for(int obj : history.back()){
+
+            assert(fps.contains(obj, v));
+        }
+    }
+    return history;
+}
+
+
+void test_fpSet_flat_slots(){
+
+    /*** preperation for the fpSet tests ***/
+
+    vector<int> objs(PDS_RAND_ARR_SIZE);
+    vector<version_t> insert_to(PDS_RAND_ARR_SIZE);
+    srand(time(NULL));
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        objs[i] = (rand() % PDS_RAND_ARR_SIZE) + (i * PDS_RAND_ARR_SIZE);
+        insert_to[i] = 1 + (rand() % (i + 1));
+    }
+    shuffle(objs.begin(), objs.end(), mt19937(time(NULL)));
+    /*** ***/
+
+    vector<vector<int>> hash_history = fpSet_insert_history<fpHashSlots>(objs, insert_to);
+
+    assert(fpSet_insert_history<fpFlatSlots<1>>(objs, insert_to) == hash_history);
+    assert(fpSet_insert_history<fpFlatSlots<2>>(objs, insert_to) == hash_history);
+    assert(fpSet_insert_history<fpFlatSlots<8>>(objs, insert_to) == hash_history);
+    assert(fpSet_insert_history<fpConcurrentSlots<1>>(objs, insert_to) == hash_history);
+    assert(fpSet_insert_history<fpConcurrentSlots<2>>(objs, insert_to) == hash_history);
+
+    fpSet<string, less<>, fpFlatSlots<>> fps;
+    assert(fps.insert("b") == 2);
+    assert(fps.insert("a") == 3);
+    assert(fps.insert("c", 2) == 4);
+    assert(fps.remove("c") == 5);
+    assert(fps.to_vector(4) == vector<string>({"b", "c"}));
+    assert(fps.to_vector(5) == vector<string>({"b"}));
+    assert(fps.to_vector() == vector<string>({"a", "b", "c"}));
+
+    cout << "fpSet::test_fpSet_flat_slots " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpSet_apply_random(){
+
+    srand(time(NULL));
+
+    // versions[v] is the expected content of version v
+    vector<set<int>> versions(2);
+
+    fpSet<int, less<>, SLOTS> fps;
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE / 10; ++i){
+
+        version_t base = (rand() % 3 == 0) ? 1 + (rand() % fps.curr_version()) : fps.curr_version();
+
+        set<int> next = versions[base];
+        set<int> touched;
+        vector<fpBatchOp<int>> batch;
+
+        for(size_t b = rand() % 40; b > 0; --b){
+
+            int obj = rand() % PDS_RAND_ARR_SIZE;
+
+            if(!touched.insert(obj).second)
+                continue;
+
+            if(next.count(obj)){
+
+                batch.push_back({fpOp::remove, obj});
+                next.erase(obj);
+            }
+            else{
+                batch.push_back({fpOp::insert, obj});
+                next.insert(obj);
+            }
+        }
+        assert(fps.apply(batch, base) == versions.size());
+        versions.push_back(next);
+    }
+
+    // every version (also the old ones) is exactly its expected set:
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        assert(fps.size(v) == versions[v].size());
+        assert(fps.to_vector(v) == vector<int>(versions[v].begin(), versions[v].end()));
+    }
+
+    // single operations and batches can be mixed:
+    version_t v = fps.insert(PDS_RAND_ARR_SIZE);
+    assert(fps.contains(PDS_RAND_ARR_SIZE, v));
+    assert(fps.apply({{fpOp::remove, PDS_RAND_ARR_SIZE}}) == v + 1);
+    assert(fps.contains(PDS_RAND_ARR_SIZE, v + 1) == false);
+}
+
+
+void test_fpSet_apply(){
+
+    fpSet_apply_random<fpHashSlots>();
+    fpSet_apply_random<fpFlatSlots<>>();
+
+    fpSet<int> fps;
+
+    // a snapshot is loaded as one version:
+    vector<fpBatchOp<int>> snapshot;
+
+    for(int i = PDS_RAND_ARR_SIZE - 1; i >= 0; --i){
+
+        snapshot.push_back({fpOp::insert, i});
+    }
+    assert(fps.apply(snapshot) == 2);
+    assert(fps.size(2) == PDS_RAND_ARR_SIZE);
+    assert(fps.apply({}) == 3);
+    assert(fps.size(3) == PDS_RAND_ARR_SIZE);
+
+    // an invalid batch throws and creates no version:
+    auto throws = [&](vector<fpBatchOp<int>> batch){
+        try{
+            fps.apply(batch);
+        }
+        catch(const pdsExcept&){
+            return true;
+        }
+        return false;
+    };
+    assert(throws({{fpOp::remove, 1}, {fpOp::insert, 0}}));
+    assert(throws({{fpOp::insert, PDS_RAND_ARR_SIZE}, {fpOp::remove, -1}}));
+    assert(throws({{fpOp::remove, 1}, {fpOp::remove, 1}}));
+    assert(fps.curr_version() == 3);
+    assert(fps.contains(PDS_RAND_ARR_SIZE) == false);
+    assert(fps.contains(1, 3));
+
+    cout << "fpSet::test_fpSet_apply " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+void test_fpSet_from_sorted(){
+
+    srand(time(NULL));
+
+    vector<int> objs;
+
+    for(int i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        objs.push_back(3 * i);
+    }
+
+    fpSet<int, less<>, fpFlatSlots<>> fps = fpSet<int, less<>, fpFlatSlots<>>::from_sorted(objs.begin(), objs.end());
+
+    assert(fps.curr_version() == 2);
+    assert(fps.size(1) == 0);
+    assert(fps.size(2) == PDS_RAND_ARR_SIZE);
+    assert(fps.size() == PDS_RAND_ARR_SIZE);
+    assert(fps.to_vector(1).empty());
+    assert(fps.to_vector(2) == objs);
+    assert(fps.to_vector() == objs);
+
+    // the loaded set keeps working as a usual one:
+    vector<set<int>> versions{{}, {}, set<int>(objs.begin(), objs.end())};
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        version_t base = 1 + (rand() % fps.curr_version());
+        int obj = rand() % (3 * PDS_RAND_ARR_SIZE);
+
+        set<int> next = versions[base];
+
+        if(next.count(obj)){
+
+            assert(fps.remove(obj, base) == versions.size());
+            next.erase(obj);
+        }
+        else{
+            assert(fps.insert(obj, base) == versions.size());
+            next.insert(obj);
+        }
+        versions.push_back(next);
+    }
+
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        assert(fps.to_vector(v) == vector<int>(versions[v].begin(), versions[v].end()));
+    }
+
+    // strings are moved into the set:
+    vector<string> strs{"a", "b", "c"};
+    fpSet<string> str_fps = fpSet<string>::from_sorted(make_move_iterator(strs.begin()), make_move_iterator(strs.end()));
+    assert(str_fps.to_vector(2) == vector<string>({"a", "b", "c"}));
+
+    // an empty range creates an empty version 2:
+    assert(fpSet<int>::from_sorted(objs.begin(), objs.begin()).size(2) == 0);
+
+    bool thrown = false;
+    try{
+        vector<int> not_sorted{1, 2, 2, 3};
+        fpSet<int>::from_sorted(not_sorted.begin(), not_sorted.end());
+    }
+    catch(const ObjectsNotSorted&){
+        thrown = true;
+    }
+    assert(thrown);
+
+    cout << "fpSet::test_fpSet_from_sorted " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+void test_fpSet_iterators(){
+
+    static_assert(std::bidirectional_iterator<fpSet<int>::iterator>);
+
+    srand(time(NULL));
+
+    // versions[v] is the expected content of version v
+    vector<set<int>> versions(2);
+
+    fpSet<int, less<>, fpFlatSlots<>> fps;
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        version_t base = 1 + (rand() % fps.curr_version());
+        int obj = 2 * (rand() % (PDS_RAND_ARR_SIZE / 10));
+
+        set<int> next = versions[base];
+
+        if(next.count(obj)){
+
+            fps.remove(obj, base);
+            next.erase(obj);
+        }
+        else{
+            fps.insert(obj, base);
+            next.insert(obj);
+        }
+        versions.push_back(next);
+    }
+
+    for(version_t v = 1; v < versions.size(); v += 3){
+
+        const set<int>& expected = versions[v];
+
+        assert(vector<int>(fps.begin(v), fps.end(v)) == vector<int>(expected.begin(), expected.end()));
+        assert(vector<int>(fps.rbegin(v), fps.rend(v)) == vector<int>(expected.rbegin(), expected.rend()));
+
+        // odd objects are never in the set, even objects may be:
+        for(int obj = -1; obj <= PDS_RAND_ARR_SIZE / 5; ++obj){
+
+            auto lower = fps.lower_bound(obj, v);
+            auto upper = fps.upper_bound(obj, v);
+
+            assert(lower == fps.end(v) ? expected.lower_bound(obj) == expected.end() : *lower == *expected.lower_bound(obj));
+            assert(upper == fps.end(v) ? expected.upper_bound(obj) == expected.end() : *upper == *expected.upper_bound(obj));
+        }
+
+        int lo = rand() % (PDS_RAND_ARR_SIZE / 5), hi = lo + rand() % 40;
+        vector<int> in_range;
+
+        for(int obj : fps.range(lo, hi, v)){
+
+            in_range.push_back(obj);
+        }
+        assert(in_range == vector<int>(expected.lower_bound(lo), expected.lower_bound(max(lo, hi))));
+        assert(std::ranges::distance(fps.range(hi, lo, v)) == 0);
+    }
+
+    // going back from the end, and from the middle:
+    version_t last = fps.curr_version();
+
+    if(fps.size(last) > 0){
+
+        auto it = fps.end(last);
+        --it;
+        assert(*it == *versions[last].rbegin());
+
+        auto mid = fps.lower_bound(*versions[last].begin(), last);
+        assert(mid == fps.begin(last));
+        ++mid;
+        --mid;
+        assert(mid == fps.begin(last));
+    }
+
+    // the default version iterates all the objects ever inserted:
+    set<int> all;
+
+    for(const set<int>& version : versions){
+
+        all.insert(version.begin(), version.end());
+    }
+    assert(vector<int>(fps.begin(), fps.end()) == vector<int>(all.begin(), all.end()));
+
+    cout << "fpSet::test_fpSet_iterators " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpSet_check_rank_select(fpSet<int, less<>, SLOTS>& fps, version_t v, const set<int>& expected){
+
+    size_t k = 0;
+
+    for(int obj : expected){
+
+        assert(fps.select(k, v) == obj);
+        assert(fps.rank(obj, v) == k);
+        assert(fps.rank(obj + 1, v) == k + 1);  // the objects are even
+        ++k;
+    }
+    assert(fps.rank(-1, v) == 0);
+
+    bool thrown = false;
+    try{
+        fps.select(expected.size(), v);
+    }
+    catch(const ObjectNotExist&){
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+
+void test_fpSet_rank_select(){
+
+    srand(time(NULL));
+
+    vector<int> sorted;
+
+    for(int i = 0; i < PDS_RAND_ARR_SIZE / 10; ++i){
+
+        sorted.push_back(4 * i);
+    }
+
+    // versions[v] is the expected content of version v
+    vector<set<int>> versions{{}, {}, set<int>(sorted.begin(), sorted.end())};
+    set<int> all(sorted.begin(), sorted.end());
+
+    fpSet<int, less<>, fpFlatSlots<>> fps = fpSet<int, less<>, fpFlatSlots<>>::from_sorted(sorted.begin(), sorted.end());
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE / 2; ++i){
+
+        version_t base = 1 + (rand() % fps.curr_version());
+        set<int> next = versions[base];
+        set<int> touched;
+        vector<fpBatchOp<int>> batch;
+
+        for(size_t b = 0; b < 2; ++b){
+
+            int obj = 2 * (rand() % PDS_RAND_ARR_SIZE);
+
+            if(!touched.insert(obj).second)
+                continue;
+
+            if(next.count(obj)){
+
+                batch.push_back({fpOp::remove, obj});
+                next.erase(obj);
+            }
+            else{
+                batch.push_back({fpOp::insert, obj});
+                next.insert(obj);
+                all.insert(obj);
+            }
+        }
+
+        if(batch.size() == 1 && batch[0].op == fpOp::insert)
+            fps.insert(batch[0].obj, base);
+        else
+            fps.apply(batch, base);
+
+        versions.push_back(next);
+    }
+
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        fpSet_check_rank_select(fps, v, versions[v]);
+    }
+    fpSet_check_rank_select(fps, MasterVersion, all);
+
+    // the hash engine keeps the same counts:
+    fpSet<int> hash_fps;
+
+    for(int obj : sorted){
+
+        hash_fps.insert(obj);
+    }
+    hash_fps.remove(sorted[0]);
+    fpSet_check_rank_select(hash_fps, hash_fps.curr_version(), set<int>(sorted.begin() + 1, sorted.end()));
+
+    cout << "fpSet::test_fpSet_rank_select " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+void test_fpSet_diff(){
+
+    srand(time(NULL));
+
+    vector<int> sorted;
+
+    for(int i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        sorted.push_back(i);
+    }
+
+    // versions[v] is the expected content of version v
+    vector<set<int>> versions{{}, {}, set<int>(sorted.begin(), sorted.end())};
+
+    fpSet<int, less<>, fpFlatSlots<>> fps = fpSet<int, less<>, fpFlatSlots<>>::from_sorted(sorted.begin(), sorted.end());
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE / 5; ++i){
+
+        version_t base = 1 + (rand() % fps.curr_version());
+        int obj = rand() % (2 * PDS_RAND_ARR_SIZE);
+
+        set<int> next = versions[base];
+
+        if(next.count(obj)){
+
+            fps.remove(obj, base);
+            next.erase(obj);
+        }
+        else{
+            fps.insert(obj, base);
+            next.insert(obj);
+        }
+        versions.push_back(next);
+    }
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE / 5; ++i){
+
+        version_t a = rand() % versions.size();
+        version_t b = (i % 4 == 0) ? a : rand() % versions.size();
+
+        if(a == MasterVersion || b == MasterVersion)
+            continue;
+
+        vector<int> inserted, removed;
+
+        set_difference(versions[b].begin(), versions[b].end(), versions[a].begin(), versions[a].end(), back_inserter(inserted));
+        set_difference(versions[a].begin(), versions[a].end(), versions[b].begin(), versions[b].end(), back_inserter(removed));
+
+        fpDiff<int> changes = fps.diff(a, b);
+
+        assert(changes.inserted == inserted);
+        assert(changes.removed == removed);
+    }
+
+    // every object that was removed from some version is still in the master version:
+    fpDiff<int> from_master = fps.diff(MasterVersion, fps.curr_version());
+    assert(from_master.inserted.empty());
+    assert(from_master.removed.size() == fps.size() - fps.size(fps.curr_version()));
+
+    cout << "fpSet::test_fpSet_diff " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpSet_set_algebra_random(){
+
+    srand(time(NULL));
+
+    // versions[v] is the expected content of version v
+    vector<set<int>> versions(2);
+
+    fpSet<int, less<>, SLOTS> fps;
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE / 2; ++i){
+
+        version_t base = 1 + (rand() % fps.curr_version());
+        int obj = 2 * (rand() % (PDS_RAND_ARR_SIZE / 5));
+
+        set<int> next = versions[base];
+
+        if(next.count(obj)){
+
+            fps.remove(obj, base);
+            next.erase(obj);
+        }
+        else{
+            fps.insert(obj, base);
+            next.insert(obj);
+        }
+        versions.push_back(next);
+    }
+
+    // the results are combined again, so they share subtrees with the versions they came from:
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE / 2; ++i){
+
+        version_t a = 1 + (rand() % (versions.size() - 1));
+        version_t b = (i % 8 == 0) ? a : 1 + (rand() % (versions.size() - 1));
+
+        const set<int>& x = versions[a];
+        const set<int>& y = versions[b];
+        set<int> expected;
+
+        switch(i % 3){
+            case 0:
+                set_union(x.begin(), x.end(), y.begin(), y.end(), inserter(expected, expected.end()));
+                assert(fps.merge_union(a, b) == versions.size());
+                break;
+            case 1:
+                set_intersection(x.begin(), x.end(), y.begin(), y.end(), inserter(expected, expected.end()));
+                assert(fps.intersect(a, b) == versions.size());
+                break;
+            default:
+                set_difference(x.begin(), x.end(), y.begin(), y.end(), inserter(expected, expected.end()));
+                assert(fps.subtract(a, b) == versions.size());
+        }
+        versions.push_back(expected);
+    }
+
+    // every version (also the old ones) is exactly its expected set:
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        assert(fps.size(v) == versions[v].size());
+        assert(fps.to_vector(v) == vector<int>(versions[v].begin(), versions[v].end()));
+    }
+
+    // the new versions keep working as usual ones:
+    version_t last = fps.curr_version();
+    fpSet_check_rank_select(fps, last, versions[last]);
+
+    version_t v = fps.insert(-2, last);
+    assert(fps.contains(-2, v));
+    assert(fps.size(v) == versions[last].size() + 1);
+}
+
+
+void test_fpSet_set_algebra(){
+
+    fpSet_set_algebra_random<fpHashSlots>();
+    fpSet_set_algebra_random<fpFlatSlots<>>();
+    fpSet_set_algebra_random<fpConcurrentSlots<>>();
+
+    fpSet<string> fps;
+    assert(fps.apply({{fpOp::insert, "a"}, {fpOp::insert, "b"}}) == 2);
+    assert(fps.apply({{fpOp::insert, "b"}, {fpOp::insert, "c"}}, 1) == 3);
+
+    assert(fps.merge_union(2, 3) == 4);
+    assert(fps.intersect(2, 3) == 5);
+    assert(fps.subtract(2, 3) == 6);
+    assert(fps.subtract(2, 2) == 7);
+
+    assert(fps.to_vector(4) == vector<string>({"a", "b", "c"}));
+    assert(fps.to_vector(5) == vector<string>({"b"}));
+    assert(fps.to_vector(6) == vector<string>({"a"}));
+    assert(fps.to_vector(7).empty());
+    assert(fps.to_vector(2) == vector<string>({"a", "b"}));
+    assert(fps.to_vector(3) == vector<string>({"b", "c"}));
+
+    auto throws = [&](auto&& operation){
+        try{
+            operation();
+        }
+        catch(const pdsExcept&){
+            return true;
+        }
+        return false;
+    };
+    assert(throws([&]{ fps.merge_union(MasterVersion, 2); }));
+    assert(throws([&]{ fps.intersect(2, fps.curr_version() + 1); }));
+    assert(fps.curr_version() == 7);
+
+    cout << "fpSet::test_fpSet_set_algebra " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+void test_fpSet_concurrent_readers(){
+
+    // version v holds the objects [0, v - 1), the readers check the versions while they are created:
+    fpSet<int, less<>, fpConcurrentSlots<>> fps;
+
+    atomic<bool> done = false;
+    atomic<size_t> errors = 0;
+
+    auto reader = [&](unsigned seed){
+
+        mt19937 gen(seed);
+
+        while(!done){
+
+            version_t v = 1 + (gen() % fps.curr_version());
+            int obj = gen() % PDS_RAND_ARR_SIZE;
+
+            if(fps.contains(obj, v) != (version_t(obj) + 2 <= v) || fps.size(v) != v - 1)
+                ++errors;
+
+            if(v > 1 && (fps.select(v - 2, v) != int(v - 2) || fps.rank(obj, v) != min<size_t>(obj, v - 1)))
+                ++errors;
+        }
+    };
+
+    vector<thread> readers;
+
+    for(unsigned i = 0; i < 3; ++i){
+
+        readers.emplace_back(reader, i);
+    }
+
+    for(int i = 0; i < PDS_RAND_ARR_SIZE * 5; ++i){
+
+        fps.insert(i);
+    }
+    done = true;
+
+    for(thread& t : readers){
+
+        t.join();
+    }
+    assert(errors == 0);
+    assert(fps.size(fps.curr_version()) == PDS_RAND_ARR_SIZE * 5);
+
+    // the entries are published with their values, and only in the order of their versions:
+    fpSlotTable<int, fpConcurrentSlots<1>> table;
+    table.slot(1) = 1;
+    table.slot(3) = 3;
+    table.alias(4, 1);
+
+    bool thrown = false;
+    try{
+        table.slot(2);
+    }
+    catch(const OperationNotSupported&){
+        thrown = true;
+    }
+    version_t slot;
+    assert(thrown && table.versions() == 3);
+    assert(*table.resolve(4, slot) == 1 && slot == 1 && *table.find(3) == 3);
+
+    cout << "fpSet::test_fpSet_concurrent_readers " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpSet_node_splitting_random(){
+
+    srand(time(NULL));
+
+    // a few objects, so every node is written by many more versions than its capacity:
+    const int objs = 16;
+    vector<set<int>> versions(2);
+
+    fpSet<string, less<>, SLOTS> fps;
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE * 2; ++i){
+
+        version_t base = (i % 4 == 0) ? 1 + (rand() % fps.curr_version()) : fps.curr_version();
+        int obj = rand() % objs;
+
+        set<int> next = versions[base];
+
+        if(i % 16 == 15){
+
+            version_t other = 1 + (rand() % fps.curr_version());
+            next.insert(versions[other].begin(), versions[other].end());
+            fps.merge_union(base, other);
+        }
+        else if(next.count(obj)){
+
+            fps.remove(to_string(obj), base);
+            next.erase(obj);
+        }
+        else{
+            fps.insert(to_string(obj), base);
+            next.insert(obj);
+        }
+        versions.push_back(next);
+    }
+
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        assert(fps.size(v) == versions[v].size());
+
+        for(int obj = 0; obj < objs; ++obj){
+
+            assert(fps.contains(to_string(obj), v) == (versions[v].count(obj) == 1));
+        }
+    }
+    assert(fps.size() == objs);
+}
+
+
+void test_fpSet_node_splitting(){
+
+    fpSet_node_splitting_random<fpHashSlots>();
+    fpSet_node_splitting_random<fpFlatSlots<>>();
+    fpSet_node_splitting_random<fpConcurrentSlots<>>();
+
+    // the same node is removed and inserted again by every version:
+    vector<int> sorted = {1, 2, 3};
+    fpSet<int, less<>, fpFlatSlots<>> fps = fpSet<int, less<>, fpFlatSlots<>>::from_sorted(sorted.begin(), sorted.end());
+
+    for(size_t i = 0; i < 10 * fpFatNodeCapacity; ++i){
+
+        version_t v = (i % 2 == 0) ? fps.remove(2) : fps.insert(2);
+        assert(fps.to_vector(v) == ((i % 2 == 0) ? vector<int>({1, 3}) : vector<int>({1, 2, 3})));
+    }
+    assert(fps.to_vector(2) == sorted);
+    assert(fps.to_vector(3) == vector<int>({1, 3}));
+    assert(fps.diff(3, fps.curr_version()).inserted == vector<int>({2}));
+    assert(fps.rank(3, fps.curr_version()) == 2);
+
+    cout << "fpSet::test_fpSet_node_splitting " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+/// @brief true if 'func' throws EXCEPT.
+template <class EXCEPT, class FUNC>
+bool fpSet_throws(FUNC&& func){
+
+    try{
+        func();
+    }
+    catch(const EXCEPT&){
+        return true;
+    }
+    return false;
+}
+
+
+template <class SLOTS>
+void fpSet_retire_random(){
+
+    srand(time(NULL));
+
+    const int objs = 64;
+    vector<set<int>> versions(2);
+    vector<bool> live(2, true);
+
+    fpSet<string, less<>, SLOTS> fps;
+
+    auto live_version = [&](){
+
+        version_t v;
+        do{ v = 1 + (rand() % fps.curr_version()); } while(!live[v]);
+        return v;
+    };
+
+    auto check = [&](){
+
+        set<int> all;
+
+        for(version_t v = 1; v < versions.size(); ++v){
+
+            if(!live[v]){
+
+                assert(fps.size(v) == 0);
+                assert(fpSet_throws<VersionNotExist>([&]{ fps.contains("0", v); }));
+                assert(fpSet_throws<VersionNotExist>([&]{ fps.insert("0", v); }));
+                continue;
+            }
+            all.insert(versions[v].begin(), versions[v].end());
+
+            vector<string> expected;
+            for(int obj : versions[v])
+                expected.push_back(to_string(obj));
+
+            sort(expected.begin(), expected.end());
+            assert(fps.to_vector(v) == expected);
+        }
+        // an object that is in no live version is not in the master tree anymore:
+        assert(fps.size() == all.size());
+    };
+
+    for(int round = 0; round < 4; ++round){
+
+        for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+            version_t base = (i % 4 == 0) ? live_version() : fps.curr_version();
+
+            if(!live[base])
+                base = live_version();
+
+            int obj = rand() % objs;
+            set<int> next = versions[base];
+
+            if(i % 16 == 15){
+
+                version_t other = live_version();
+                next.insert(versions[other].begin(), versions[other].end());
+                fps.merge_union(base, other);
+            }
+            else if(next.count(obj)){
+
+                fps.remove(to_string(obj), base);
+                next.erase(obj);
+            }
+            else{
+                fps.insert(to_string(obj), base);
+                next.insert(obj);
+            }
+            versions.push_back(next);
+            live.push_back(true);
+        }
+
+        // keep the last versions and a few pinned ones:
+        vector<bool> keep(versions.size());
+        size_t expected = 0;
+
+        for(version_t v = 1; v < versions.size(); ++v){
+
+            keep[v] = v + 16 > fps.curr_version() || rand() % 8 == 0;
+            expected += live[v] && !keep[v];
+            live[v] = live[v] && keep[v];
+        }
+        assert(fps.retain_only([&](version_t v){ return bool(keep[v]); }) == expected);
+        check();
+    }
+}
+
+
+void test_fpSet_retire(){
+
+    fpSet_retire_random<fpHashSlots>();
+    fpSet_retire_random<fpFlatSlots<>>();
+    fpSet_retire_random<fpConcurrentSlots<>>();
+
+    fpSet<int> fps;
+
+    fps.insert(1);              // 2
+    fps.insert(2);              // 3
+    fps.remove(1);              // 4
+    fps.insert(3, 2);           // 5
+
+    assert(fpSet_throws<VersionZeroIllegal>([&]{ fps.retire(0); }));
+    assert(fpSet_throws<VersionNotExist>([&]{ fps.retire(6); }));
+
+    fps.retire(2);
+    fps.retire(3);
+
+    assert(fpSet_throws<VersionNotExist>([&]{ fps.retire(3); }));
+    assert(fpSet_throws<VersionNotExist>([&]{ fps.to_vector(2); }));
+    assert(fpSet_throws<VersionNotExist>([&]{ fps.merge_union(3, 4); }));
+
+    assert(fps.to_vector(4) == vector<int>({2}));
+    assert(fps.to_vector(5) == vector<int>({1, 3}));
+    assert(fps.to_vector() == vector<int>({1, 2, 3}));
+
+    // 1 and 3 are only in version 5:
+    fps.retire(5);
+
+    assert(fps.to_vector() == vector<int>({2}));
+    assert(!fps.contains(1) && !fps.contains(3));
+
+    // the current version is retired, so a new version must name its base:
+    assert(fpSet_throws<VersionNotExist>([&]{ fps.insert(4); }));
+    assert(fps.insert(1, 4) == 6);
+    assert(fps.to_vector(6) == vector<int>({1, 2}));
+    assert(fps.retain_only([](version_t v){ return v == 6; }) == 2);
+    assert(fps.to_vector(6) == vector<int>({1, 2}));
+    assert(fps.size(1) == 0 && fps.size(4) == 0);
+
+    cout << "fpSet::test_fpSet_retire " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpSet_save_load_random(){
+
+    srand(time(NULL));
+
+    const int objs = 64;
+    fpSet<string, less<>, SLOTS> fps;
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE * 2; ++i){
+
+        version_t base = (i % 4 == 0) ? 1 + (rand() % fps.curr_version()) : fps.curr_version();
+        string obj = to_string(rand() % objs);
+
+        if(i % 16 == 15)
+            fps.merge_union(base, 1 + (rand() % fps.curr_version()));
+
+        else if(fps.contains(obj, base))
+            fps.remove(obj, base);
+
+        else fps.insert(obj, base);
+    }
+    fps.retain_only([](version_t v){ return v % 3 != 0; });
+
+    stringstream snapshot;
+    fps.save(snapshot);
+    fpSet<string, less<>, SLOTS> loaded = fpSet<string, less<>, SLOTS>::load(snapshot);
+
+    assert(loaded.curr_version() == fps.curr_version());
+    assert(loaded.to_vector() == fps.to_vector());
+
+    for(version_t v = 1; v <= fps.curr_version(); ++v){
+
+        if(v % 3 == 0){
+
+            assert(fpSet_throws<VersionNotExist>([&]{ loaded.to_vector(v); }));
+            continue;
+        }
+        assert(loaded.to_vector(v) == fps.to_vector(v));
+        assert(loaded.rank("5", v) == fps.rank("5", v));
+    }
+
+    // the loaded set goes on like the saved one:
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        version_t base = 1 + (rand() % fps.curr_version());
+        string obj = to_string(rand() % (2 * objs));
+
+        if(base % 3 == 0)
+            continue;
+
+        if(fps.contains(obj, base)){
+
+            assert(fps.remove(obj, base) == loaded.remove(obj, base));
+        }
+        else{
+            assert(fps.insert(obj, base) == loaded.insert(obj, base));
+        }
+        assert(loaded.to_vector(loaded.curr_version()) == fps.to_vector(fps.curr_version()));
+        assert(loaded.diff(base, loaded.curr_version()).inserted == fps.diff(base, fps.curr_version()).inserted);
+    }
+}
+
+
+/// @brief a codec of its own: a point is written as two 32 bits numbers.
+struct fpSet_point{
+
+    int x, y;
+    vector<int> tags;   // not trivially copyable, and not saved.
+
+    bool operator<(const fpSet_point& other) const { return tie(x, y) < tie(other.x, other.y); }
+};
+
+struct fpSet_point_codec{
+
+    void write(ostream& out, const fpSet_point& p){
+
+        fpCodec<int32_t>::write(out, p.x);
+        fpCodec<int32_t>::write(out, p.y);
+    }
+
+    fpSet_point read(istream& in){
+
+        int x = fpCodec<int32_t>::read(in);
+        int y = fpCodec<int32_t>::read(in);
+        return fpSet_point{x, y, {}};
+    }
+};
+
+
+void test_fpSet_save_load(){
+
+    fpSet_save_load_random<fpHashSlots>();
+    fpSet_save_load_random<fpFlatSlots<>>();
+    fpSet_save_load_random<fpConcurrentSlots<>>();
+
+    // trivially copyable objects, from_sorted and node splitting:
+    vector<int> sorted(PDS_RAND_ARR_SIZE);
+    iota(sorted.begin(), sorted.end(), 0);
+
+    fpSet<int, less<>, fpFlatSlots<>> fps = fpSet<int, less<>, fpFlatSlots<>>::from_sorted(sorted.begin(), sorted.end());
+
+    for(size_t i = 0; i < 4 * fpFatNodeCapacity; ++i){
+
+        (i % 2 == 0) ? fps.remove(500) : fps.insert(500);
+    }
+
+    stringstream snapshot;
+    fps.save(snapshot);
+    string bytes = snapshot.str();
+
+    fpSet<int, less<>, fpFlatSlots<>> loaded = fpSet<int, less<>, fpFlatSlots<>>::load(snapshot);
+
+    for(version_t v = 1; v <= fps.curr_version(); ++v){
+
+        assert(loaded.size(v) == fps.size(v));
+        assert(loaded.contains(500, v) == fps.contains(500, v));
+    }
+    assert(loaded.to_vector(2) == sorted);
+
+    // the next objects get the same priorities in both sets, so their snapshots stay the same:
+    for(int obj : {-1, 2000, 1000}){
+
+        assert(fps.insert(obj) == loaded.insert(obj));
+    }
+    stringstream saved_next, loaded_next;
+    fps.save(saved_next);
+    loaded.save(loaded_next);
+    assert(saved_next.str() == loaded_next.str());
+
+    // an empty set:
+    fpSet<int> empty;
+    stringstream empty_snapshot;
+    empty.save(empty_snapshot);
+
+    fpSet<int> empty_loaded = fpSet<int>::load(empty_snapshot);
+    assert(empty_loaded.curr_version() == 1 && empty_loaded.size() == 0);
+    assert(empty_loaded.insert(3) == 2 && empty_loaded.to_vector(2) == vector<int>({3}));
+
+    // a codec of its own:
+    fpSet<fpSet_point> points;
+    points.insert(fpSet_point{1, 2, {7}});
+    points.insert(fpSet_point{0, 5, {}});
+
+    stringstream points_snapshot;
+    points.save(points_snapshot, fpSet_point_codec{});
+
+    fpSet<fpSet_point> points_loaded = fpSet<fpSet_point>::load(points_snapshot, fpSet_point_codec{});
+    vector<fpSet_point> v3 = points_loaded.to_vector(3);
+    assert(v3.size() == 2 && v3[0].x == 0 && v3[0].y == 5 && v3[1].x == 1 && v3[1].y == 2);
+    assert(points_loaded.size(2) == 1);
+
+    // not a snapshot, and a snapshot that was cut:
+    stringstream garbage("not an fpSet snapshot");
+    assert(fpSet_throws<CorruptedSnapshot>([&]{ fpSet<int>::load(garbage); }));
+
+    stringstream cut(bytes.substr(0, bytes.size() / 2));
+    assert(fpSet_throws<CorruptedSnapshot>([&]{ fpSet<int, less<>, fpFlatSlots<>>::load(cut); }));
+
+    // a flipped bit anywhere, the checksum too:
+    for(size_t pos = 0; pos < bytes.size(); pos += 1 + pos / 8){
+
+        string flipped = bytes;
+        flipped[pos] ^= 0x10;
+
+        stringstream corrupted(flipped);
+        assert(fpSet_throws<CorruptedSnapshot>([&]{ fpSet<int, less<>, fpFlatSlots<>>::load(corrupted); }));
+    }
+
+    // two snapshots in one stream, load reads only its own bytes:
+    stringstream both;
+    empty.save(both);
+    points.save(both, fpSet_point_codec{});
+
+    assert(fpSet<int>::load(both).curr_version() == 1);
+    assert(fpSet<fpSet_point>::load(both, fpSet_point_codec{}).size(3) == 2);
+
+    cout << "fpSet::test_fpSet_save_load " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpSet_image_random(){
+
+    srand(time(NULL));
+
+    const int objs = 64;
+    fpSet<int, less<>, SLOTS> fps;
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE * 2; ++i){
+
+        version_t base = (i % 4 == 0) ? 1 + (rand() % fps.curr_version()) : fps.curr_version();
+        int obj = rand() % objs;
+
+        if(fps.contains(obj, base))
+            fps.remove(obj, base);
+
+        else fps.insert(obj, base);
+    }
+    fps.retain_only([](version_t v){ return v % 5 != 0; });
+
+    stringstream frozen;
+    fps.freeze(frozen);
+    string bytes = frozen.str();
+
+    // an image in memory must be aligned like its header:
+    vector<uint64_t> memory((bytes.size() + 7) / 8);
+    memcpy(memory.data(), bytes.data(), bytes.size());
+
+    fpSetImage<int> image(memory.data(), bytes.size());
+
+    assert(image.curr_version() == fps.curr_version());
+    assert(image.to_vector() == fps.to_vector());
+
+    for(version_t v = 1; v <= fps.curr_version(); ++v){
+
+        if(v % 5 == 0){
+
+            assert(image.size(v) == 0);
+            assert(fpSet_throws<VersionNotExist>([&]{ image.contains(0, v); }));
+            continue;
+        }
+        assert(image.size(v) == fps.size(v));
+        assert(image.to_vector(v) == fps.to_vector(v));
+
+        int obj = rand() % objs;
+        assert(image.contains(obj, v) == fps.contains(obj, v));
+    }
+    assert(image.size(fps.curr_version() + 1) == 0);
+
+    // offsets that wrap around the end of the image:
+    for(uint64_t fpImageHeader::* offset : {&fpImageHeader::nodes_offset, &fpImageHeader::entries_offset}){
+
+        vector<uint64_t> corrupted = memory;
+        reinterpret_cast<fpImageHeader*>(corrupted.data())->*offset = numeric_limits<uint64_t>::max() - 7;
+        assert(fpSet_throws<CorruptedSnapshot>([&]{ fpSetImage<int>(corrupted.data(), bytes.size()); }));
+    }
+}
+
+
+void test_fpSet_image(){
+
+    fpSet_image_random<fpHashSlots>();
+    fpSet_image_random<fpFlatSlots<>>();
+    fpSet_image_random<fpConcurrentSlots<>>();
+
+    // an image file, from_sorted and node splitting:
+    vector<int> sorted(PDS_RAND_ARR_SIZE);
+    iota(sorted.begin(), sorted.end(), 0);
+
+    fpSet<int, less<>, fpFlatSlots<>> fps = fpSet<int, less<>, fpFlatSlots<>>::from_sorted(sorted.begin(), sorted.end());
+
+    for(size_t i = 0; i < 4 * fpFatNodeCapacity; ++i){
+
+        (i % 2 == 0) ? fps.remove(500) : fps.insert(500);
+    }
+
+    string path = (filesystem::temp_directory_path() / "test_fpSet_image.img").string();
+    {
+        ofstream out(path, ios::binary);
+        fps.freeze(out);
+    }
+
+    fpSetImage<int> image = fpSetImage<int>::open(path);
+    fpSetImage<int> moved = std::move(image);
+
+    for(version_t v = 1; v <= fps.curr_version(); ++v){
+
+        assert(moved.size(v) == fps.size(v));
+        assert(moved.contains(500, v) == fps.contains(500, v));
+    }
+    assert(moved.to_vector(2) == sorted);
+    assert(moved.contains(999, 2) && !moved.contains(1000, 2));
+
+    // an image of another object, an image that was cut, and a missing file:
+    assert(fpSet_throws<CorruptedSnapshot>([&]{ fpSetImage<long long>::open(path); }));
+    filesystem::resize_file(path, filesystem::file_size(path) / 2);
+    assert(fpSet_throws<CorruptedSnapshot>([&]{ fpSetImage<int>::open(path); }));
+
+    filesystem::remove(path);
+    assert(fpSet_throws<system_error>([&]{ fpSetImage<int>::open(path); }));
+
+    // an empty set:
+    fpSet<int> empty;
+    stringstream empty_frozen;
+    empty.freeze(empty_frozen);
+    string empty_bytes = empty_frozen.str();
+
+    vector<uint64_t> memory((empty_bytes.size() + 7) / 8);
+    memcpy(memory.data(), empty_bytes.data(), empty_bytes.size());
+
+    fpSetImage<int> empty_image(memory.data(), empty_bytes.size());
+    assert(empty_image.curr_version() == 1 && empty_image.size(1) == 0 && empty_image.to_vector(1).empty());
+
+    cout << "fpSet::test_fpSet_image " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpSet_log_random(){
+
+    srand(time(NULL));
+
+    const int objs = 64;
+    string path = (filesystem::temp_directory_path() / "test_fpSet_log.wal").string();
+    filesystem::remove(path);
+
+    fpSet<string, less<>, SLOTS> fps;
+    stringstream snapshot;
+    {
+        fpSetLog<string> wal(path, 8);
+        fps.set_log(&wal);
+
+        for(size_t i = 0; i < PDS_RAND_ARR_SIZE * 2; ++i){
+
+            if(i == PDS_RAND_ARR_SIZE)
+                fps.save(snapshot);
+
+            // the retired versions are v % 7 == 0, except the current version:
+            version_t base = (i % 4 == 0) ? 1 + (rand() % fps.curr_version()) : fps.curr_version();
+            base = (base % 7 == 0) ? fps.curr_version() : base;
+            string obj = to_string(rand() % objs);
+
+            if(i % 64 == 63){
+
+                version_t last = fps.curr_version();
+                fps.retain_only([last](version_t v){ return v % 7 != 0 || v == last; });
+            }
+            else if(i % 32 == 31){
+
+                vector<fpBatchOp<string>> batch{{fpOp::insert, "new" + to_string(i)}};
+
+                if(fps.contains(obj, base))
+                    batch.push_back({fpOp::remove, obj});
+
+                fps.apply(batch, base);
+            }
+            else if(i % 16 == 15){
+
+                version_t other = 1 + (rand() % fps.curr_version());
+                fps.merge_union(base, (other % 7 == 0) ? base : other);
+            }
+            else if(fps.contains(obj, base))
+                fps.remove(obj, base);
+
+            else fps.insert(obj, base);
+
+            // an update that throws is not logged:
+            if(fps.size(fps.curr_version()) > 0){
+
+                string some = fps.to_vector(fps.curr_version()).front();
+                assert(fpSet_throws<ObjectAlreadyExist>([&]{ fps.insert(some); }));
+            }
+        }
+        assert(wal.durable_version() <= fps.curr_version());
+
+        wal.sync();
+        assert(wal.durable_version() == fps.curr_version());
+        fps.set_log(nullptr);
+    }
+
+    // the snapshot and the log:
+    fpSet<string, less<>, SLOTS> recovered = fpSet<string, less<>, SLOTS>::load(snapshot);
+    assert(fpSetLog<string>::replay(recovered, path) > 0);
+
+    // from the first version, without a snapshot:
+    fpSet<string, less<>, SLOTS> replayed;
+    fpSetLog<string>::replay(replayed, path);
+
+    assert(recovered.curr_version() == fps.curr_version());
+    assert(replayed.curr_version() == fps.curr_version());
+
+    for(version_t v = 1; v <= fps.curr_version(); ++v){
+
+        assert(recovered.size(v) == fps.size(v));
+        assert(replayed.size(v) == fps.size(v));
+
+        if(v % 7 != 0 || v == fps.curr_version()){
+
+            assert(recovered.to_vector(v) == fps.to_vector(v));
+            assert(replayed.to_vector(v) == fps.to_vector(v));
+        }
+    }
+    filesystem::remove(path);
+}
+
+
+/// @brief writes half of 13 and throws, like a codec that fails in the middle of an object.
+struct fpSet_unlucky_codec{
+
+    void write(ostream& out, int x){
+
+        out.put(static_cast<char>(x));
+
+        if(x == 13)
+            throw invalid_argument("fpSet_unlucky_codec: 13");
+
+        fpCodec<int32_t>::write(out, x);
+    }
+
+    int read(istream& in){
+
+        in.get();
+        return fpCodec<int32_t>::read(in);
+    }
+};
+
+
+/// @brief an object whose copy throws when it is negative, so an insert fails halfway.
+struct fpSet_fragile{
+
+    int x;
+
+    explicit fpSet_fragile(int x) : x(x){}
+
+    fpSet_fragile(const fpSet_fragile& other) : x(other.x){
+
+        if(x < 0)
+            throw invalid_argument("fpSet_fragile: negative");
+    }
+
+    bool operator<(const fpSet_fragile& other) const { return x < other.x; }
+};
+
+/// @brief records the logged versions, which the readers of 'fps' can not see yet.
+struct fpSet_recording_sink : fpLogSink<fpSet_fragile>{
+
+    const fpSet<fpSet_fragile>* fps;
+    vector<version_t> versions;
+    bool published = false;
+
+    explicit fpSet_recording_sink(const fpSet<fpSet_fragile>* fps) : fps(fps){}
+
+    void record(version_t version){
+
+        published = published || version <= fps->curr_version();
+        versions.push_back(version);
+    }
+
+    void log_update(fpOp, const fpSet_fragile&, version_t, version_t version) override { record(version); }
+    void log_apply(const vector<fpBatchOp<fpSet_fragile>>&, version_t, version_t version) override { record(version); }
+    void log_combine(fpLogOp, version_t, version_t, version_t version) override { record(version); }
+    void log_retire(const vector<version_t>&) override {}
+};
+
+
+void test_fpSet_log(){
+
+    fpSet_log_random<fpHashSlots>();
+    fpSet_log_random<fpFlatSlots<>>();
+    fpSet_log_random<fpConcurrentSlots<>>();
+
+    string path = (filesystem::temp_directory_path() / "test_fpSet_log.wal").string();
+    filesystem::remove(path);
+
+    fpSet<int> fps;
+    {
+        fpSetLog<int> wal(path, 4096);
+        fps.set_log(&wal);
+
+        for(int i = 0; i < 100; ++i)
+            fps.insert(i);
+
+        // the group is not full, nothing is durable yet:
+        assert(wal.durable_version() == 0);
+        assert(filesystem::file_size(path) == sizeof(log_magic));
+    }
+    // the destructor synced the group:
+    size_t whole = filesystem::file_size(path);
+    assert(whole > sizeof(log_magic));
+
+    // a torn record at the end is dropped, and cut from the file:
+    filesystem::resize_file(path, whole - 3);
+    {
+        fpSet<int> recovered;
+        assert(fpSetLog<int>::replay(recovered, path) == 99);
+        assert(recovered.curr_version() == 100 && recovered.to_vector() == fps.to_vector(100));
+        assert(filesystem::file_size(path) < whole - 3);
+
+        // the log goes on after the recovery:
+        fpSetLog<int> wal(path);
+        recovered.set_log(&wal);
+        recovered.insert(99);
+        recovered.remove(0, 1 + 1);
+        assert(wal.durable_version() == 102);
+    }
+    {
+        fpSet<int> replayed;
+        assert(fpSetLog<int>::replay(replayed, path) == 101);
+        assert(replayed.to_vector(101) == fps.to_vector(101) && replayed.to_vector(102).empty());
+    }
+
+    // a snapshot, then truncate:
+    stringstream snapshot;
+    {
+        fpSet<int> recovered;
+        fpSetLog<int>::replay(recovered, path);
+
+        fpSetLog<int> wal(path);
+        recovered.set_log(&wal);
+
+        recovered.save(snapshot);
+        wal.truncate();
+        assert(filesystem::file_size(path) == sizeof(log_magic));
+
+        recovered.insert(1000);
+    }
+    {
+        fpSet<int> recovered = fpSet<int>::load(snapshot);
+        assert(fpSetLog<int>::replay(recovered, path) == 1);
+        assert(recovered.curr_version() == 103 && recovered.contains(1000, 103));
+
+        // a log that starts after the set ends:
+        fpSet<int> empty;
+        assert(fpSet_throws<CorruptedSnapshot>([&]{ fpSetLog<int>::replay(empty, path); }));
+    }
+
+    // not a log, and a missing log:
+    {
+        ofstream garbage(path, ios::binary | ios::trunc);
+        garbage << "not an fpSet log";
+    }
+    assert(fpSet_throws<CorruptedSnapshot>([&]{ fpSetLog<int> wal(path); }));
+    assert(fpSet_throws<CorruptedSnapshot>([&]{ fpSetLog<int>::replay(fps, path); }));
+
+    filesystem::remove(path);
+    assert(fpSetLog<int>::replay(fps, path) == 0);
+
+    // a codec that throws leaves nothing of its record in the group, and the update is cancelled:
+    {
+        fpSet<int> unlucky;
+        fpSetLog<int, fpSet_unlucky_codec> wal(path, 4);
+        unlucky.set_log(&wal);
+
+        unlucky.insert(1);
+        assert(fpSet_throws<invalid_argument>([&]{ unlucky.insert(13); }));
+        unlucky.insert(2);
+        unlucky.insert(3);
+
+        wal.sync();
+        assert(wal.durable_version() == 4);
+    }
+    {
+        fpSet<int> replayed;
+        assert((fpSetLog<int, fpSet_unlucky_codec>::replay(replayed, path) == 3));
+        assert(replayed.curr_version() == 4 && replayed.to_vector(4) == vector<int>({1, 2, 3}));
+    }
+
+    // a corrupted record that is not the last one is not cut with the records after it:
+    whole = filesystem::file_size(path);
+    {
+        fstream file(path, ios::binary | ios::in | ios::out);
+        file.seekp(sizeof(log_magic) + sizeof(uint32_t) + 1);
+        file.put('\x7f');
+    }
+    {
+        fpSet<int> replayed;
+        assert((fpSet_throws<CorruptedSnapshot>([&]{ fpSetLog<int, fpSet_unlucky_codec>::replay(replayed, path); })));
+        assert(filesystem::file_size(path) == whole);
+    }
+    filesystem::remove(path);
+
+    // a write that fails after 5 bytes: the log writes nothing more, so the cancelled update never gets in:
+    size_t synced;
+    {
+        fpSet<int> failing;
+        fpSetLog<int> wal(path, 2);
+        failing.set_log(&wal);
+
+        failing.insert(1);
+        failing.insert(2);
+        synced = filesystem::file_size(path);
+
+        rlimit limit, small;
+        getrlimit(RLIMIT_FSIZE, &limit);
+        small = limit;
+        small.rlim_cur = synced + 5;
+
+        auto handler = signal(SIGXFSZ, SIG_IGN);
+        setrlimit(RLIMIT_FSIZE, &small);
+
+        failing.insert(3);
+        bool threw = fpSet_throws<system_error>([&]{ failing.insert(4); });
+
+        setrlimit(RLIMIT_FSIZE, &limit);
+        signal(SIGXFSZ, handler);
+
+        assert(threw && failing.curr_version() == 4 && wal.durable_version() == 3);
+        assert(fpSet_throws<system_error>([&]{ wal.sync(); }));
+        assert(fpSet_throws<system_error>([&]{ failing.insert(5); }));
+    }
+    assert(filesystem::file_size(path) == synced + 5);
+    {
+        fpSet<int> replayed;
+        assert(fpSetLog<int>::replay(replayed, path) == 2);
+        assert(replayed.curr_version() == 3 && filesystem::file_size(path) == synced);
+    }
+    filesystem::remove(path);
+
+    // a retire record with a valid checksum that counts more versions than its bytes:
+    {
+        stringstream payload;
+        payload.put(static_cast<char>(fpLogOp::retire));
+        fpVarint::write(payload, 0);
+        fpVarint::write(payload, uint64_t(1) << 60);
+        string bytes = payload.str();
+
+        ofstream file(path, ios::binary | ios::trunc);
+        fpCodec<uint64_t>::write(file, log_magic);
+        fpCodec<uint32_t>::write(file, bytes.size());
+        file.write(bytes.data(), bytes.size());
+        fpCodec<uint32_t>::write(file, fpChecksum::of(bytes.data(), bytes.size()));
+    }
+    {
+        fpSet<int> replayed;
+        assert(fpSet_throws<CorruptedSnapshot>([&]{ fpSetLog<int>::replay(replayed, path); }));
+    }
+    filesystem::remove(path);
+
+    // only an update that was built is logged, and before the readers can see it:
+    {
+        fpSet<fpSet_fragile> fragile;
+        fpSet_recording_sink sink(&fragile);
+        fragile.set_log(&sink);
+
+        fragile.insert(fpSet_fragile(1));
+        assert(fpSet_throws<invalid_argument>([&]{ fragile.insert(fpSet_fragile(-1)); }));
+        fragile.insert(fpSet_fragile(2));
+        fragile.remove(fpSet_fragile(1));
+        fragile.merge_union(2, 4);
+
+        assert(sink.versions == vector<version_t>({2, 3, 4, 5}) && !sink.published);
+        assert(fragile.curr_version() == 5 && fragile.size(5) == 2);
+    }
+
+    cout << "fpSet::test_fpSet_log " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+/// @brief orders the keys by their low 32 bits only, without branches.
+struct fpSet_low_less{
+
+    bool operator()(uint64_t a, uint64_t b) const {
+
+        return static_cast<uint32_t>(a) < static_cast<uint32_t>(b);
+    }
+};
+
+
+/// @brief orders the numbers by their remainder. It has a state and no default constructor.
+struct fpSet_mod_less{
+
+    int mod;
+
+    explicit fpSet_mod_less(int mod) : mod(mod) {}
+
+    bool operator()(int a, int b) const { return a % mod < b % mod; }
+};
+
+
+template <class SET, class KEY>
+concept fpSet_looks_up = requires(SET& set, const KEY& key){ set.contains(key); };
+
+
+template <class SLOTS>
+void fpSet_compare_random(){
+
+    srand(time(NULL));
+
+    // versions[v] is the expected content of version v
+    vector<set<int, greater<>>> versions(2);
+
+    fpSet<int, greater<>, SLOTS> fps;
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        version_t base = 1 + (rand() % fps.curr_version());
+        int obj = 2 * (rand() % (PDS_RAND_ARR_SIZE / 10));
+
+        set<int, greater<>> next = versions[base];
+
+        if(next.count(obj)){
+
+            fps.remove(obj, base);
+            next.erase(obj);
+        }
+        else{
+            fps.insert(obj, base);
+            next.insert(obj);
+        }
+        versions.push_back(next);
+    }
+
+    // the batches and the set operations keep the order of the set:
+    vector<fpBatchOp<int>> batch = {{fpOp::insert, -1}, {fpOp::insert, 1001}, {fpOp::insert, 501}};
+    assert(fps.apply(batch) == versions.size());
+    versions.push_back(versions.back());
+    versions.back().insert({-1, 1001, 501});
+
+    version_t a = 1 + (rand() % (versions.size() - 1)), b = 1 + (rand() % (versions.size() - 1));
+    set<int, greater<>> expected;
+    set_union(versions[a].begin(), versions[a].end(), versions[b].begin(), versions[b].end(), 
+        inserter(expected, expected.end()), greater<>());
+    assert(fps.merge_union(a, b) == versions.size());
+    versions.push_back(expected);
+
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        const set<int, greater<>>& exp = versions[v];
+
+        assert(fps.to_vector(v) == vector<int>(exp.begin(), exp.end()));
+        assert(vector<int>(fps.begin(v), fps.end(v)) == vector<int>(exp.begin(), exp.end()));
+
+        for(int obj = -2; obj <= PDS_RAND_ARR_SIZE / 5; obj += 3){
+
+            assert(fps.contains(obj, v) == (exp.count(obj) == 1));
+            assert(fps.rank(obj, v) == size_t(distance(exp.begin(), exp.lower_bound(obj))));
+
+            auto lower = fps.lower_bound(obj, v);
+            assert(lower == fps.end(v) ? exp.lower_bound(obj) == exp.end() : *lower == *exp.lower_bound(obj));
+        }
+        if(!exp.empty())
+            assert(fps.select(0, v) == *exp.begin());
+    }
+
+    fpDiff<int> changes = fps.diff(2, fps.curr_version());
+    assert(is_sorted(changes.inserted.begin(), changes.inserted.end(), greater<>()));
+}
+
+
+void test_fpSet_compare(){
+
+    fpSet_compare_random<fpHashSlots>();
+    fpSet_compare_random<fpFlatSlots<>>();
+    fpSet_compare_random<fpConcurrentSlots<>>();
+
+    // a transparent comparator finds a key of another type as it is, std::string has no implicit
+    // constructor from std::string_view, so no std::string is built for these lookups:
+    fpSet<string> names;
+    names.insert("grace");
+    names.insert("ada");
+    names.insert("linus", 2);
+
+    string_view request = "ada,grace,linus";
+
+    assert(names.contains(request.substr(0, 3), 3) && !names.contains(request.substr(0, 3), 4));
+    assert(names.contains(request.substr(4, 5), 2));
+    assert(names.contains(request.substr(10), 4) && !names.contains(request.substr(10), 3));
+    assert(names.contains_unchecked(request.substr(0, 3), 3));
+    assert(*names.lower_bound(string_view("b"), 4) == "grace");
+    assert(names.upper_bound(string_view("linus"), 4) == names.end(4));
+    assert(fpSet_throws<VersionNotExist>([&]{ names.contains(request, 5); }));
+
+    // the comparator decides the order and the equality, and a non-transparent one takes only OBJ:
+    fpSet<uint64_t, fpSet_low_less, fpFlatSlots<>> low;
+    low.insert(7);
+    low.insert((uint64_t(1) << 32) | 3);
+    low.insert(5);
+
+    assert(low.to_vector() == vector<uint64_t>({(uint64_t(1) << 32) | 3, 5, 7}));
+    assert(low.contains((uint64_t(2) << 32) | 7, 4));
+    assert(fpSet_throws<ObjectAlreadyExist>([&]{ low.insert((uint64_t(5) << 32) | 5); }));
+    static_assert(fpSet_looks_up<fpSet<string>, string_view>);
+    static_assert(!fpSet_looks_up<fpSet<uint64_t, fpSet_low_less, fpFlatSlots<>>, string_view>);
+
+    // from_sorted takes the objects in the order of the comparator:
+    vector<int> down = {9, 7, 4, 1};
+    fpSet<int, greater<>, fpHashSlots> sorted = fpSet<int, greater<>, fpHashSlots>::from_sorted(down.begin(), down.end());
+    assert(sorted.to_vector(2) == down);
+    assert(fpSet_throws<ObjectsNotSorted>([]{
+        vector<int> up = {1, 2};
+        fpSet<int, greater<>, fpHashSlots>::from_sorted(up.begin(), up.end());
+    }));
+
+    // an image of the set keeps its order:
+    stringstream frozen;
+    sorted.freeze(frozen);
+    string bytes = frozen.str();
+    vector<uint64_t> memory((bytes.size() + 7) / 8);
+    memcpy(memory.data(), bytes.data(), bytes.size());
+
+    fpSetImage<int, greater<>> image(memory.data(), bytes.size());
+    assert(image.to_vector(2) == down);
+    assert(image.contains(4, 2) && !image.contains(5, 2));
+
+    // the set keeps the comparator it was constructed with, and passes it to every query and update:
+    fpSet_mod_less by_digit(10);
+    fpSet<int, fpSet_mod_less, fpFlatSlots<>> digits(pmr::get_default_resource(), by_digit);
+    digits.insert(13);
+    digits.insert(21);
+    digits.insert(7);
+
+    assert(digits.to_vector(4) == vector<int>({21, 13, 7}));
+    assert(digits.contains(33, 4) && !digits.contains(5, 4) && digits.rank(9, 4) == 3);
+    assert(*digits.lower_bound(2, 4) == 13 && digits.upper_bound(17, 4) == digits.end(4));
+    assert(fpSet_throws<ObjectAlreadyExist>([&]{ digits.insert(11); }));
+
+    assert(digits.apply({{fpOp::insert, 45}, {fpOp::remove, 31}}, 4) == 5);
+    assert(digits.to_vector(5) == vector<int>({13, 45, 7}));
+    assert(digits.merge_union(3, 5) == 6 && digits.to_vector(6) == vector<int>({21, 13, 45, 7}));
+
+    fpDiff<int> digit_changes = digits.diff(4, 5);
+    assert(digit_changes.inserted == vector<int>({45}) && digit_changes.removed == vector<int>({21}));
+
+    digits.retain_only([](version_t v){ return v != 3; });
+    assert(digits.contains(45) && digits.to_vector(6) == vector<int>({21, 13, 45, 7}));
+
+    stringstream digits_snapshot;
+    digits.save(digits_snapshot);
+    auto loaded_digits = fpSet<int, fpSet_mod_less, fpFlatSlots<>>::load(digits_snapshot, fpCodec<int>{}, 
+        pmr::get_default_resource(), by_digit);
+    assert(loaded_digits.contains(35, 5) && loaded_digits.insert(98, 5) == 7);
+
+    vector<int> by_last = {20, 11, 2};
+    auto sorted_digits = fpSet<int, fpSet_mod_less, fpFlatSlots<>>::from_sorted(by_last.begin(), by_last.end(), 
+        pmr::get_default_resource(), by_digit);
+    assert(sorted_digits.contains(10) && sorted_digits.contains(32, 2) && !sorted_digits.contains(3));
+
+    stringstream digits_frozen;
+    sorted_digits.freeze(digits_frozen);
+    string digits_bytes = digits_frozen.str();
+    vector<uint64_t> digits_memory((digits_bytes.size() + 7) / 8);
+    memcpy(digits_memory.data(), digits_bytes.data(), digits_bytes.size());
+
+    fpSetImage<int, fpSet_mod_less> digits_image(digits_memory.data(), digits_bytes.size(), by_digit);
+    assert(digits_image.contains(41, 2) && !digits_image.contains(4, 2));
+
+    cout << "fpSet::test_fpSet_compare " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+/// @brief counts the bytes that are allocated and not yet deallocated, from the new-delete resource.
+struct fpSet_counting_resource : std::pmr::memory_resource{
+
+    size_t bytes = 0;
+    size_t allocations = 0;
+
+private:
+    void* do_allocate(size_t n, size_t align) override {
+
+        bytes += n;
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(n, align);
+    }
+
+    void do_deallocate(void* p, size_t n, size_t align) override {
+
+        bytes -= n;
+        std::pmr::new_delete_resource()->deallocate(p, n, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+
+        return this == &other;
+    }
+};
+
+
+template <class SLOTS>
+void fpSet_memory_resource_random(){
+
+    srand(time(NULL));
+
+    fpSet_counting_resource counting;
+
+    // nothing of the set may come from the default resource:
+    std::pmr::memory_resource* prev = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+    {
+        vector<set<int>> versions(2);
+        fpSet<string, less<>, SLOTS> fps(&counting);
+
+        for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+            version_t base = (i % 4 == 0) ? 1 + (rand() % fps.curr_version()) : fps.curr_version();
+            int obj = rand() % 64;
+            set<int> next = versions[base];
+
+            if(next.count(obj)){
+
+                fps.remove(to_string(obj), base);
+                next.erase(obj);
+            }
+            else{
+                fps.insert(to_string(obj), base);
+                next.insert(obj);
+            }
+            versions.push_back(next);
+        }
+        assert(counting.allocations > 0);
+
+        auto expected = [&](version_t v){
+
+            vector<string> objs;
+            for(int obj : versions[v])
+                objs.push_back(to_string(obj));
+
+            sort(objs.begin(), objs.end());
+            return objs;
+        };
+
+        // retired fat nodes and slots go back to the resource:
+        size_t before = counting.bytes;
+        version_t last = fps.curr_version();
+
+        fps.retain_only([&](version_t v){ return v == last; });
+        assert(counting.bytes < before);
+        assert(fps.to_vector(last) == expected(last));
+
+        // a set that is loaded or built from a range allocates from the resource it is given:
+        stringstream snapshot;
+        fps.save(snapshot);
+
+        size_t saved = counting.bytes;
+        {
+            fpSet<string, less<>, SLOTS> loaded = fpSet<string, less<>, SLOTS>::load(snapshot, fpCodec<string>{}, &counting);
+            assert(loaded.to_vector(last) == expected(last));
+            assert(counting.bytes > saved);
+
+            vector<string> objs = expected(last);
+            fpSet<string, less<>, SLOTS> sorted = fpSet<string, less<>, SLOTS>::from_sorted(objs.begin(), objs.end(), &counting);
+            assert(sorted.to_vector(2) == objs);
+
+            // a moved set keeps the memory of its resource:
+            fpSet<string, less<>, SLOTS> moved(std::move(sorted));
+            moved.insert("x");
+            assert(moved.to_vector(2) == objs);
+        }
+        assert(counting.bytes == saved);
+    }
+    std::pmr::set_default_resource(prev);
+
+    // every byte was returned:
+    assert(counting.bytes == 0);
+}
+
+
+void test_fpSet_memory_resource(){
+
+    fpSet_memory_resource_random<fpHashSlots>();
+    fpSet_memory_resource_random<fpFlatSlots<>>();
+    fpSet_memory_resource_random<fpConcurrentSlots<>>();
+
+    // a short-lived set in a fixed buffer, that never reaches the heap:
+    alignas(std::max_align_t) static byte buffer[1 << 20];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    {
+        fpSet<int, less<>, fpFlatSlots<>> fps(&arena);
+
+        for(int i = 0; i < 256; ++i)
+            fps.insert((i * 37) % 256);
+
+        version_t last = fps.remove(0);
+
+        vector<int> expected(255);
+        iota(expected.begin(), expected.end(), 1);
+
+        assert(fps.to_vector(last) == expected);
+        assert(fps.size(129) == 128);
+    }
+
+    cout << "fpSet::test_fpSet_memory_resource " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpSet_memory_stats_random(){
+
+    srand(time(NULL));
+
+    // the set allocates nothing but from its resource, so the stats must add up to what it holds:
+    fpSet_counting_resource counting;
+    fpSet<string, less<>, SLOTS> fps(&counting);
+
+    fpMemoryStats empty = fps.memory_stats();
+
+    assert(empty.versions == 1 && empty.nodes == 0 && empty.slots == 2);
+    assert(empty.total_bytes() == counting.bytes);
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        version_t base = (i % 4 == 0) ? 1 + (rand() % fps.curr_version()) : fps.curr_version();
+        string obj = to_string(rand() % 64);
+
+        if(fps.contains(obj, base))
+            fps.remove(obj, base);
+        else
+            fps.insert(obj, base);
+    }
+
+    fpMemoryStats stats = fps.memory_stats();
+
+    assert(stats.versions == fps.curr_version());
+    assert(stats.nodes >= fps.size() && stats.object_bytes == stats.nodes * sizeof(string));
+    assert(stats.slots > stats.versions);
+    assert(stats.total_bytes() == counting.bytes);
+    assert((stats.index_bytes > 0) == (is_same_v<SLOTS, fpHashSlots>));
+
+    // retired versions leave the stats with the memory they freed:
+    version_t last = fps.curr_version();
+    size_t retired = fps.retain_only([&](version_t v){ return v == 1 || v == last; });
+
+    fpMemoryStats left = fps.memory_stats();
+
+    assert(left.versions == stats.versions - retired);
+    assert(left.nodes <= stats.nodes && left.slots < stats.slots);
+    assert(left.total_bytes() == counting.bytes && left.total_bytes() < stats.total_bytes());
+
+    // the counters follow a loaded set, a moved one, and the one that is moved from:
+    stringstream snapshot;
+    fps.save(snapshot);
+
+    fpSet_counting_resource other;
+    fpSet<string, less<>, SLOTS> loaded = fpSet<string, less<>, SLOTS>::load(snapshot, fpCodec<string>{}, &other);
+    fpMemoryStats reloaded = loaded.memory_stats();
+
+    assert(reloaded.nodes == left.nodes && reloaded.slots == left.slots);
+    assert(reloaded.total_bytes() == other.bytes);
+
+    fpSet<string, less<>, SLOTS> moved(std::move(loaded));
+    assert(moved.memory_stats().total_bytes() == other.bytes && loaded.memory_stats().total_bytes() == 0);
+
+    fpSet<string, less<>, SLOTS> assigned(&other);
+    assigned.insert("x");
+
+    assigned = std::move(moved);
+    assert(assigned.memory_stats().slots == left.slots && assigned.memory_stats().total_bytes() == other.bytes);
+}
+
+
+void test_fpSet_memory_stats(){
+
+    fpSet_memory_stats_random<fpHashSlots>();
+    fpSet_memory_stats_random<fpFlatSlots<>>();
+    fpSet_memory_stats_random<fpConcurrentSlots<>>();
+
+    fpSet<int, less<>, fpFlatSlots<>> fps;
+    fps.insert(1);
+    fps.insert(2);
+    fps.remove(1);
+
+    // 1 and 2 are nodes, and the root maps Versions 0 to 4:
+    fpMemoryStats stats = fps.memory_stats();
+
+    assert(stats.versions == 4 && stats.nodes == 2);
+    assert(stats.object_bytes == 2 * sizeof(int));
+    assert(stats.slots >= 5 && stats.node_bytes > 0 && stats.index_bytes == 0);
+
+    // the counters are read while a writer updates the set:
+    fpSet_counting_resource counting;
+    fpSet<int, less<>, fpConcurrentSlots<>> shared(&counting);
+    atomic<bool> done = false;
+
+    thread reader([&]{
+
+        fpMemoryStats prev;
+
+        while(!done.load()){
+
+            fpMemoryStats now = shared.memory_stats();
+            assert(now.versions >= prev.versions && now.nodes >= prev.nodes && now.slots >= prev.slots);
+            prev = now;
+        }
+    });
+
+    for(int i = 0; i < PDS_RAND_ARR_SIZE; ++i)
+        shared.insert(i);
+
+    done = true;
+    reader.join();
+
+    assert(shared.memory_stats().total_bytes() == counting.bytes);
+
+    cout << "fpSet::test_fpSet_memory_stats " << PRINT_GREEN("PASSED") << endl;
+}
@@ -0,0 +1,201 @@
+#include "fpString.hpp"
+
+#include <random>
+#include <sstream>
+
+using namespace pds;
+using namespace std;
+
+#define PDS_RAND_ARR_SIZE 1000
+
+void test_fpString_basic();
+void test_fpString_write();
+void test_fpString_random();
+void test_fpString_exceptions();
+
+void test_fpString(){
+
+    try{
+        test_fpString_basic();
+        test_fpString_write();
+        test_fpString_random();
+        test_fpString_exceptions();
+    }
+    catch(const pdsExcept& e){
+
+        throw pdsExcept("test_fpString: pdsExcept: " + string(e.what()));
+    }
+    catch(const exception& e){
+
+        throw pdsExcept("test_fpString: std::Exception: " + string(e.what()));
+    }
+    cout << "ALL fpString tests " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+void test_fpString_basic(){
+
+    fpString<> doc;
+
+    assert(doc.curr_version() == 1 && doc.size() == 0 && doc.to_string() == "");
+
+    assert(doc.insert(0, "hello world") == 2);
+    assert(doc.erase(5, 6) == 3);
+    assert(doc.insert(5, ", rope", 2) == 4);
+    assert(doc.append("!", 3) == 5);
+    assert(doc.substr(7, 4, 4) == 6);
+    assert(doc.concat(6, 6) == 7);
+    assert(doc.erase(2, string::npos, 4) == 8);
+
+    assert(doc.to_string(2) == "hello world");
+    assert(doc.to_string(3) == "hello");
+    assert(doc.to_string(4) == "hello, rope world");
+    assert(doc.to_string(5) == "hello!");
+    assert(doc.to_string(6) == "rope");
+    assert(doc.to_string(7) == "roperope");
+    assert(doc.to_string() == "he");
+
+    assert(doc.at(0, 4) == 'h' && doc.at(7, 4) == 'r' && doc.at(16, 4) == 'd' && doc.at(5, 7) == 'o');
+    assert(as_const(doc).size(1) == 0 && doc.size(4) == 17 && doc.size(7) == 8);
+
+    // inserting nothing still makes a version, equal to its base:
+    assert(doc.insert(1, "", 2) == 9 && doc.to_string(9) == "hello world");
+
+    // cuts inside one chunk, at its ends and of nothing:
+    assert(doc.erase(3, 4, 2) == 10 && doc.substr(3, 4, 2) == 11 && doc.substr(0, 11, 2) == 12);
+    assert(doc.erase(0, 0, 2) == 13 && doc.substr(11, 0, 2) == 14 && doc.erase(0, 5, 2) == 15);
+    assert(doc.to_string(10) == "helorld" && doc.to_string(11) == "lo w" && doc.to_string(12) == "hello world");
+    assert(doc.to_string(13) == "hello world" && doc.size(14) == 0 && doc.to_string(15) == " world");
+    assert(doc.to_string(2) == "hello world" && doc.to_string(4) == "hello, rope world");
+
+    cout << "fpString::test_fpString_basic " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+void test_fpString_write(){
+
+    fpString<> doc;
+    string text;
+
+    for(int i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        string line = "line " + to_string(i) + "\n";
+        doc.insert(text.size() / 2, line);
+        text.insert(text.size() / 2, line);
+    }
+
+    ostringstream out;
+    doc.write(out);
+    assert(out.str() == text && doc.to_string() == text);
+
+    ostringstream first;
+    doc.write(first, 2);
+    assert(first.str() == "line 0\n");
+
+    cout << "fpString::test_fpString_write " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class SLOTS>
+void fpString_random(){
+
+    mt19937 gen(random_device{}());
+
+    fpString<SLOTS> doc;
+    vector<string> versions = {"", ""};     // Version 0 is not used.
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE * 2; ++i){
+
+        version_t base = (i % 4 == 0) ? 1 + gen() % doc.curr_version() : doc.curr_version();
+        string next = versions[base];
+        size_t pos = gen() % (next.size() + 1);
+        size_t count = gen() % 16;
+
+        switch(gen() % 6){
+
+            case 0:{
+                version_t other = 1 + gen() % doc.curr_version();
+
+                if(next.size() + versions[other].size() > 64 * PDS_RAND_ARR_SIZE)
+                    break;
+
+                assert(doc.concat(base, other) == versions.size());
+                versions.push_back(next + versions[other]);
+                continue;
+            }
+            case 1:
+                assert(doc.substr(pos, count * 8, base) == versions.size());
+                versions.push_back(next.substr(pos, count * 8));
+                continue;
+
+            case 2:
+            case 3:
+                assert(doc.erase(pos, count, base) == versions.size());
+                versions.push_back(next.erase(pos, count));
+                continue;
+        }
+        string text(count, 'a' + gen() % 26);
+
+        assert(doc.insert(pos, text, base) == versions.size());
+        versions.push_back(next.insert(pos, text));
+    }
+
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        assert(doc.size(v) == versions[v].size() && doc.to_string(v) == versions[v]);
+
+        for(size_t pos = 0; pos < versions[v].size(); pos += 97)
+            assert(doc.at(pos, v) == versions[v][pos]);
+    }
+}
+
+
+void test_fpString_random(){
+
+    fpString_random<fpHashSlots>();
+    fpString_random<fpFlatSlots<>>();
+    fpString_random<fpConcurrentSlots<>>();
+
+    cout << "fpString::test_fpString_random " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+template <class EXCEPT, class FUNC>
+bool fpString_throws(FUNC&& func){
+
+    try{
+        func();
+    }
+    catch(const EXCEPT&){
+        return true;
+    }
+    return false;
+}
+
+
+void test_fpString_exceptions(){
+
+    fpString<> doc;
+    doc.insert(0, "abc");
+
+    ostringstream out;
+
+    assert(fpString_throws<VersionZeroIllegal>([&]{ doc.insert(0, "x", MasterVersion); }));
+    assert(fpString_throws<VersionZeroIllegal>([&]{ doc.write(out, MasterVersion); }));
+    assert(fpString_throws<VersionNotExist>([&]{ doc.erase(0, 1, 3); }));
+    assert(fpString_throws<VersionNotExist>([&]{ doc.concat(2, 3); }));
+    assert(fpString_throws<IndexOutOfRange>([&]{ doc.insert(4, "x"); }));
+    assert(fpString_throws<IndexOutOfRange>([&]{ doc.erase(4, 1); }));
+    assert(fpString_throws<IndexOutOfRange>([&]{ doc.substr(1, 1, 1); }));
+    assert(fpString_throws<IndexOutOfRange>([&]{ doc.at(3); }));
+    assert(fpString_throws<IndexOutOfRange>([&]{ doc.at(SIZE_MAX); }));
+
+    // a failed update creates no version:
+    assert(doc.curr_version() == 2 && doc.size(MasterVersion) == 0 && doc.size(3) == 0 && out.str().empty());
+
+    // a moved string keeps its versions:
+    fpString<> moved = std::move(doc);
+    assert(moved.to_string() == "abc" && moved.append("d") == 3 && moved.size(2) == 3);
+
+    cout << "fpString::test_fpString_exceptions " << PRINT_GREEN("PASSED") << endl;
+}
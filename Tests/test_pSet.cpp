@@ -1,5 +1,9 @@
 #include "pSet.hpp"
 
+#include <memory_resource>
+#include <set>
+#include <string_view>
+
 using namespace pds;
 using namespace std;
 
@@ -18,6 +22,9 @@ void test_pSet_exceptions();
 void test_pSet_edge_case_1();
 void test_pSet_edge_case_2();
 void test_pSet_print();
+void test_pSet_node_splitting();
+void test_pSet_compare();
+void test_pSet_memory_resource();
 
 void test_pSet(){
 
@@ -32,6 +39,9 @@ void test_pSet(){
         test_pSet_edge_case_1();
         test_pSet_edge_case_2();
         test_pSet_print();
+        test_pSet_node_splitting();
+        test_pSet_compare();
+        test_pSet_memory_resource();
     }
     catch(const pdsExcept& e){
 
@@ -279,6 +289,7 @@ void test_pSet_contains(){
 
                 // if (vobj <= vtest) then version 'vtest' should contain the obj 'vobj'
                 assert(ps.contains(objs[vobj], vtest) == (vobj <= vtest));
+                assert(ps.contains_unchecked(objs[vobj], vtest) == (vobj <= vtest));
             }
         }
         assert(ps.contains(objs[v]) == true);
@@ -530,3 +541,148 @@ void test_pSet_print(){
         ps.print(objs.size() + i + 2);
     }
 }
+
+
+void test_pSet_node_splitting(){
+
+    srand(time(NULL));
+
+    // a few objects, so every node is written by many more versions than its capacity:
+    const int objs = 16;
+    vector<set<int>> versions(2);
+
+    pSet<string> ps;
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE * 2; ++i){
+
+        int obj = rand() % objs;
+        set<int> next = versions.back();
+
+        if(next.count(obj)){
+
+            assert(ps.remove(to_string(obj)) == versions.size());
+            next.erase(obj);
+        }
+        else{
+            assert(ps.insert(to_string(obj)) == versions.size());
+            next.insert(obj);
+        }
+        versions.push_back(next);
+    }
+
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        assert(ps.size(v) == versions[v].size());
+
+        for(int obj = 0; obj < objs; ++obj){
+
+            assert(ps.contains(to_string(obj), v) == (versions[v].count(obj) == 1));
+        }
+    }
+
+    cout << "pSet::test_pSet_node_splitting " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+void test_pSet_compare(){
+
+    srand(time(NULL));
+
+    vector<set<int, greater<>>> versions(2);
+
+    pSet<int, greater<>> ps;
+
+    for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+        int obj = rand() % PDS_CONTAINS_SIZE;
+        set<int, greater<>> next = versions.back();
+
+        if(next.count(obj)){
+
+            assert(ps.remove(obj) == versions.size());
+            next.erase(obj);
+        }
+        else{
+            assert(ps.insert(obj) == versions.size());
+            next.insert(obj);
+        }
+        versions.push_back(next);
+    }
+
+    for(version_t v = 1; v < versions.size(); ++v){
+
+        assert(ps.to_vector(v) == vector<int>(versions[v].begin(), versions[v].end()));
+
+        int obj = rand() % PDS_CONTAINS_SIZE;
+        assert(ps.contains(obj, v) == (versions[v].count(obj) == 1));
+    }
+
+    // a transparent comparator looks up a std::string_view without building a std::string:
+    pSet<string> names;
+    names.insert("ada");
+    names.insert("grace");
+    names.remove("ada");
+
+    string_view request = "ada,grace";
+
+    assert(names.contains(request.substr(0, 3), 2) && !names.contains(request.substr(0, 3), 4));
+    assert(names.contains_unchecked(request.substr(4), 4));
+
+    try{
+        names.contains(request, 5);
+        assert(false);
+    }
+    catch(const VersionNotExist&){}
+
+    // a comparator with a state is kept by the set, here the numbers are equal by their last digit:
+    auto by_digit = [mod = 10](int a, int b){ return a % mod < b % mod; };
+    pSet<int, decltype(by_digit)> digits(pmr::get_default_resource(), by_digit);
+    digits.insert(13);
+    digits.insert(21);
+    digits.remove(31);
+
+    assert(digits.to_vector(3) == vector<int>({21, 13}) && digits.to_vector(4) == vector<int>({13}));
+    assert(digits.contains(43, 4) && !digits.contains(1, 4));
+
+    cout << "pSet::test_pSet_compare " << PRINT_GREEN("PASSED") << endl;
+}
+
+
+void test_pSet_memory_resource(){
+
+    srand(time(NULL));
+
+    std::pmr::monotonic_buffer_resource pool;
+
+    // the nodes, their fat pointers and the sizes are all allocated from the pool:
+    std::pmr::memory_resource* prev = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+    {
+        vector<set<int>> versions(2);
+        pSet<int> ps(&pool);
+
+        for(size_t i = 0; i < PDS_RAND_ARR_SIZE; ++i){
+
+            int obj = rand() % PDS_CONTAINS_SIZE;
+            set<int> next = versions.back();
+
+            if(next.count(obj)){
+
+                ps.remove(obj);
+                next.erase(obj);
+            }
+            else{
+                ps.insert(obj);
+                next.insert(obj);
+            }
+            versions.push_back(next);
+        }
+
+        for(version_t v = 1; v < versions.size(); ++v){
+
+            assert(ps.to_vector(v) == vector<int>(versions[v].begin(), versions[v].end()));
+        }
+    }
+    std::pmr::set_default_resource(prev);
+
+    cout << "pSet::test_pSet_memory_resource " << PRINT_GREEN("PASSED") << endl;
+}
@@ -0,0 +1,318 @@
+/**
+ * @file fpHashSet.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief fully persistent hash set container.
+ * @version 0.1
+ * @date 2025-02-24
+ */
+
+#ifndef FULLY_PERSISTENT_HASH_SET_HPP
+#define FULLY_PERSISTENT_HASH_SET_HPP
+
+#include "fpSet.hpp"
+#include "internal/fpHashTrie.hpp"
+
+#include <deque>
+#include <unordered_map>
+
+namespace pds{
+
+    /**
+     * @class fpHashSet
+     * @brief Fully persistent set of unordered objects: every insert and remove creates a new version,
+     *  and every version stays readable and updatable.
+     *
+     * @details A version is a hash array mapped trie (see @ref pds::fpHashTrie) of the hashes of its objects,
+     *  and the fat pointer of the roots maps every version to its trie, like the root of @ref pds::fpSet.
+     *  A lookup follows O(log32(K)) branches by the bits of the hash, and compares one object,
+     *  so it needs no order and it is near constant for any practical K.
+     *
+     *  Like the master tree of fpSet, the master table keeps every object that was ever inserted,
+     *  once: an object that is inserted again (to any version) is not copied, and all the versions
+     *  that hold it point to the same leaf.
+     *
+     * @tparam OBJ the object type, which must support `operator==`.
+     * @tparam HASH the hash of the objects.
+     * @tparam SLOTS the storage engine of the roots, see @ref pds::fpSet.
+     *
+     * @note The versions are numbered like the versions of fpSet: Version 1 is empty
+     *  and every update returns the next version. MasterVersion is not a version of a hash set.
+     *
+     * @example
+     * ```
+     * pds::fpHashSet<std::string> ids;
+     * ids.insert("3f2a");                  // Version 2
+     * ids.insert("9c41");                  // Version 3
+     * ids.remove("3f2a", 3);               // Version 4
+     * ids.contains("3f2a", 3);             // true
+     * ```
+     */
+    template <class OBJ, class HASH = std::hash<OBJ>, class SLOTS = pds::fpHashSlots>
+    class fpHashSet{
+
+        using Leaf = pds::fpHashLeaf<OBJ>;
+        using Branch = pds::fpHashBranch;
+
+        /// @brief the trie of a version, and its number of objects.
+        struct Root{
+            const Branch* branch = nullptr;
+            std::size_t size = 0;
+        };
+
+        pds::fpHashTrie<OBJ> trie;                              ///< owns all the branches.
+        pds::fpSlotTable<Root, SLOTS> roots;                    ///< the root of every version.
+        std::deque<Leaf> leaves;                                ///< every object, once.
+        std::unordered_multimap<std::size_t, const Leaf*> master;    ///< the leaves by their hash.
+        pds::version_t last_version;
+        [[no_unique_address]] HASH hasher;
+
+        /// @brief 'version', or the last version for default_version. throws if it not exists.
+        pds::version_t check_version(const char* func_name, pds::version_t version) const;
+
+        /// @brief the root of 'version', which must exist.
+        const Root& root_of(pds::version_t version);
+
+        /// @brief the leaf of 'obj' in the master table. a new leaf if it was never inserted.
+        template <typename T>
+        const Leaf* master_leaf(T&& obj, std::size_t hash);
+
+        /// @brief the root of a new version.
+        pds::version_t publish(const Branch* branch, std::size_t size);
+
+        template <typename T>
+        pds::version_t insert_impl(T&& obj, pds::version_t version);
+
+    public:
+        /// @brief Version 1, the empty set.
+        fpHashSet(HASH hasher = HASH());
+
+        /// @brief The versions share their branches and leaves, so a hash set can be moved but not copied.
+        fpHashSet(const fpHashSet&) = delete;
+        fpHashSet& operator=(const fpHashSet&) = delete;
+        fpHashSet(fpHashSet&&) = default;
+        fpHashSet& operator=(fpHashSet&&) = default;
+
+
+        /**
+         * @brief Inserts 'obj' in a new version, based on 'version'.
+         *
+         * @param obj the object. Copied (or moved) into the master table, only if it was never inserted.
+         * @param version the version to update. if 'version'=default_version update the last version.
+         *
+         * @exception
+         * - pds::ObjectAlreadyExist
+         *      thrown if: 'obj' is in 'version'
+         *
+         * - pds::VersionZeroIllegal
+         *      thrown if: version is 0
+         *
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()'
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log32(K)) expected, while K is size(version).
+         */
+        pds::version_t insert(const OBJ& obj, pds::version_t version = default_version);
+        pds::version_t insert(OBJ&& obj, pds::version_t version = default_version);
+
+
+        /**
+         * @brief Removes 'obj' in a new version, based on 'version'.
+         *
+         * @exception
+         * - pds::ObjectNotExist
+         *      thrown if: 'obj' is not in 'version'
+         *
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref insert.
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log32(K)) expected.
+         */
+        pds::version_t remove(const OBJ& obj, pds::version_t version = default_version);
+
+
+        /**
+         * @brief true if 'obj' is in 'version'.
+         *
+         * @exception
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref insert.
+         *
+         * @note Time complexity: O(log32(K)) expected, with one hash and one compare of objects.
+         */
+        bool contains(const OBJ& obj, pds::version_t version = default_version);
+
+
+        /// @brief the objects of 'version', in no particular order. throws like @ref contains.
+        std::vector<OBJ> to_vector(pds::version_t version = default_version);
+
+
+        /// @brief number of objects in 'version', or 0 if it not exists.
+        std::size_t size(pds::version_t version = default_version) const noexcept;
+
+
+        /// @brief the last version.
+        pds::version_t curr_version() const noexcept;
+    };
+};
+
+
+template <class OBJ, class HASH, class SLOTS>
+pds::fpHashSet<OBJ, HASH, SLOTS>::fpHashSet(HASH hasher) : last_version(1), hasher(std::move(hasher)) {
+
+    roots.slot(1) = {};
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+pds::version_t pds::fpHashSet<OBJ, HASH, SLOTS>::check_version(const char* func_name, pds::version_t version) const {
+
+    if(version == default_version)
+        return last_version;
+
+    if(version == MasterVersion)
+        throw pds::VersionZeroIllegal(std::string(func_name) + ": Version 0 is not a version of a hash set");
+
+    if(version > last_version)
+        throw pds::VersionNotExist(
+            std::string(func_name) + ": Version " + std::to_string(version) + " is not exist"
+        );
+
+    return version;
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+const typename pds::fpHashSet<OBJ, HASH, SLOTS>::Root& pds::fpHashSet<OBJ, HASH, SLOTS>::root_of(pds::version_t version){
+
+    pds::version_t slot;
+    return *roots.resolve(version, slot);
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+template <typename T>
+const pds::fpHashLeaf<OBJ>* pds::fpHashSet<OBJ, HASH, SLOTS>::master_leaf(T&& obj, std::size_t hash){
+
+    auto [first, last] = master.equal_range(hash);
+
+    for(auto it = first; it != last; ++it){
+
+        if(it->second->obj == obj)
+            return it->second;
+    }
+
+    const Leaf* leaf = &leaves.emplace_back(Leaf{std::forward<T>(obj), hash});
+    master.emplace(hash, leaf);
+    return leaf;
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+pds::version_t pds::fpHashSet<OBJ, HASH, SLOTS>::publish(const Branch* branch, std::size_t size){
+
+    roots.slot(last_version + 1) = Root{branch, size};
+
+    return ++last_version;
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+pds::version_t pds::fpHashSet<OBJ, HASH, SLOTS>::insert(const OBJ& obj, pds::version_t version){
+
+    return insert_impl(obj, version);
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+pds::version_t pds::fpHashSet<OBJ, HASH, SLOTS>::insert(OBJ&& obj, pds::version_t version){
+
+    return insert_impl(std::move(obj), version);
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+template <typename T>
+pds::version_t pds::fpHashSet<OBJ, HASH, SLOTS>::insert_impl(T&& obj, pds::version_t version){
+
+    version = check_version("fpHashSet::insert", version);
+
+    const Root& root = root_of(version);
+    std::size_t hash = pds::fpHashTrie<OBJ>::mix(hasher(obj));
+
+    if(pds::fpHashTrie<OBJ>::find(root.branch, obj, hash) != nullptr)
+        throw pds::ObjectAlreadyExist(
+            "fpHashSet::insert: Version " + std::to_string(version) + " already contains this object"
+        );
+
+    return publish(trie.insert(root.branch, master_leaf(std::forward<T>(obj), hash)), root.size + 1);
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+pds::version_t pds::fpHashSet<OBJ, HASH, SLOTS>::remove(const OBJ& obj, pds::version_t version){
+
+    version = check_version("fpHashSet::remove", version);
+
+    const Root& root = root_of(version);
+    const Leaf* leaf = pds::fpHashTrie<OBJ>::find(root.branch, obj, pds::fpHashTrie<OBJ>::mix(hasher(obj)));
+
+    if(leaf == nullptr)
+        throw pds::ObjectNotExist(
+            "fpHashSet::remove: Version " + std::to_string(version) + " has no such object"
+        );
+
+    return publish(trie.remove(root.branch, leaf), root.size - 1);
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+bool pds::fpHashSet<OBJ, HASH, SLOTS>::contains(const OBJ& obj, pds::version_t version){
+
+    version = check_version("fpHashSet::contains", version);
+
+    return pds::fpHashTrie<OBJ>::find(root_of(version).branch, obj, pds::fpHashTrie<OBJ>::mix(hasher(obj))) != nullptr;
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+std::vector<OBJ> pds::fpHashSet<OBJ, HASH, SLOTS>::to_vector(pds::version_t version){
+
+    version = check_version("fpHashSet::to_vector", version);
+
+    const Root& root = root_of(version);
+
+    std::vector<OBJ> objs;
+    objs.reserve(root.size);
+
+    pds::fpHashTrie<OBJ>::for_each(root.branch, [&objs](const OBJ& obj){ objs.push_back(obj); });
+
+    return objs;
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+std::size_t pds::fpHashSet<OBJ, HASH, SLOTS>::size(pds::version_t version) const noexcept {
+
+    if(version == default_version)
+        version = last_version;
+
+    pds::version_t slot;
+    const Root* root = (version == MasterVersion) ? nullptr : roots.resolve(version, slot);
+
+    return root == nullptr ? 0 : root->size;
+}
+
+
+template <class OBJ, class HASH, class SLOTS>
+pds::version_t pds::fpHashSet<OBJ, HASH, SLOTS>::curr_version() const noexcept {
+
+    return last_version;
+}
+
+
+#endif /* FULLY_PERSISTENT_HASH_SET_HPP */
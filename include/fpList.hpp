@@ -0,0 +1,390 @@
+/**
+ * @file fpList.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief fully persistent sequence container, indexed by position.
+ * @version 0.1
+ * @date 2025-02-03
+ */
+
+#ifndef FULLY_PERSISTENT_LIST_HPP
+#define FULLY_PERSISTENT_LIST_HPP
+
+#include "fpSet.hpp"
+
+namespace pds{
+
+    /**
+     * @class fpList
+     * @brief Fully persistent sequence: every insert_at, erase_at, split and concat creates a new version,
+     *  and every version stays readable and updatable.
+     *
+     * @details The versions are treaps of fat nodes like the versions of @ref pds::fpSet,
+     *  but a node is ordered by its position only: the slots keep the size of every subtree,
+     *  so the position of a node is found on the way down, and inserting or erasing at a position
+     *  is a split and a join by sizes. Every operation writes O(log(K)) slots of the new version
+     *  in expectation and shares everything else with the version it is based on.
+     *
+     *  A version may hold the same subtree more than once (e.g. concat(v, v)):
+     *  a shared subtree is only read, and a node that the new version changes in two places
+     *  is copied for the second one.
+     *
+     * @tparam OBJ the object type. Must be copy constructible. No order is needed.
+     * @tparam SLOTS the storage engine of the version slots, see @ref pds::fpSet.
+     *
+     * @note The versions are numbered like the versions of fpSet: Version 1 is empty
+     *  and every update returns the next version. MasterVersion is not a version of a list.
+     *
+     * @example
+     * ```
+     * pds::fpList<char> text;
+     * text.push_back('a');                 // Version 2: "a"
+     * text.insert_at(0, 'b');              // Version 3: "ba"
+     * text.concat(3, 2);                   // Version 4: "baa"
+     * text.at(1, 4);                       // 'a'
+     * ```
+     */
+    template <class OBJ, class SLOTS = pds::fpHashSlots>
+    class fpList{
+
+        using View = typename pds::fpTreap<OBJ, SLOTS>::View;
+
+        pds::fpFatNodeArena<OBJ, SLOTS> arena;  ///< owns all the fat nodes.
+        pds::fpFatNodePtr<OBJ, SLOTS> root;     ///< the root of every version.
+        pds::version_t last_version;
+        std::uint64_t nodes_made = 0;           ///< the sequence of the priority of the next node.
+
+        /// @brief 'version', or the last version for default_version. throws if it not exists.
+        pds::version_t check_version(const char* func_name, pds::version_t version) const;
+
+        /// @brief throws pds::IndexOutOfRange if 'index' is bigger than 'bound'.
+        static void check_index(const char* func_name, std::size_t index, std::size_t bound);
+
+        /// @brief throws pds::IndexOutOfRange if 'index' is not smaller than 'size', so there is no object at it.
+        static void check_element(const char* func_name, std::size_t index, std::size_t size);
+
+    public:
+        using iterator = pds::fpSetIterator<OBJ, SLOTS>;
+        using const_iterator = iterator;
+
+        /// @brief Version 1, the empty list.
+        fpList();
+
+        /// @brief The fat nodes point to each other inside the arena, so a list can be moved but not copied.
+        fpList(const fpList&) = delete;
+        fpList& operator=(const fpList&) = delete;
+        fpList(fpList&&) = default;
+        fpList& operator=(fpList&&) = default;
+
+
+        /**
+         * @brief Inserts 'obj' before position 'index' in a new version, based on 'version'.
+         *
+         * @param index the position of the new object, in [0, size(version)].
+         * @param obj the object. Taken by value: it is moved into the list.
+         * @param version the version to update. if 'version'=default_version update the last version.
+         *
+         * @exception
+         * - pds::IndexOutOfRange
+         *      thrown if: 'index' is bigger than size(version)
+         *
+         * - pds::VersionZeroIllegal
+         *      thrown if: version is 0
+         *
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()'
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log(K)) expected, while K is size(version).
+         */
+        pds::version_t insert_at(std::size_t index, OBJ obj, pds::version_t version = default_version);
+
+
+        /// @brief insert_at(size(version), obj, version).
+        pds::version_t push_back(OBJ obj, pds::version_t version = default_version);
+
+
+        /**
+         * @brief Removes the object at 'index' in a new version, based on 'version'.
+         *
+         * @exception
+         * - pds::IndexOutOfRange
+         *      thrown if: 'index' is not smaller than size(version)
+         *
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref insert_at.
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log(K)) expected.
+         */
+        pds::version_t erase_at(std::size_t index, pds::version_t version = default_version);
+
+
+        /**
+         * @brief The object at 'index' in 'version'.
+         *
+         * @exception
+         * - pds::IndexOutOfRange
+         *      thrown if: 'index' is not smaller than size(version)
+         *
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref insert_at.
+         *
+         * @return a reference to the object, that is valid while the list lives.
+         *
+         * @note Time complexity: O(log(K)) expected.
+         */
+        const OBJ& at(std::size_t index, pds::version_t version = default_version);
+
+
+        /**
+         * @brief Splits 'version' at 'index' into two new versions.
+         *
+         * @param index the size of the first part, in [0, size(version)].
+         *
+         * @exception
+         * - pds::IndexOutOfRange
+         *      thrown if: 'index' is bigger than size(version)
+         *
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref insert_at.
+         *
+         * @return the version of the first 'index' objects, and the next version with the rest.
+         *
+         * @note Time complexity: O(log(K)) expected.
+         */
+        std::pair<pds::version_t, pds::version_t> split(std::size_t index, pds::version_t version = default_version);
+
+
+        /**
+         * @brief Creates a new version with the objects of 'v1' followed by the objects of 'v2'.
+         *
+         * @details 'v1' and 'v2' may be the same version, or share subtrees.
+         *
+         * @exception
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref insert_at.
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log(K1 + K2)) expected.
+         */
+        pds::version_t concat(pds::version_t v1, pds::version_t v2);
+
+
+        /// @brief the objects of 'version', in order. throws like @ref at.
+        std::vector<OBJ> to_vector(pds::version_t version = default_version);
+
+
+        /// @brief iterators over the objects of 'version', in order.
+        iterator begin(pds::version_t version = default_version);
+        iterator end(pds::version_t version = default_version);
+
+
+        /// @brief number of objects in 'version', or 0 if it not exists.
+        std::size_t size(pds::version_t version = default_version) const noexcept;
+
+
+        /// @brief the last version.
+        pds::version_t curr_version() const noexcept;
+    };
+};
+
+
+template <class OBJ, class SLOTS>
+pds::fpList<OBJ, SLOTS>::fpList() : root(1), last_version(1) {
+}
+
+
+template <class OBJ, class SLOTS>
+pds::version_t pds::fpList<OBJ, SLOTS>::check_version(const char* func_name, pds::version_t version) const {
+
+    if(version == default_version)
+        return last_version;
+
+    if(version == MasterVersion)
+        throw pds::VersionZeroIllegal(std::string(func_name) + ": Version 0 is not a version of a list");
+
+    if(version > last_version)
+        throw pds::VersionNotExist(
+            std::string(func_name) + ": Version " + std::to_string(version) + " is not exist"
+        );
+
+    return version;
+}
+
+
+template <class OBJ, class SLOTS>
+void pds::fpList<OBJ, SLOTS>::check_index(const char* func_name, std::size_t index, std::size_t bound){
+
+    if(index > bound)
+        throw pds::IndexOutOfRange(
+            std::string(func_name) + ": Index " + std::to_string(index) + " is out of range"
+        );
+}
+
+
+template <class OBJ, class SLOTS>
+void pds::fpList<OBJ, SLOTS>::check_element(const char* func_name, std::size_t index, std::size_t size){
+
+    // Not 'index + 1 > size', which wraps around for the last index:
+    if(index >= size)
+        throw pds::IndexOutOfRange(
+            std::string(func_name) + ": Index " + std::to_string(index) + " is out of range"
+        );
+}
+
+
+template <class OBJ, class SLOTS>
+pds::version_t pds::fpList<OBJ, SLOTS>::insert_at(std::size_t index, OBJ obj, pds::version_t version){
+
+    version = check_version("fpList::insert_at", version);
+
+    View t = pds::fpTreap<OBJ, SLOTS>::at(root, version);
+    check_index("fpList::insert_at", index, t.size);
+
+    pds::version_t new_version = last_version + 1;
+
+    pds::fpFatNode<OBJ, SLOTS>* node = arena.make(
+        std::move(obj), new_version, pds::fpTreap<OBJ, SLOTS>::priority(nodes_made++)
+    );
+
+    pds::fpTreap<OBJ, SLOTS> treap(arena, new_version);
+    auto [l, r] = treap.split_at(t, index);
+
+    treap.set_root(root, treap.join(treap.join(l, treap.link(node, View{}, View{})), r));
+
+    return (last_version = new_version);
+}
+
+
+template <class OBJ, class SLOTS>
+pds::version_t pds::fpList<OBJ, SLOTS>::push_back(OBJ obj, pds::version_t version){
+
+    version = check_version("fpList::push_back", version);
+
+    return insert_at(size(version), std::move(obj), version);
+}
+
+
+template <class OBJ, class SLOTS>
+pds::version_t pds::fpList<OBJ, SLOTS>::erase_at(std::size_t index, pds::version_t version){
+
+    version = check_version("fpList::erase_at", version);
+
+    View t = pds::fpTreap<OBJ, SLOTS>::at(root, version);
+    check_element("fpList::erase_at", index, t.size);
+
+    pds::version_t new_version = last_version + 1;
+
+    pds::fpTreap<OBJ, SLOTS> treap(arena, new_version);
+    auto [l, rest] = treap.split_at(t, index);
+    auto [erased, r] = treap.split_at(rest, 1);
+
+    treap.set_root(root, treap.join(l, r));
+
+    return (last_version = new_version);
+}
+
+
+template <class OBJ, class SLOTS>
+const OBJ& pds::fpList<OBJ, SLOTS>::at(std::size_t index, pds::version_t version){
+
+    version = check_version("fpList::at", version);
+
+    View t = pds::fpTreap<OBJ, SLOTS>::at(root, version);
+    check_element("fpList::at", index, t.size);
+
+    return pds::fpTreap<OBJ, SLOTS>::nth(t, index).node->get_obj();
+}
+
+
+template <class OBJ, class SLOTS>
+std::pair<pds::version_t, pds::version_t> pds::fpList<OBJ, SLOTS>::split(std::size_t index, pds::version_t version){
+
+    version = check_version("fpList::split", version);
+
+    View t = pds::fpTreap<OBJ, SLOTS>::at(root, version);
+    check_index("fpList::split", index, t.size);
+
+    // Every part is a version of its own, so the split is done once for each of them.
+    pds::fpTreap<OBJ, SLOTS> first(arena, last_version + 1);
+    first.set_root(root, first.split_at(t, index).first);
+    ++last_version;
+
+    pds::fpTreap<OBJ, SLOTS> second(arena, last_version + 1);
+    second.set_root(root, second.split_at(t, index).second);
+    ++last_version;
+
+    return {last_version - 1, last_version};
+}
+
+
+template <class OBJ, class SLOTS>
+pds::version_t pds::fpList<OBJ, SLOTS>::concat(pds::version_t v1, pds::version_t v2){
+
+    v1 = check_version("fpList::concat", v1);
+    v2 = check_version("fpList::concat", v2);
+
+    pds::version_t new_version = last_version + 1;
+
+    pds::fpTreap<OBJ, SLOTS> treap(arena, new_version);
+    treap.set_root(root, treap.join(pds::fpTreap<OBJ, SLOTS>::at(root, v1), pds::fpTreap<OBJ, SLOTS>::at(root, v2)));
+
+    return (last_version = new_version);
+}
+
+
+template <class OBJ, class SLOTS>
+std::vector<OBJ> pds::fpList<OBJ, SLOTS>::to_vector(pds::version_t version){
+
+    version = check_version("fpList::to_vector", version);
+
+    std::vector<OBJ> objs;
+    objs.reserve(size(version));
+
+    for(iterator it = iterator::first(root, version); it != iterator(root, version); ++it){
+
+        objs.push_back(*it);
+    }
+    return objs;
+}
+
+
+template <class OBJ, class SLOTS>
+typename pds::fpList<OBJ, SLOTS>::iterator pds::fpList<OBJ, SLOTS>::begin(pds::version_t version){
+
+    return iterator::first(root, check_version("fpList::begin", version));
+}
+
+
+template <class OBJ, class SLOTS>
+typename pds::fpList<OBJ, SLOTS>::iterator pds::fpList<OBJ, SLOTS>::end(pds::version_t version){
+
+    return iterator(root, check_version("fpList::end", version));
+}
+
+
+template <class OBJ, class SLOTS>
+std::size_t pds::fpList<OBJ, SLOTS>::size(pds::version_t version) const noexcept {
+
+    if(version == default_version)
+        version = last_version;
+
+    pds::version_t slot;
+    const pds::fpChild<OBJ, SLOTS>* child = (version == MasterVersion) ? nullptr : root.resolve(version, slot);
+
+    return child == nullptr ? 0 : child->size;
+}
+
+
+template <class OBJ, class SLOTS>
+pds::version_t pds::fpList<OBJ, SLOTS>::curr_version() const noexcept {
+
+    return last_version;
+}
+
+
+#endif /* FULLY_PERSISTENT_LIST_HPP */
@@ -0,0 +1,320 @@
+/**
+ * @file fpMap.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief fully persistent ordered map container.
+ * @version 0.1
+ * @date 2025-01-27
+ */
+
+#ifndef FULLY_PERSISTENT_MAP_HPP
+#define FULLY_PERSISTENT_MAP_HPP
+
+#include "fpSet.hpp"
+
+namespace pds{
+
+    /**
+     * @brief The object of a fat node of fpMap: a key and its value, ordered by the key only.
+     *  A key is also compared with an entry directly, so a lookup does not build an entry.
+     */
+    template <class K, class V>
+    struct fpMapEntry{
+        K key;
+        V value;
+
+        friend bool operator<(const fpMapEntry& a, const fpMapEntry& b){ return a.key < b.key; }
+        friend bool operator<(const fpMapEntry& a, const K& key){ return a.key < key; }
+        friend bool operator<(const K& key, const fpMapEntry& a){ return key < a.key; }
+    };
+
+
+    /**
+     * @class fpMap
+     * @brief Fully persistent ordered map: every put and erase creates a new version,
+     *  and every version stays readable and updatable.
+     *
+     * @details The versions are treaps of fat nodes like the versions of @ref pds::fpSet,
+     *  and an entry is the object of its node. Putting a new value to a key that is already
+     *  in the version makes one node with the new entry and the priority of the old one,
+     *  and puts it in the place of the old node: the shape of the tree is kept, the children
+     *  are shared as they are, and only the ancestors get a slot of the new version.
+     *  An update is one descent and one version, instead of the remove and insert of an
+     *  entry in an fpSet (two versions, two descents and a split and a join).
+     *
+     * @tparam K the key type, which must support `operator<`.
+     * @tparam V the value type.
+     * @tparam SLOTS the storage engine of the version slots, see @ref pds::fpSet.
+     *
+     * @note The versions are numbered like the versions of fpSet: Version 1 is empty
+     *  and every update returns the next version. MasterVersion is not a version of a map.
+     *
+     * @example
+     * ```
+     * pds::fpMap<std::string, int> prices;
+     * prices.put("apple", 3);              // Version 2
+     * prices.put("apple", 4);              // Version 3
+     * prices.get("apple", 2);              // 3
+     * prices.put("pear", 7, 2);            // Version 4: branched from Version 2
+     * ```
+     */
+    template <class K, class V, class SLOTS = pds::fpHashSlots>
+    class fpMap{
+
+        using Entry = pds::fpMapEntry<K, V>;
+        using View = typename pds::fpTreap<Entry, SLOTS>::View;
+
+        pds::fpFatNodeArena<Entry, SLOTS> arena;    ///< owns all the fat nodes.
+        pds::fpFatNodePtr<Entry, SLOTS> root;       ///< the root of every version.
+        pds::version_t last_version;
+        std::uint64_t entries_made = 0;             ///< the sequence of the priority of the next new key.
+
+        /// @brief 'version', or the last version for default_version. throws if it not exists.
+        pds::version_t check_version(const char* func_name, pds::version_t version) const;
+
+    public:
+        using iterator = pds::fpSetIterator<Entry, SLOTS>;
+        using const_iterator = iterator;
+
+        /// @brief Version 1, the empty map.
+        fpMap();
+
+        /// @brief The fat nodes point to each other inside the arena, so a map can be moved but not copied.
+        fpMap(const fpMap&) = delete;
+        fpMap& operator=(const fpMap&) = delete;
+        fpMap(fpMap&&) = default;
+        fpMap& operator=(fpMap&&) = default;
+
+
+        /**
+         * @brief Maps 'key' to 'value' in a new version, based on 'version'.
+         *
+         * @param key the key. If it is in 'version', its entry is replaced, otherwise it is inserted.
+         * @param value the value. Taken by value: it is moved into the map.
+         * @param version the version to update. if 'version'=default_version update the last version.
+         *
+         * @exception
+         * - pds::VersionZeroIllegal
+         *      thrown if: version is 0
+         *
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()'
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log(K)) expected fat pointer lookups and writes,
+         *  while K is the number of keys in 'version'.
+         */
+        pds::version_t put(const K& key, V value, pds::version_t version = default_version);
+
+
+        /**
+         * @brief Removes 'key' in a new version, based on 'version'.
+         *
+         * @exception
+         * - pds::ObjectNotExist
+         *      thrown if: 'key' is not in 'version'
+         *
+         * - pds::VersionZeroIllegal
+         *      thrown if: version is 0
+         *
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()'
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log(K)) expected.
+         */
+        pds::version_t erase(const K& key, pds::version_t version = default_version);
+
+
+        /**
+         * @brief The value of 'key' in 'version'.
+         *
+         * @exception
+         * - pds::ObjectNotExist
+         *      thrown if: 'key' is not in 'version'
+         *
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref put.
+         *
+         * @return a reference to the value, that is valid while the map lives.
+         *
+         * @note Time complexity: O(log(K)) expected.
+         */
+        const V& get(const K& key, pds::version_t version = default_version);
+
+
+        /// @brief true if 'key' is in 'version'. throws like @ref get.
+        bool contains(const K& key, pds::version_t version = default_version);
+
+
+        /// @brief the entries of 'version', sorted by key. throws like @ref get.
+        std::vector<std::pair<K, V>> to_vector(pds::version_t version = default_version);
+
+
+        /// @brief iterators over the entries (see @ref pds::fpMapEntry) of 'version', sorted by key.
+        iterator begin(pds::version_t version = default_version);
+        iterator end(pds::version_t version = default_version);
+
+
+        /// @brief number of keys in 'version', or 0 if it not exists.
+        std::size_t size(pds::version_t version = default_version) const noexcept;
+
+
+        /// @brief the last version.
+        pds::version_t curr_version() const noexcept;
+    };
+};
+
+
+template <class K, class V, class SLOTS>
+pds::fpMap<K, V, SLOTS>::fpMap() : root(1), last_version(1) {
+}
+
+
+template <class K, class V, class SLOTS>
+pds::version_t pds::fpMap<K, V, SLOTS>::check_version(const char* func_name, pds::version_t version) const {
+
+    if(version == default_version)
+        return last_version;
+
+    if(version == MasterVersion)
+        throw pds::VersionZeroIllegal(std::string(func_name) + ": Version 0 is not a version of a map");
+
+    if(version > last_version)
+        throw pds::VersionNotExist(
+            std::string(func_name) + ": Version " + std::to_string(version) + " is not exist"
+        );
+
+    return version;
+}
+
+
+template <class K, class V, class SLOTS>
+pds::version_t pds::fpMap<K, V, SLOTS>::put(const K& key, V value, pds::version_t version){
+
+    version = check_version("fpMap::put", version);
+
+    pds::version_t new_version = last_version + 1;
+
+    pds::fpTreap<Entry, SLOTS> treap(arena, new_version);
+    View t = treap.at(root, version);
+    View old = treap.find(t, key);
+
+    if(old.node != nullptr){
+
+        // The same priority keeps the shape, so the new node takes the place of the old one.
+        pds::fpFatNode<Entry, SLOTS>* node = arena.make(
+            Entry{key, std::move(value)}, new_version, old.node->get_priority()
+        );
+        treap.set_root(root, treap.replace(t, node));
+    }
+    else{
+        pds::fpFatNode<Entry, SLOTS>* node = arena.make(
+            Entry{key, std::move(value)}, new_version, pds::fpTreap<Entry, SLOTS>::priority(entries_made++)
+        );
+        treap.set_root(root, treap.insert(t, node));
+    }
+
+    return (last_version = new_version);
+}
+
+
+template <class K, class V, class SLOTS>
+pds::version_t pds::fpMap<K, V, SLOTS>::erase(const K& key, pds::version_t version){
+
+    version = check_version("fpMap::erase", version);
+
+    View t = pds::fpTreap<Entry, SLOTS>::at(root, version);
+
+    if(pds::fpTreap<Entry, SLOTS>::find(t, key).node == nullptr)
+        throw pds::ObjectNotExist(
+            "fpMap::erase: Version " + std::to_string(version) + " has no such key"
+        );
+
+    pds::version_t new_version = last_version + 1;
+
+    pds::fpTreap<Entry, SLOTS> treap(arena, new_version);
+    treap.set_root(root, treap.erase(t, key));
+
+    return (last_version = new_version);
+}
+
+
+template <class K, class V, class SLOTS>
+const V& pds::fpMap<K, V, SLOTS>::get(const K& key, pds::version_t version){
+
+    version = check_version("fpMap::get", version);
+
+    View t = pds::fpTreap<Entry, SLOTS>::find(pds::fpTreap<Entry, SLOTS>::at(root, version), key);
+
+    if(t.node == nullptr)
+        throw pds::ObjectNotExist(
+            "fpMap::get: Version " + std::to_string(version) + " has no such key"
+        );
+
+    return t.node->get_obj().value;
+}
+
+
+template <class K, class V, class SLOTS>
+bool pds::fpMap<K, V, SLOTS>::contains(const K& key, pds::version_t version){
+
+    version = check_version("fpMap::contains", version);
+
+    return pds::fpTreap<Entry, SLOTS>::find(pds::fpTreap<Entry, SLOTS>::at(root, version), key).node != nullptr;
+}
+
+
+template <class K, class V, class SLOTS>
+std::vector<std::pair<K, V>> pds::fpMap<K, V, SLOTS>::to_vector(pds::version_t version){
+
+    version = check_version("fpMap::to_vector", version);
+
+    std::vector<std::pair<K, V>> entries;
+    entries.reserve(size(version));
+
+    for(iterator it = iterator::first(root, version); it != iterator(root, version); ++it){
+
+        entries.emplace_back(it->key, it->value);
+    }
+    return entries;
+}
+
+
+template <class K, class V, class SLOTS>
+typename pds::fpMap<K, V, SLOTS>::iterator pds::fpMap<K, V, SLOTS>::begin(pds::version_t version){
+
+    return iterator::first(root, check_version("fpMap::begin", version));
+}
+
+
+template <class K, class V, class SLOTS>
+typename pds::fpMap<K, V, SLOTS>::iterator pds::fpMap<K, V, SLOTS>::end(pds::version_t version){
+
+    return iterator(root, check_version("fpMap::end", version));
+}
+
+
+template <class K, class V, class SLOTS>
+std::size_t pds::fpMap<K, V, SLOTS>::size(pds::version_t version) const noexcept {
+
+    if(version == default_version)
+        version = last_version;
+
+    pds::version_t slot;
+    const pds::fpChild<Entry, SLOTS>* child = (version == MasterVersion) ? nullptr : root.resolve(version, slot);
+
+    return child == nullptr ? 0 : child->size;
+}
+
+
+template <class K, class V, class SLOTS>
+pds::version_t pds::fpMap<K, V, SLOTS>::curr_version() const noexcept {
+
+    return last_version;
+}
+
+
+#endif /* FULLY_PERSISTENT_MAP_HPP */
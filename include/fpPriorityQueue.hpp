@@ -0,0 +1,291 @@
+/**
+ * @file fpPriorityQueue.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief fully persistent min priority queue.
+ * @version 0.1
+ * @date 2025-02-17
+ */
+
+#ifndef FULLY_PERSISTENT_PRIORITY_QUEUE_HPP
+#define FULLY_PERSISTENT_PRIORITY_QUEUE_HPP
+
+#include "fpSet.hpp"
+
+namespace pds{
+
+    /**
+     * @class fpPriorityQueue
+     * @brief Fully persistent min priority queue: every push and pop creates a new version,
+     *  and every version stays readable and updatable.
+     *
+     * @details The versions are treaps of fat nodes like the versions of @ref pds::fpSet,
+     *  ordered by the objects, so the top of a version is its leftmost node.
+     *  Unlike a set, equal objects are all kept, and they leave the queue in no particular order.
+     *  A push writes the search path of the object, and a pop writes the left spine,
+     *  both O(log(K)) slots of the new version in expectation, and the rest is shared.
+     *
+     * @tparam OBJ the object type, which must support `operator<`. The smallest object is the top.
+     * @tparam SLOTS the storage engine of the version slots, see @ref pds::fpSet.
+     *
+     * @note The versions are numbered like the versions of fpSet: Version 1 is empty
+     *  and every update returns the next version. MasterVersion is not a version of a queue.
+     *
+     * @example
+     * ```
+     * pds::fpPriorityQueue<int> pending;
+     * pending.push(5);                     // Version 2
+     * pending.push(3);                     // Version 3
+     * pending.pop();                       // Version 4
+     * pending.top(3);                      // 3
+     * pending.top(4);                      // 5
+     * ```
+     */
+    template <class OBJ, class SLOTS = pds::fpHashSlots>
+    class fpPriorityQueue{
+
+        using View = typename pds::fpTreap<OBJ, SLOTS>::View;
+
+        pds::fpFatNodeArena<OBJ, SLOTS> arena;  ///< owns all the fat nodes.
+        pds::fpFatNodePtr<OBJ, SLOTS> root;     ///< the root of every version.
+        pds::version_t last_version;
+        std::uint64_t pushed = 0;               ///< the sequence of the priority of the next node.
+
+        /// @brief 'version', or the last version for default_version. throws if it not exists.
+        pds::version_t check_version(const char* func_name, pds::version_t version) const;
+
+        /// @brief the View of 'version'. throws pds::ObjectNotExist if it is empty.
+        View not_empty(const char* func_name, pds::version_t version);
+
+    public:
+        using iterator = pds::fpSetIterator<OBJ, SLOTS>;
+        using const_iterator = iterator;
+
+        /// @brief Version 1, the empty queue.
+        fpPriorityQueue();
+
+        /// @brief The fat nodes point to each other inside the arena, so a queue can be moved but not copied.
+        fpPriorityQueue(const fpPriorityQueue&) = delete;
+        fpPriorityQueue& operator=(const fpPriorityQueue&) = delete;
+        fpPriorityQueue(fpPriorityQueue&&) = default;
+        fpPriorityQueue& operator=(fpPriorityQueue&&) = default;
+
+
+        /**
+         * @brief Pushes 'obj' in a new version, based on 'version'.
+         *
+         * @param obj the object. Taken by value: it is moved into the queue.
+         * @param version the version to update. if 'version'=default_version update the last version.
+         *
+         * @exception
+         * - pds::VersionZeroIllegal
+         *      thrown if: version is 0
+         *
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()'
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log(K)) expected, while K is size(version).
+         */
+        pds::version_t push(OBJ obj, pds::version_t version = default_version);
+
+
+        /**
+         * @brief Removes the top of 'version' in a new version.
+         *
+         * @exception
+         * - pds::ObjectNotExist
+         *      thrown if: 'version' is empty
+         *
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref push.
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log(K)) expected.
+         */
+        pds::version_t pop(pds::version_t version = default_version);
+
+
+        /**
+         * @brief The smallest object of 'version'.
+         *
+         * @exception
+         * - pds::ObjectNotExist
+         *      thrown if: 'version' is empty
+         *
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref push.
+         *
+         * @return a reference to the object, that is valid while the queue lives.
+         *
+         * @note Time complexity: O(log(K)) expected.
+         */
+        const OBJ& top(pds::version_t version = default_version);
+
+
+        /// @brief the objects of 'version', from the top. throws like @ref push.
+        std::vector<OBJ> to_vector(pds::version_t version = default_version);
+
+
+        /// @brief iterators over the objects of 'version', from the top.
+        iterator begin(pds::version_t version = default_version);
+        iterator end(pds::version_t version = default_version);
+
+
+        /// @brief number of objects in 'version', or 0 if it not exists.
+        std::size_t size(pds::version_t version = default_version) const noexcept;
+
+
+        /// @brief true if 'version' has no objects, or it not exists.
+        bool empty(pds::version_t version = default_version) const noexcept;
+
+
+        /// @brief the last version.
+        pds::version_t curr_version() const noexcept;
+    };
+};
+
+
+template <class OBJ, class SLOTS>
+pds::fpPriorityQueue<OBJ, SLOTS>::fpPriorityQueue() : root(1), last_version(1) {
+}
+
+
+template <class OBJ, class SLOTS>
+pds::version_t pds::fpPriorityQueue<OBJ, SLOTS>::check_version(const char* func_name, pds::version_t version) const {
+
+    if(version == default_version)
+        return last_version;
+
+    if(version == MasterVersion)
+        throw pds::VersionZeroIllegal(std::string(func_name) + ": Version 0 is not a version of a queue");
+
+    if(version > last_version)
+        throw pds::VersionNotExist(
+            std::string(func_name) + ": Version " + std::to_string(version) + " is not exist"
+        );
+
+    return version;
+}
+
+
+template <class OBJ, class SLOTS>
+typename pds::fpPriorityQueue<OBJ, SLOTS>::View
+pds::fpPriorityQueue<OBJ, SLOTS>::not_empty(const char* func_name, pds::version_t version){
+
+    View t = pds::fpTreap<OBJ, SLOTS>::at(root, version);
+
+    if(t.node == nullptr)
+        throw pds::ObjectNotExist(
+            std::string(func_name) + ": Version " + std::to_string(version) + " is empty"
+        );
+
+    return t;
+}
+
+
+template <class OBJ, class SLOTS>
+pds::version_t pds::fpPriorityQueue<OBJ, SLOTS>::push(OBJ obj, pds::version_t version){
+
+    version = check_version("fpPriorityQueue::push", version);
+
+    pds::version_t new_version = last_version + 1;
+
+    pds::fpFatNode<OBJ, SLOTS>* node = arena.make(
+        std::move(obj), new_version, pds::fpTreap<OBJ, SLOTS>::priority(pushed++)
+    );
+
+    // fpTreap::insert does not look for an equal object, so the equal objects are all kept.
+    pds::fpTreap<OBJ, SLOTS> treap(arena, new_version);
+    treap.set_root(root, treap.insert(treap.at(root, version), node));
+
+    return (last_version = new_version);
+}
+
+
+template <class OBJ, class SLOTS>
+pds::version_t pds::fpPriorityQueue<OBJ, SLOTS>::pop(pds::version_t version){
+
+    version = check_version("fpPriorityQueue::pop", version);
+
+    View t = not_empty("fpPriorityQueue::pop", version);
+
+    pds::version_t new_version = last_version + 1;
+
+    pds::fpTreap<OBJ, SLOTS> treap(arena, new_version);
+    treap.set_root(root, treap.split_at(t, 1).second);
+
+    return (last_version = new_version);
+}
+
+
+template <class OBJ, class SLOTS>
+const OBJ& pds::fpPriorityQueue<OBJ, SLOTS>::top(pds::version_t version){
+
+    version = check_version("fpPriorityQueue::top", version);
+
+    std::size_t first = 0;
+    return pds::fpTreap<OBJ, SLOTS>::nth(not_empty("fpPriorityQueue::top", version), first).node->get_obj();
+}
+
+
+template <class OBJ, class SLOTS>
+std::vector<OBJ> pds::fpPriorityQueue<OBJ, SLOTS>::to_vector(pds::version_t version){
+
+    version = check_version("fpPriorityQueue::to_vector", version);
+
+    std::vector<OBJ> objs;
+    objs.reserve(size(version));
+
+    for(iterator it = iterator::first(root, version); it != iterator(root, version); ++it){
+
+        objs.push_back(*it);
+    }
+    return objs;
+}
+
+
+template <class OBJ, class SLOTS>
+typename pds::fpPriorityQueue<OBJ, SLOTS>::iterator pds::fpPriorityQueue<OBJ, SLOTS>::begin(pds::version_t version){
+
+    return iterator::first(root, check_version("fpPriorityQueue::begin", version));
+}
+
+
+template <class OBJ, class SLOTS>
+typename pds::fpPriorityQueue<OBJ, SLOTS>::iterator pds::fpPriorityQueue<OBJ, SLOTS>::end(pds::version_t version){
+
+    return iterator(root, check_version("fpPriorityQueue::end", version));
+}
+
+
+template <class OBJ, class SLOTS>
+std::size_t pds::fpPriorityQueue<OBJ, SLOTS>::size(pds::version_t version) const noexcept {
+
+    if(version == default_version)
+        version = last_version;
+
+    pds::version_t slot;
+    const pds::fpChild<OBJ, SLOTS>* child = (version == MasterVersion) ? nullptr : root.resolve(version, slot);
+
+    return child == nullptr ? 0 : child->size;
+}
+
+
+template <class OBJ, class SLOTS>
+bool pds::fpPriorityQueue<OBJ, SLOTS>::empty(pds::version_t version) const noexcept {
+
+    return size(version) == 0;
+}
+
+
+template <class OBJ, class SLOTS>
+pds::version_t pds::fpPriorityQueue<OBJ, SLOTS>::curr_version() const noexcept {
+
+    return last_version;
+}
+
+
+#endif /* FULLY_PERSISTENT_PRIORITY_QUEUE_HPP */
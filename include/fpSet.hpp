@@ -10,7 +10,11 @@
 #ifndef FULLY_PERSISTENT_SET_HPP
 #define FULLY_PERSISTENT_SET_HPP
 
+#include "internal/fpCodec.hpp"
+#include "internal/fpImage.hpp"
+#include "internal/fpSetIterator.hpp"
 #include "internal/fpSetTracker.hpp"
+#include "internal/fpTreap.hpp"
 
 namespace pds{
 
@@ -18,6 +22,77 @@ namespace pds{
     const pds::version_t default_version = std::numeric_limits<pds::version_t>::max();
 
 
+    /// @brief The first 8 bytes of a snapshot. see @ref fpSet::save.
+    const std::uint64_t snapshot_magic = 0x3330544553504650ULL;     // "PFPSET03"
+
+
+    /// @brief The kind of a batch operation. see @ref fpSet::apply.
+    enum class fpOp{ insert, remove };
+
+    /// @brief One operation of a batch. see @ref fpSet::apply.
+    template <class OBJ>
+    struct fpBatchOp{
+        pds::fpOp op;
+        OBJ obj;
+    };
+
+    /// @brief The kind of a logged update. see @ref fpLogSink.
+    enum class fpLogOp : std::uint8_t{ insert, remove, apply, merge_union, intersect, subtract, retire };
+
+    /**
+     * @brief Receives every update of an fpSet before it is published. see @ref fpSet::set_log.
+     *
+     * @details 'version' is the version that the update has built, and the readers can not see yet.
+     *  An update that fails is not reported. If a call throws, the update is cancelled: its version
+     *  is not published and the next update builds it again. Only MasterVersion may keep the objects 
+     *  of a cancelled insert, until @ref fpSet::retain_only rebuilds it. A retire is reported before 
+     *  it is applied. pds::fpSetLog is a sink that writes the updates to a write-ahead log file.
+     */
+    template <class OBJ>
+    class fpLogSink{
+    public:
+        virtual ~fpLogSink() = default;
+
+        /// @brief insert or remove of 'obj' from 'base'.
+        virtual void log_update(pds::fpOp op, const OBJ& obj, pds::version_t base, pds::version_t version) = 0;
+
+        /// @brief apply of 'batch' to 'base'. The batch is sorted and valid.
+        virtual void log_apply(const std::vector<pds::fpBatchOp<OBJ>>& batch, pds::version_t base, pds::version_t version) = 0;
+
+        /// @brief merge_union, intersect or subtract of 'v1' and 'v2'.
+        virtual void log_combine(pds::fpLogOp op, pds::version_t v1, pds::version_t v2, pds::version_t version) = 0;
+
+        /// @brief retire or retain_only of 'versions'.
+        virtual void log_retire(const std::vector<pds::version_t>& versions) = 0;
+    };
+
+    /// @brief The changes between two versions, both sorted. see @ref fpSet::diff.
+    template <class OBJ>
+    struct fpDiff{
+        std::vector<OBJ> inserted;  ///< objects of the second version that are not in the first.
+        std::vector<OBJ> removed;   ///< objects of the first version that are not in the second.
+    };
+
+    /**
+     * @brief The memory of a set, by part. see @ref fpSet::memory_stats.
+     *
+     * @details The bytes are what the set allocated from its memory resource, with the unused capacity 
+     *  of its blocks and vectors. Memory that an object owns itself (e.g. the characters of a long 
+     *  std::string) is not counted. The size of every version is kept in the slots, so it is part of 'slot_bytes'.
+     */
+    struct fpMemoryStats{
+        std::size_t versions = 0;       ///< versions that were not retired, Version 1 included.
+        std::size_t nodes = 0;          ///< fat nodes, the copies of full nodes included.
+        std::size_t slots = 0;          ///< versions mapped by all the fat pointers, the root included.
+        std::size_t object_bytes = 0;   ///< the objects inside the fat nodes.
+        std::size_t node_bytes = 0;     ///< the rest of the node blocks: links, priorities, inline slots and free places.
+        std::size_t slot_bytes = 0;     ///< the slots that the fat pointers allocated outside of their nodes.
+        std::size_t index_bytes = 0;    ///< the versions maps of pds::fpHashSlots. 0 for the other engines.
+
+        std::size_t total_bytes() const noexcept { return object_bytes + node_bytes + slot_bytes + index_bytes; }
+    };
+
+
     /**
      * @class fpSet
      * @brief Fully persistent set container for sorted, unique objects.
@@ -26,12 +101,33 @@ namespace pds{
      * of the set after each modification. Each version is preserved, enabling access to any 
      * past state of the set.
      * 
-     * @tparam OBJ The object type, which must support `operator<` for sorting and provide
+     * Every version is a treap (see @ref pds::fpTreap) whose node priorities are fixed per object,
+     * so the depth of a version is O(log(K)) in expectation even for sorted insertions.
+     * 
+     * @tparam OBJ The object type, which must be ordered by COMPARE and provide
      *             either copy or move constructors.
      * 
+     * @tparam COMPARE The order of the objects: a strict weak order (default `std::less<>`, which is `operator<`).
+     *  The set keeps the comparator it was constructed with, so it may have a state that must not change
+     *  the order while the set lives. The readers call it together, so its call must be const.
+     *  A transparent COMPARE (with `is_transparent`) also looks up keys of other types, see @ref contains.
+     * 
+     * @tparam SLOTS The storage engine of the version slots in every fat pointer:
+     *  - pds::fpHashSlots (default): 'std::unordered_map' of slots with a 'pds::fpVersionIndex' versions map.
+     *  - pds::fpFlatSlots<INLINE>: sorted small-vector of resolved slots, 
+     *      the first INLINE slots are stored inside the fat pointer.
+     *  - pds::fpConcurrentSlots<INLINE>: like fpFlatSlots, for one writer thread and many reader threads.
+     * 
+     * @note Thread safety: the queries (contains, rank, select, to_vector, diff, iterators, size) 
+     *  do not change the set, so any number of threads may run them together.
+     *  With pds::fpConcurrentSlots they may also run while one thread creates new versions,
+     *  for every version that was already returned to the readers (but not for MasterVersion, 
+     *  which is updated in place by every insert). Retiring versions must not run with any reader.
+     * 
      * @note Space Complexity: O(N log(N))
      *       - N represents the number of versions maintained (i.e., `last_version`).
-     *       - Every object is saved only once, regardless of how many versions it exists in.
+     *       - An object is saved once, and copied again only when its fat node is full
+     *         (see @ref pds::fpFatNodeCapacity).
      * 
      * @example
      * ```
@@ -42,22 +138,143 @@ namespace pds{
      * // Access previous version states
      * ```
      */
-    template <class OBJ>
+    template <class OBJ, class COMPARE = std::less<>, class SLOTS = pds::fpHashSlots>
     class fpSet{
 
-        pds::fpFatNodePtr<OBJ> root;    ///< root of a BST that stores the data.
-        pds::version_t last_version;    ///< in the range of [1, MAX_size_t]
-        std::vector<pds::version_t> sizes;  ///< keep the size for each version (including 0 for MasterVersion)
+        pds::fpFatNodeArena<OBJ, SLOTS> arena;  ///< owns all the fat nodes.
+        pds::fpFatNodePtr<OBJ, SLOTS> root;    ///< root of a BST that stores the data.
+        std::atomic<pds::version_t> last_version;   ///< in the range of [1, MAX_size_t]. Publishes a version to the readers.
+        pds::version_t retired_versions = 0;        ///< number of versions that were retired.
+        std::uint64_t nodes_made = 0;               ///< the sequence of the priority of the next object.
+        pds::fpLogSink<OBJ>* log = nullptr;         ///< receives the updates, if set. see @ref set_log.
+        [[no_unique_address]] COMPARE compare;      ///< the order of the objects.
 
     public:
+        using iterator = pds::fpSetIterator<OBJ, SLOTS>;
+        using const_iterator = iterator;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+
         /**
          * @brief Construct a new object.
          * 
          * @details Also insert two init Versions:
          *  - Version 0: see @ref MasterVersion.
          *  - Version 1: will save the init state version. (will always be empty).
+         * 
+         * @param resource the memory of the fat nodes and their slot tables, for example a 
+         *  std::pmr::monotonic_buffer_resource for a short-lived set. Must outlive the set.
+         * @param compare the order of the objects.
+         */
+        explicit fpSet(std::pmr::memory_resource* resource = std::pmr::get_default_resource(), 
+                       COMPARE compare = COMPARE());
+
+        /// @brief The fat nodes point to each other inside the arena, so a set can be moved but not copied.
+        fpSet(const fpSet&) = delete;
+        fpSet& operator=(const fpSet&) = delete;
+        fpSet(fpSet&& other);
+        fpSet& operator=(fpSet&& other);
+
+
+        /**
+         * @brief Builds a set from a sorted range in one linear pass.
+         * 
+         * @details Version 2 (and the master tree) is a perfectly balanced tree of all the objects.
+         *  The nodes get priorities that decrease with their depth, so it is also a valid treap
+         *  and the next versions stay balanced.
+         * 
+         * @param first, last the range of the objects. Must be strictly increasing by COMPARE.
+         * @param resource the memory of the set, see @ref fpSet().
+         * @param compare the order of the set, see @ref fpSet().
+         * @attention The objects are copied, pass std::move_iterator to move them.
+         * 
+         * @exception
+         * - pds::ObjectsNotSorted
+         *      thrown if: the range is not strictly increasing.
+         * 
+         * @return fpSet with curr_version() == 2: Version 1 is empty and Version 2 holds the range.
+         * 
+         * @note Time complexity: O(K) while K is the size of the range.
+         */
+        template <class ForwardIt>
+        static fpSet from_sorted(ForwardIt first, ForwardIt last,
+                                 std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+                                 COMPARE compare = COMPARE());
+
+        /**
+         * @brief Writes a binary snapshot of the set: all its versions, in one pass over its fat nodes.
+         * 
+         * @details Every fat node is written once, with its object, its priority and the slots of its 
+         *  fat pointers, so the snapshot has the size of the set in memory and not of its history.
+         *  The numbers are written in the byte order of the machine, and the snapshot ends with
+         *  the FNV-1a checksum of all its bytes (see @ref pds::fpChecksum).
+         * 
+         * @param out the stream to write to. Open it in binary mode.
+         * @param codec writes the objects, see @ref pds::fpCodec.
+         * 
+         * @exception
+         * - std::ios_base::failure
+         *      thrown if: writing to 'out' failed.
+         * 
+         * @note Time complexity: O(S) while S is the number of slots of the set.
+         */
+        template <class CODEC = pds::fpCodec<OBJ>>
+        void save(std::ostream& out, CODEC codec = {});
+
+
+        /**
+         * @brief Reads a set that was written by @ref save, with all its versions.
+         * 
+         * @param in the stream to read from. Open it in binary mode.
+         * @param codec reads the objects, must match the codec of save. see @ref pds::fpCodec.
+         * @param resource the memory of the set, see @ref fpSet().
+         * @param compare the order of the set, see @ref fpSet(). The snapshot does not hold it,
+         *  it must order the objects like the comparator of the saved set.
+         * 
+         * @exception
+         * - pds::CorruptedSnapshot
+         *      thrown if: 'in' does not hold a snapshot, it ends before the snapshot, 
+         *      or the checksum of the snapshot does not match its bytes.
+         * 
+         * @return the set, with the same versions and curr_version() as the saved set.
+         * 
+         * @note Time complexity: O(S) while S is the number of slots of the set.
+         *  No object is compared and no version is replayed.
+         */
+        template <class CODEC = pds::fpCodec<OBJ>>
+        static fpSet load(std::istream& in, CODEC codec = {},
+                          std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+                          COMPARE compare = COMPARE());
+
+
+        /**
+         * @brief Writes a frozen image of the set, that @ref pds::fpSetImage queries in place.
+         * 
+         * @details The nodes and the slots are written as two flat arrays, with indexes instead of pointers,
+         *  so the image can be mapped to memory and read without building anything.
+         *  Only a trivially copyable OBJ can be frozen, it is copied as it is.
+         * 
+         * @param out the stream to write to. Open it in binary mode.
+         * 
+         * @exception
+         * - std::ios_base::failure
+         *      thrown if: writing to 'out' failed.
+         * 
+         * @note Time complexity: O(S) while S is the number of slots of the set.
+         */
+        void freeze(std::ostream& out);
+
+
+        /**
+         * @brief Sends every next update of the set to 'sink' before it is published.
+         * 
+         * @details insert, remove, apply, merge_union, intersect, subtract, retire and retain_only 
+         *  are reported with the version that they create. from_sorted and load are not updates, 
+         *  so a log starts from a snapshot of the set (see @ref pds::fpSetLog).
+         * 
+         * @param sink the sink, that must outlive the set or be replaced. nullptr stops logging.
          */
-        fpSet();
+        void set_log(pds::fpLogSink<OBJ>* sink) noexcept;
+
 
         /**
          * @brief Inserts an object into the set at a specific version.
@@ -85,8 +302,10 @@ namespace pds{
          * 
          * @return pds::version_t of the new version.
          * 
-         * @note Time complexity: O(log(N) * log*(N))
-         *  while N is the number of versions, i.e. N is last_version.
+         * @note Time complexity: O(log(K) + log(N)) expected
+         *  while K is the number of objects in 'version' and N is the number of versions, i.e. N is last_version:
+         *  one slot lookup per level of the treap, in O(1) below the root (a fat pointer there holds at most
+         *  pds::fpFatNodeCapacity versions), and one search in the versions of the root (see @ref pds::fpVersionIndex).
          */
         pds::version_t insert(const OBJ& obj, pds::version_t version = default_version);
 
@@ -119,8 +338,10 @@ namespace pds{
          * 
          * @return pds::version_t of the new version.
          * 
-         * @note Time complexity: O(log(N) * log*(N))
-         *  while N is the number of versions, i.e. N is last_version.
+         * @note Time complexity: O(log(K) + log(N)) expected
+         *  while K is the number of objects in 'version' and N is the number of versions, i.e. N is last_version:
+         *  one slot lookup per level of the treap, in O(1) below the root (a fat pointer there holds at most
+         *  pds::fpFatNodeCapacity versions), and one search in the versions of the root (see @ref pds::fpVersionIndex).
          */
         pds::version_t insert(OBJ&& obj, pds::version_t version = default_version);
 
@@ -150,8 +371,10 @@ namespace pds{
          * 
          * @return pds::version_t of the new version. 
          * 
-         * @note Time complexity: O(log(N) * log*(N))
-         *  while N is the number of versions, i.e. N is last_version.
+         * @note Time complexity: O(log(K) + log(N)) expected
+         *  while K is the number of objects in 'version' and N is the number of versions, i.e. N is last_version:
+         *  one slot lookup per level of the treap, in O(1) below the root (a fat pointer there holds at most
+         *  pds::fpFatNodeCapacity versions), and one search in the versions of the root (see @ref pds::fpVersionIndex).
          */
         pds::version_t remove(const OBJ& obj, pds::version_t version = default_version);
 
@@ -183,12 +406,127 @@ namespace pds{
          * 
          * @return pds::version_t of the new version.
          * 
-         * @note Time complexity: O(log(N) * log*(N))
-         *  while N is the number of versions, i.e. N is last_version.
+         * @note Time complexity: O(log(K) + log(N)) expected
+         *  while K is the number of objects in 'version' and N is the number of versions, i.e. N is last_version:
+         *  one slot lookup per level of the treap, in O(1) below the root (a fat pointer there holds at most
+         *  pds::fpFatNodeCapacity versions), and one search in the versions of the root (see @ref pds::fpVersionIndex).
          */
         pds::version_t remove(OBJ&& obj, pds::version_t version = default_version);
 
 
+        /**
+         * @brief Applies a batch of inserts and removes to a specific version as one new version.
+         * 
+         * The operations are applied in the order of their objects and share the path copies of 
+         *  the new version, so a batch of B operations creates one version and
+         *  at most one slot in every fat pointer it touches.
+         * The batch is validated before anything is written: if it throws, no version is created.
+         * 
+         * @param batch the operations. Every object may appear only once.
+         * @attention Taken by value: the objects of the inserts are moved into the set.
+         * 
+         * @param version the version to apply the batch to.
+         *  if 'version'=default_version apply to last version.
+         * 
+         * @exception 
+         * - pds::ObjectAlreadyExist
+         *      thrown if: an inserted object exists in 'version', or an object appears twice in 'batch'.
+         * 
+         * - pds::ObjectNotExist
+         *      thrown if: a removed object not exists in 'version'.
+         * 
+         * - pds::VersionZeroIllegal
+         *      thrown if: version is 0
+         * 
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()'
+         * 
+         * @return pds::version_t of the new version.
+         * 
+         * @note Time complexity: O(B log(B) + B log(K) + log(N)) expected
+         *  while B is the size of the batch, K is the number of objects in 'version'
+         *  and N is the number of versions, i.e. N is last_version.
+         */
+        pds::version_t apply(std::vector<pds::fpBatchOp<OBJ>> batch, pds::version_t version = default_version);
+
+
+        /**
+         * @brief Creates a new version with the objects of 'v1' or 'v2'.
+         * 
+         * @details The subtrees that are shared by 'v1' and 'v2' are reused by the new version 
+         *  without visiting them, and no object is copied.
+         * 
+         * @param v1, v2 the versions to combine.
+         * 
+         * @exception
+         * - pds::VersionZeroIllegal
+         *      thrown if: 'v1' or 'v2' is 0
+         * 
+         * - pds::VersionNotExist
+         *      thrown if: 'v1' or 'v2' is bigger than what returned with 'curr_version()'
+         * 
+         * @return pds::version_t of the new version.
+         * 
+         * @note Time complexity: O(M log(K / M)) expected, while M is the size of the smaller version
+         *  and K the size of the bigger one. Shared subtrees cost O(1).
+         */
+        pds::version_t merge_union(pds::version_t v1, pds::version_t v2);
+
+
+        /**
+         * @brief Creates a new version with the objects that are in both 'v1' and 'v2'.
+         * @details see @ref merge_union.
+         */
+        pds::version_t intersect(pds::version_t v1, pds::version_t v2);
+
+
+        /**
+         * @brief Creates a new version with the objects of 'v1' that are not in 'v2'.
+         * @details see @ref merge_union.
+         */
+        pds::version_t subtract(pds::version_t v1, pds::version_t v2);
+
+
+        /**
+         * @brief Retires a version: it can not be used anymore, and the memory that only it needed is freed.
+         * 
+         * @details The slots of 'version' are dropped from every fat pointer, unless another version 
+         *  still reaches a subtree through them. A fat node that no other version reaches is destroyed, 
+         *  and an object that is in no other version is removed from the master tree.
+         *  The numbers of the versions do not change, and a retired number is never created again.
+         *  Every query of a retired version throws pds::VersionNotExist, except @ref size that returns 0.
+         * 
+         * @param version the version to retire. It may be the current version, then the next 
+         *  insert, remove or apply must name a version.
+         * @attention Not thread safe: no other thread may use the set meanwhile.
+         *  The iterators of the retired version and of MasterVersion are invalidated.
+         * 
+         * @exception
+         * - pds::VersionZeroIllegal
+         *      thrown if: version is 0
+         * 
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()', or was retired.
+         * 
+         * @note Time complexity: O(S + A) while S is the number of slots of the versions that are left 
+         *  and A is the number of fat nodes, whatever 'version' holds: every call walks all the set.
+         *  So do not retire a version after every update, collect them and retire them together 
+         *  with @ref retain_only, in one pass.
+         */
+        void retire(pds::version_t version);
+
+
+        /**
+         * @brief Retires every version for which 'keep(version)' is false, in one pass. see @ref retire.
+         * 
+         * @param keep called once for every version in [1, curr_version()] that was not retired.
+         * 
+         * @return the number of versions that were retired.
+         */
+        template <class PRED>
+        std::size_t retain_only(PRED&& keep);
+
+
         /**
          * @brief Check if an object is in the set in a specific version.
          * 
@@ -203,11 +541,85 @@ namespace pds{
          *
          * @return true if the object exists in the specified version; otherwise, false.
          * 
-         * @note Time complexity: O(log(N) * log*(N))
-         *  while N is the number of versions, i.e. N is last_version.
+         * @note Time complexity: O(log(K) + log(N)) expected
+         *  while K is the number of objects in 'version' and N is the number of versions, i.e. N is last_version:
+         *  one slot lookup per level of the treap, in O(1) below the root (a fat pointer there holds at most
+         *  pds::fpFatNodeCapacity versions), and one search in the versions of the root (see @ref pds::fpVersionIndex).
          */
         bool contains(const OBJ& obj, pds::version_t version = MasterVersion);
 
+        /**
+         * @brief Check if an object that is equivalent to 'key' is in the set in a specific version.
+         * 
+         * Only if COMPARE is transparent (like the default std::less<>): 'key' is compared with the objects
+         * as it is, so no OBJ is built for the lookup. e.g. a std::string_view in a set of std::string.
+         * 
+         * @exception see @ref contains.
+         */
+        template <class KEY> requires pds::fpTransparent<COMPARE>
+        bool contains(const KEY& key, pds::version_t version = MasterVersion);
+
+
+        /**
+         * @brief Check if an object is in the set in a specific version, without validating the version.
+         * 
+         * The hot path of @ref contains: a single lookup per level and no exception machinery.
+         * 
+         * @param obj the object to query for.
+         * 
+         * @param version version to check for.
+         * @attention 'version' must be in the range [0, curr_version()] and not retired, 
+         *  otherwise the behavior is undefined.
+         * 
+         * @exception No exceptions (unless COMPARE throws).
+         *
+         * @return true if the object exists in the specified version; otherwise, false.
+         */
+        bool contains_unchecked(const OBJ& obj, pds::version_t version);
+
+        /// @brief @ref contains_unchecked of a 'key' that is compared with the objects. see @ref contains.
+        template <class KEY> requires pds::fpTransparent<COMPARE>
+        bool contains_unchecked(const KEY& key, pds::version_t version);
+
+
+        /**
+         * @brief number of objects in 'version' that are less than 'obj'.
+         * 
+         * @param obj the object to rank. It does not have to be in the set.
+         * 
+         * @param version version to check for.
+         *  If the version is not specified then rank among the all objects in all versions.
+         * 
+         * @exception
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()'
+         * 
+         * @note Time complexity: O(log(K)) fat pointer lookups,
+         *  while K is the number of objects in 'version'.
+         */
+        std::size_t rank(const OBJ& obj, pds::version_t version = MasterVersion);
+
+
+        /**
+         * @brief the k-th smallest object of 'version', starting from 0.
+         * 
+         * @param k the position of the object.
+         * 
+         * @param version version to select from.
+         *  If the version is not specified then select among the all objects in all versions.
+         * 
+         * @exception
+         * - pds::ObjectNotExist
+         *      thrown if: 'k' is not less than size('version').
+         * 
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()'
+         * 
+         * @note Time complexity: O(log(K)) fat pointer lookups,
+         *  while K is the number of objects in 'version'.
+         */
+        const OBJ& select(std::size_t k, pds::version_t version = MasterVersion);
+
 
         /**
          * @brief return a sorted set as std::vector<OBJ>.
@@ -221,13 +633,89 @@ namespace pds{
          * 
          * @return std::vector<OBJ> a sorted set.
          * 
-         * @note Time complexity: O((K log*(N)) + log(N))
+         * @note Time complexity: O(K + log(N))
          *  while K is the number of objects in 'version'
-         *  and N is the number of versions, i.e. N is last_version.
+         *  and N is the number of versions, i.e. N is last_version: the root is searched once,
+         *  and every node below it resolves its slots in O(1).
          */
         std::vector<OBJ> to_vector(const pds::version_t version = MasterVersion);
 
 
+        /**
+         * @brief the objects that were inserted and removed on the way from version 'a' to version 'b'.
+         * 
+         * @details Both version trees are walked together. A subtree that is shared by the two versions
+         *  (the same fat node reached through the same slot) is skipped without visiting it,
+         *  so the cost is proportional to the number of changes and not to the size of the set.
+         * 
+         * @param a, b the versions to compare. 
+         * 
+         * @exception
+         * - pds::VersionNotExist
+         *      thrown if: 'a' or 'b' is bigger than what returned with 'curr_version()'
+         * 
+         * @return fpDiff with the sorted objects of 'b' that are not in 'a' (inserted) 
+         *  and of 'a' that are not in 'b' (removed).
+         * 
+         * @note Time complexity: O(D log(K)) while D is the number of changed objects
+         *  and K is the number of objects in the versions.
+         */
+        pds::fpDiff<OBJ> diff(pds::version_t a, pds::version_t b);
+
+
+        /**
+         * @brief iterators over the sorted objects of 'version', without copying them.
+         * 
+         * @param version the version to iterate.
+         *  If the version is not specified then iterate the all objects in all versions.
+         * @attention Iterators of a created version stay valid while the set lives,
+         *  iterators of MasterVersion are invalidated by inserting a new object.
+         * 
+         * @exception
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()'
+         * 
+         * @note Time complexity: O(log(K)) for begin, and amortized O(1) for every increment.
+         */
+        iterator begin(pds::version_t version = MasterVersion);
+        iterator end(pds::version_t version = MasterVersion);
+        reverse_iterator rbegin(pds::version_t version = MasterVersion);
+        reverse_iterator rend(pds::version_t version = MasterVersion);
+
+
+        /**
+         * @brief the first object of 'version' that is not less than 'obj' (lower_bound),
+         *  or that is greater than 'obj' (upper_bound).
+         * 
+         * @exception
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()'
+         * 
+         * @return iterator to the object, or end('version') if there is no such object.
+         */
+        iterator lower_bound(const OBJ& obj, pds::version_t version = MasterVersion);
+        iterator upper_bound(const OBJ& obj, pds::version_t version = MasterVersion);
+
+        /// @brief @ref lower_bound and @ref upper_bound of a 'key' that is compared with the objects. see @ref contains.
+        template <class KEY> requires pds::fpTransparent<COMPARE>
+        iterator lower_bound(const KEY& key, pds::version_t version = MasterVersion);
+
+        template <class KEY> requires pds::fpTransparent<COMPARE>
+        iterator upper_bound(const KEY& key, pds::version_t version = MasterVersion);
+
+
+        /**
+         * @brief the objects of 'version' in [lo, hi).
+         * 
+         * @exception
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()'
+         * 
+         * @return a range for range-based for loops and std::ranges algorithms.
+         */
+        std::ranges::subrange<iterator> range(const OBJ& lo, const OBJ& hi, pds::version_t version = MasterVersion);
+
+
         /**
          * @brief size of the set for 'version'.
          * 
@@ -237,11 +725,28 @@ namespace pds{
          * 
          * @return pds::version_t a std::size_t. see @ref pds::version_t.
          *  If the version is not specified: the size of all unique objects in all versions.
-         *  If version not exists: 0
+         *  If version not exists, or was retired: 0
+         * 
+         * @note Time complexity: one lookup in the root slots, every slot keeps the size of its version.
          */
         pds::version_t size(pds::version_t version = MasterVersion) const noexcept;
 
 
+        /**
+         * @brief The memory of the set: its bytes by part, and its numbers of versions, nodes and slots.
+         * 
+         * @details Nothing is allocated and nothing is walked: the arena and every fat pointer add each
+         *  change of their nodes, slots and capacity to running counters, that are read here. So it may be
+         *  called periodically (e.g. by a metrics exporter), also while a writer updates the set: then every
+         *  number is one that the set had, but they may be taken before and after the same update.
+         * 
+         * @return pds::fpMemoryStats of the set.
+         * 
+         * @note Time complexity: O(1).
+         */
+        pds::fpMemoryStats memory_stats() const noexcept;
+
+
         /**
          * @brief current version
          * 
@@ -263,9 +768,10 @@ namespace pds{
          * - pds::VersionNotExist
          *      thrown if: version is bigger than what returned with 'curr_version()'
          * 
-         * @note Time complexity: O((K log*(N)) + log(N))
+         * @note Time complexity: O(K + log(N))
          *  while K is the number of objects in 'version'
-         *  and N is the number of versions, i.e. N is last_version.
+         *  and N is the number of versions, i.e. N is last_version: the root is searched once,
+         *  and every node below it resolves its slots in O(1).
          */
         void print(pds::version_t version = MasterVersion);
 
@@ -277,103 +783,494 @@ namespace pds{
          */
         template <typename T>
         pds::version_t insert_impl(T&& obj, pds::version_t version);
-    };
-};
 
+        /// @brief throws pds::VersionNotExist if 'version' was not created yet, or was retired.
+        void check_version(const char* func_name, pds::version_t version);
 
-template <class OBJ>
-pds::fpSet<OBJ>::fpSet() : root(1), last_version(1), sizes{0, 0} {
-}
+        /// @brief the lookup of @ref contains_unchecked, for an OBJ or a KEY.
+        template <class KEY>
+        bool find_unchecked(const KEY& key, pds::version_t version);
 
+        /**
+         * @brief free everything that the versions with 'live[version] == true' do not reach.
+         * For internal use of @ref retire and @ref retain_only.
+         */
+        void collect(const std::vector<bool>& live);
 
-template <class OBJ>
-pds::version_t pds::fpSet<OBJ>::insert(const OBJ& obj, pds::version_t version){
+        /**
+         * @brief the fat node of 'obj' from the master tree. 
+         *  If 'obj' was never inserted, a new node is added to the master tree.
+         * @tparam T Generic type for one of the options: const OBJ&, OBJ&&
+         */
+        template <typename T>
+        pds::fpFatNode<OBJ, SLOTS>* master_node(T&& obj, pds::version_t new_version);
 
-    return insert_impl(obj, version);
-}
+        /**
+         * @brief build a perfectly balanced subtree of the next 'n' objects of 'it' for 'new_version'
+         *  and MasterVersion. 'index' is the position of the subtree root in a breadth-first order.
+         */
+        template <class ForwardIt>
+        pds::fpFatNode<OBJ, SLOTS>* build_sorted(ForwardIt& it, std::size_t n, std::size_t index, 
+            std::uint64_t step, const OBJ*& prev, pds::version_t new_version);
 
+        using View = typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View;
 
-template <class OBJ>
-pds::version_t pds::fpSet<OBJ>::insert(OBJ&& obj, pds::version_t version){
+        /**
+         * @brief create a new version from 'v1' and 'v2' with the treap operation 'op'.
+         * For internal use, only to avoid code duplication of the set operations.
+         */
+        template <class OP>
+        pds::version_t combine(pds::version_t v1, pds::version_t v2, const char* func_name, pds::fpLogOp log_op, OP&& op);
 
-    return insert_impl(std::move(obj), version);
-}
+        /**
+         * @brief add to 'changes' the difference between the objects of 'x' and 'y' in the range (lo, hi).
+         *  A null bound is unbounded.
+         */
+        void diff_views(View x, View y, const OBJ* lo, const OBJ* hi, pds::fpDiff<OBJ>& changes) const;
 
+        /// @brief add the objects of 't' in (lo, hi) to 'out', sorted.
+        void collect(const View& t, const OBJ* lo, const OBJ* hi, std::vector<OBJ>& out) const;
+    };
+};
 
-template <class OBJ>
-template <typename T>
-pds::version_t pds::fpSet<OBJ>::insert_impl(T&& obj, pds::version_t version){
 
-    if(version == default_version)
-        version = last_version;
+template <class OBJ, class COMPARE, class SLOTS>
+pds::fpSet<OBJ, COMPARE, SLOTS>::fpSet(std::pmr::memory_resource* resource, COMPARE compare)
+
+    : arena(resource), root(1, resource, arena.counters()), last_version(1), compare(std::move(compare)) {
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+pds::fpSet<OBJ, COMPARE, SLOTS>::fpSet(fpSet&& other)
+
+    : arena(std::move(other.arena)), root(std::move(other.root)), last_version(other.last_version.load()),
+      retired_versions(other.retired_versions), nodes_made(other.nodes_made), log(std::exchange(other.log, nullptr)),
+      compare(std::move(other.compare)) {
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+pds::fpSet<OBJ, COMPARE, SLOTS>& pds::fpSet<OBJ, COMPARE, SLOTS>::operator=(fpSet&& other){
+
+    // The root first, while the counters of both arenas live:
+    root = std::move(other.root);
+    arena = std::move(other.arena);
+    last_version = other.last_version.load();
+    retired_versions = other.retired_versions;
+    nodes_made = other.nodes_made;
+    log = std::exchange(other.log, nullptr);
+    compare = std::move(other.compare);
+
+    return *this;
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+template <class ForwardIt>
+pds::fpSet<OBJ, COMPARE, SLOTS> pds::fpSet<OBJ, COMPARE, SLOTS>::from_sorted(ForwardIt first, ForwardIt last,
+                                                                              std::pmr::memory_resource* resource, COMPARE compare){
+
+    fpSet fps(resource, std::move(compare));
+
+    pds::version_t new_version = fps.last_version + 1;
+    std::size_t n = std::distance(first, last);
+
+    // The breadth-first index of a node is less than 2n, the priorities are spread over 
+    // all the range so later insertions can still get above the loaded nodes.
+    std::uint64_t step = n == 0 ? 0 : std::numeric_limits<std::uint64_t>::max() / (2 * n);
+    const OBJ* prev = nullptr;
+
+    pds::fpFatNode<OBJ, SLOTS>* top = fps.build_sorted(first, n, 0, step, prev, new_version);
+
+    fps.root.slot(MasterVersion) = {top, n};
+    fps.root.slot(new_version) = {top, n};
+
+    fps.nodes_made = n;
+    fps.last_version = new_version;
+
+    return fps;
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+template <class ForwardIt>
+pds::fpFatNode<OBJ, SLOTS>* pds::fpSet<OBJ, COMPARE, SLOTS>::build_sorted(ForwardIt& it, std::size_t n, std::size_t index, 
+    std::uint64_t step, const OBJ*& prev, pds::version_t new_version){
+
+    if(n == 0)
+        return nullptr;
+
+    std::size_t left_n = n / 2;
+
+    pds::fpFatNode<OBJ, SLOTS>* left = build_sorted(it, left_n, 2 * index + 1, step, prev, new_version);
+
+    if(prev != nullptr && !compare(*prev, *it))
+        throw pds::ObjectsNotSorted("fpSet::from_sorted: the objects are not strictly increasing");
+
+    pds::fpFatNode<OBJ, SLOTS>* node = arena.make(*it, new_version, 
+        std::numeric_limits<std::uint64_t>::max() - index * step);
+    ++it;
+    prev = &node->get_obj();
+
+    pds::fpFatNode<OBJ, SLOTS>* right = build_sorted(it, n - left_n - 1, 2 * index + 2, step, prev, new_version);
+
+    node->left.slot(MasterVersion) = {left, left_n};
+    node->left.slot(new_version) = {left, left_n};
+    node->right.slot(MasterVersion) = {right, n - left_n - 1};
+    node->right.slot(new_version) = {right, n - left_n - 1};
+
+    return node;
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+template <class CODEC>
+void pds::fpSet<OBJ, COMPARE, SLOTS>::save(std::ostream& out, CODEC codec){
+
+    // The bytes go through a checksum on their way to 'out', and the checksum is written after them.
+    pds::fpChecksumBuf buf(out.rdbuf());
+    std::ostream summed(&buf);
+
+    using node_ptr = pds::fpFatNode<OBJ, SLOTS>*;
+    using number = pds::fpVarint;
+
+    // The nodes are written by their position, and the slots point to the positions (0 is null).
+    std::vector<node_ptr> nodes;
+    std::unordered_map<node_ptr, std::uint64_t> ids;
+
+    nodes.reserve(arena.size());
+    ids.reserve(arena.size());
+
+    arena.for_each([&](node_ptr node){ 
+        nodes.push_back(node); 
+        ids.emplace(node, nodes.size());
+    });
+
+    auto id = [&ids](node_ptr node){ return node == nullptr ? 0 : ids.at(node); };
+
+    // The versions of a table are increasing and a slot is not newer than its version, 
+    // so both are written as the distance from the previous version.
+    auto save_table = [&](pds::fpFatNodePtr<OBJ, SLOTS>& table){
+
+        pds::version_t prev = MasterVersion;
+        number::write(summed, table.versions());
+
+        table.for_each([&](pds::version_t version, pds::version_t slot, const pds::fpChild<OBJ, SLOTS>& child){
+            number::write(summed, version - prev);
+            number::write(summed, version - slot);
+            number::write(summed, id(child.node));
+            number::write(summed, child.size);
+            prev = version;
+        });
+    };
+
+    pds::fpCodec<std::uint64_t>::write(summed, snapshot_magic);
+    number::write(summed, last_version);
+    number::write(summed, retired_versions);
+    number::write(summed, nodes_made);
+    number::write(summed, nodes.size());
+
+    for(node_ptr node : nodes){
+
+        codec.write(summed, node->get_obj());
+        pds::fpCodec<std::uint64_t>::write(summed, node->get_priority());
+        number::write(summed, id(node->next));
+    }
+
+    for(node_ptr node : nodes){
+
+        save_table(node->left);
+        save_table(node->right);
+    }
+    save_table(root);
+
+    if(summed)
+        pds::fpCodec<std::uint32_t>::write(out, buf.sum.hash);
+
+    if(!summed || !out)
+        throw std::ios_base::failure("fpSet::save: writing the snapshot failed");
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+template <class CODEC>
+pds::fpSet<OBJ, COMPARE, SLOTS> pds::fpSet<OBJ, COMPARE, SLOTS>::load(std::istream& in, CODEC codec,
+                                                                       std::pmr::memory_resource* resource, COMPARE compare){
+
+    // Every byte of the snapshot is summed on its way from 'in', and the sum is checked at the end.
+    pds::fpChecksumBuf buf(in.rdbuf());
+    std::istream summed(&buf);
+
+    using node_ptr = pds::fpFatNode<OBJ, SLOTS>*;
+
+    auto check = [&summed](){
+
+        if(!summed)
+            throw pds::CorruptedSnapshot("fpSet::load: the snapshot ends too early");
+    };
+
+    auto read = [&summed, &check](){
+
+        std::uint64_t value = pds::fpVarint::read(summed);
+        check();
+        return value;
+    };
+
+    if(pds::fpCodec<std::uint64_t>::read(summed) != snapshot_magic || !summed)
+        throw pds::CorruptedSnapshot("fpSet::load: the stream does not hold an fpSet snapshot");
+
+    fpSet fps(resource, std::move(compare));
+    fps.last_version = read();
+    fps.retired_versions = read();
+    fps.nodes_made = read();
+
+    std::vector<node_ptr> nodes;
+    std::vector<std::uint64_t> next;
+
+    for(std::uint64_t n = read(); nodes.size() < n; ){
+
+        OBJ obj = codec.read(summed);
+        std::uint64_t priority = pds::fpCodec<std::uint64_t>::read(summed);
+        check();
+        next.push_back(read());
+
+        // The slots are read after all the nodes exist, so they start with no version.
+        nodes.push_back(fps.arena.make(std::move(obj), MasterVersion, priority));
+    }
+
+    auto node = [&nodes](std::uint64_t id) -> node_ptr {
+
+        if(id > nodes.size())
+            throw pds::CorruptedSnapshot("fpSet::load: a slot points to node " + std::to_string(id) 
+                + " of " + std::to_string(nodes.size()));
+
+        return id == 0 ? nullptr : nodes[id - 1];
+    };
+
+    auto load_table = [&](pds::fpFatNodePtr<OBJ, SLOTS>& table){
+
+        bool master = false;
+        pds::version_t version = MasterVersion;
+        std::uint64_t count = read();
+
+        for(std::uint64_t i = 0; i < count; ++i){
+
+            std::uint64_t step = read();
+            std::uint64_t back = read();
+            pds::fpChild<OBJ, SLOTS> child{node(read()), read()};
+
+            // The versions of a table are increasing, and a new slot is only appended.
+            if((i > 0 && step == 0) || step > fps.last_version - version || back > version + step)
+                throw pds::CorruptedSnapshot("fpSet::load: a slot of version " + std::to_string(version + step) 
+                    + " is out of order");
+
+            version += step;
+
+            if(back == 0)
+                table.slot(version) = child;
+            else
+                table.adopt(version, version - back, child);
+
+            master = master || version == MasterVersion;
+        }
+
+        if(!master)
+            table.retain_if([](pds::version_t v){ return v != MasterVersion; });
+    };
+
+    for(std::size_t i = 0; i < nodes.size(); ++i){
+
+        nodes[i]->next = node(next[i]);
+    }
+
+    for(node_ptr n : nodes){
+
+        load_table(n->left);
+        load_table(n->right);
+    }
+
+    fps.root = pds::fpFatNodePtr<OBJ, SLOTS>(MasterVersion, resource, fps.arena.counters());
+    load_table(fps.root);
+
+    // Read from 'in' itself, so it is not summed:
+    std::uint32_t sum = pds::fpCodec<std::uint32_t>::read(in);
+
+    if(!in || sum != buf.sum.hash)
+        throw pds::CorruptedSnapshot("fpSet::load: the checksum of the snapshot does not match its bytes");
+
+    return fps;
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+void pds::fpSet<OBJ, COMPARE, SLOTS>::freeze(std::ostream& out){
+
+    static_assert(std::is_trivially_copyable_v<OBJ>, "fpSet::freeze: OBJ must be trivially copyable");
+
+    using node_ptr = pds::fpFatNode<OBJ, SLOTS>*;
+    using Node = pds::fpImageNode<OBJ>;
+
+    std::vector<node_ptr> nodes;
+    std::unordered_map<node_ptr, std::uint64_t> ids;
+
+    nodes.reserve(arena.size());
+    ids.reserve(arena.size());
+
+    arena.for_each([&](node_ptr node){ 
+        nodes.push_back(node); 
+        ids.emplace(node, nodes.size());
+    });
+
+    // The fat pointers are laid out in the order of the nodes, so their ranges are known before writing them.
+    std::vector<Node> frozen;
+    frozen.reserve(nodes.size());
+
+    std::uint64_t entries = 0;
+
+    for(node_ptr node : nodes){
+
+        std::uint64_t left = entries;
+        std::uint64_t right = left + node->left.versions();
+        entries = right + node->right.versions();
+
+        frozen.push_back(Node{left, right, right, entries, node->get_obj()});
+    }
+
+    pds::fpImageHeader header{};
+    header.magic = image_magic;
+    header.obj_size = sizeof(OBJ);
+    header.last_version = last_version;
+    header.nodes = nodes.size();
+    header.entries = entries + root.versions();
+    header.nodes_offset = pds::image_align<Node>(sizeof(header));
+    header.entries_offset = pds::image_align<pds::fpImageEntry>(header.nodes_offset + nodes.size() * sizeof(Node));
+    header.root_begin = entries;
+    header.root_end = header.entries;
+
+    auto pad = [&out](std::uint64_t from, std::uint64_t to){
+        
+        for(; from < to; ++from)
+            out.put(0);
+    };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    pad(sizeof(header), header.nodes_offset);
+
+    out.write(reinterpret_cast<const char*>(frozen.data()), frozen.size() * sizeof(Node));
+    pad(header.nodes_offset + frozen.size() * sizeof(Node), header.entries_offset);
+
+    auto write_table = [&](pds::fpFatNodePtr<OBJ, SLOTS>& table){
+
+        table.for_each([&](pds::version_t version, pds::version_t slot, const pds::fpChild<OBJ, SLOTS>& child){
+
+            pds::fpImageEntry entry{version, slot, child.node == nullptr ? 0 : ids.at(child.node), child.size};
+            out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        });
+    };
+
+    for(node_ptr node : nodes){
+
+        write_table(node->left);
+        write_table(node->right);
+    }
+    write_table(root);
+
+    if(!out)
+        throw std::ios_base::failure("fpSet::freeze: writing the image failed");
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+void pds::fpSet<OBJ, COMPARE, SLOTS>::set_log(pds::fpLogSink<OBJ>* sink) noexcept {
+
+    log = sink;
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+pds::version_t pds::fpSet<OBJ, COMPARE, SLOTS>::insert(const OBJ& obj, pds::version_t version){
+
+    return insert_impl(obj, version);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+pds::version_t pds::fpSet<OBJ, COMPARE, SLOTS>::insert(OBJ&& obj, pds::version_t version){
+
+    return insert_impl(std::move(obj), version);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+template <typename T>
+pds::version_t pds::fpSet<OBJ, COMPARE, SLOTS>::insert_impl(T&& obj, pds::version_t version){
+
+    if(version == default_version)
+        version = last_version;
 
     if(version == MasterVersion)
         throw pds::VersionZeroIllegal("Version 0 is not valid for insert");
 
-    PDS_THROW_IF_VERSION_NOT_EXIST("fpSet::insert_impl", version, last_version);
+    check_version("fpSet::insert", version);
 
-    if(contains(obj, version))
+    if(contains_unchecked(obj, version))
         throw pds::ObjectAlreadyExist(
                 "fpSet::insert: Version " + std::to_string(version) + " already contains this object" 
             );
 
     pds::version_t new_version = last_version + 1;
 
-    pds::fpSetTracker<OBJ> tracker(root, version);
+    pds::fpFatNode<OBJ, SLOTS>* node = master_node(std::forward<T>(obj), new_version);
 
     // Inserting a new version to the tree:
-    while(tracker.not_null()){
+    pds::fpTreap<OBJ, SLOTS, COMPARE> treap(arena, new_version, compare);
+    treap.set_root(root, treap.insert(treap.at(root, version), node));
 
-        tracker[new_version] = *tracker;
+    // Logged once it is built, so a failed update is not logged, and before the readers can see it:
+    if(log != nullptr)
+        log->log_update(pds::fpOp::insert, node->get_obj(), version, new_version);
 
-        if(obj < tracker.obj()){
+    return (last_version = new_version);
+}
 
-            tracker.add_right_map(new_version);
-            tracker = tracker.left();
-        }
-        else{
-            tracker.add_left_map(new_version);
-            tracker = tracker.right();
-        }
-    }
 
-    pds::fpSetTracker<OBJ> track_master(root, MasterVersion);
+template <class OBJ, class COMPARE, class SLOTS>
+template <typename T>
+pds::fpFatNode<OBJ, SLOTS>* pds::fpSet<OBJ, COMPARE, SLOTS>::master_node(T&& obj, pds::version_t new_version){
+
+    pds::fpSetTracker<OBJ, SLOTS, false> track_master(root, MasterVersion);
 
     while(track_master.not_null()){
 
-        if(obj < track_master.obj()){
+        if(compare(obj, track_master.obj())){
 
             track_master = track_master.left();
         }
-        else if(track_master.obj() < obj){
+        else if(compare(track_master.obj(), obj)){
 
             track_master = track_master.right();
         }
-        else{
-            tracker[new_version] = *track_master;
-            tracker.set_left_at(new_version) = nullptr;
-            tracker.set_right_at(new_version) = nullptr;
-            break;
-        }
+        else break;
     }
 
-    if(track_master.null()){
+    pds::fpFatNode<OBJ, SLOTS>* node = *track_master;
 
-        track_master[MasterVersion] = std::make_shared<pds::fpFatNode<OBJ>>(std::forward<T>(obj), new_version);
+    if(node == nullptr){
 
-        ++sizes[MasterVersion];
-        tracker[new_version] = *track_master;
-    }
-
-    // push the size of the new version
-    sizes.push_back(sizes[version] + 1);
+        node = arena.make(
+            std::forward<T>(obj), new_version, pds::fpTreap<OBJ, SLOTS, COMPARE>::priority(nodes_made++)
+        );
 
-    return (last_version = new_version);
+        pds::fpTreap<OBJ, SLOTS, COMPARE> master(arena, MasterVersion, compare);
+        master.set_root(root, master.insert(master.at(root, MasterVersion), node));
+    }
+    return node;
 }
 
 
-template <class OBJ>
-pds::version_t pds::fpSet<OBJ>::remove(const OBJ& obj, pds::version_t version){
+template <class OBJ, class COMPARE, class SLOTS>
+pds::version_t pds::fpSet<OBJ, COMPARE, SLOTS>::remove(const OBJ& obj, pds::version_t version){
 
     if(version == default_version)
         version = last_version;
@@ -381,9 +1278,9 @@ pds::version_t pds::fpSet<OBJ>::remove(const OBJ& obj, pds::version_t version){
     if(version == MasterVersion)
         throw pds::VersionZeroIllegal("Version 0 is not valid for remove");
 
-    PDS_THROW_IF_VERSION_NOT_EXIST("fpSet::remove", version, last_version);
+    check_version("fpSet::remove", version);
 
-    if(!contains(obj, version))
+    if(!contains_unchecked(obj, version))
         throw pds::ObjectNotExist(
             "pds::fpSet::remove: Attempting to remove an object from Version "
             + std::to_string(version) + ". But the object is not exists for this Version" 
@@ -391,131 +1288,366 @@ pds::version_t pds::fpSet<OBJ>::remove(const OBJ& obj, pds::version_t version){
 
 
     pds::version_t new_version = last_version + 1;
-    pds::fpSetTracker<OBJ> tracker(root, version);
 
-    // Inserting a new version to the tree:
-    while(tracker.not_null()){
+    pds::fpTreap<OBJ, SLOTS, COMPARE> treap(arena, new_version, compare);
+    treap.set_root(root, treap.erase(treap.at(root, version), obj));
 
-        if(obj < tracker.obj()){
+    if(log != nullptr)
+        log->log_update(pds::fpOp::remove, obj, version, new_version);
 
-            tracker[new_version] = *tracker;
-            tracker.add_right_map(new_version);
-            tracker = tracker.left();
-        }
-        else if(tracker.obj() < obj){
+    return (last_version = new_version);
+}
 
-            tracker[new_version] = *tracker;
-            tracker.add_left_map(new_version);
-            tracker = tracker.right();
-        }
-        else break;
-    }
 
-    pds::fpSetTracker<OBJ> to_remove = tracker;
+template <class OBJ, class COMPARE, class SLOTS>
+pds::version_t pds::fpSet<OBJ, COMPARE, SLOTS>::remove(OBJ&& obj, pds::version_t version){
 
-    if(to_remove.left_null() && to_remove.right_null()){
+    return remove(std::as_const(obj), version);
+}
 
-        to_remove[new_version] = nullptr;
-    }
-    else if(to_remove.left_null() || to_remove.right_null()){
 
-        if(to_remove.left_null())
-            tracker = tracker.right();
-        else
-            tracker = tracker.left();
+template <class OBJ, class COMPARE, class SLOTS>
+pds::version_t pds::fpSet<OBJ, COMPARE, SLOTS>::apply(std::vector<pds::fpBatchOp<OBJ>> batch, pds::version_t version){
+
+    if(version == default_version)
+        version = last_version;
+
+    if(version == MasterVersion)
+        throw pds::VersionZeroIllegal("Version 0 is not valid for apply");
+
+    check_version("fpSet::apply", version);
+
+    std::sort(batch.begin(), batch.end(), 
+        [this](const pds::fpBatchOp<OBJ>& a, const pds::fpBatchOp<OBJ>& b){ return compare(a.obj, b.obj); });
+
+    // Validate the whole batch before writing anything:
+    for(std::size_t i = 0; i < batch.size(); ++i){
+
+        if(i > 0 && !compare(batch[i - 1].obj, batch[i].obj))
+            throw pds::ObjectAlreadyExist("fpSet::apply: the batch contains the same object twice");
+
+        bool exist = contains_unchecked(batch[i].obj, version);
 
-        to_remove[new_version] = *tracker;
-        to_remove.add_left_map(new_version);
-        to_remove.add_right_map(new_version);
+        if(batch[i].op == pds::fpOp::insert && exist)
+            throw pds::ObjectAlreadyExist(
+                "fpSet::apply: Version " + std::to_string(version) + " already contains an inserted object"
+            );
+
+        if(batch[i].op == pds::fpOp::remove && !exist)
+            throw pds::ObjectNotExist(
+                "fpSet::apply: Version " + std::to_string(version) + " not contains a removed object"
+            );
     }
-    else{
-        pds::fpSetTracker<OBJ> track_to_leaf = tracker;
-        track_to_leaf = track_to_leaf.right();
 
-        if(track_to_leaf.left_null()){
+    pds::version_t new_version = last_version + 1;
 
-            to_remove[new_version] = *track_to_leaf;
-            track_to_leaf.add_left_map(new_version);
-            track_to_leaf.add_right_map(new_version);
+    // All the operations write to the slots of 'new_version', 
+    // so a node on the paths of several operations is copied only once:
+    pds::fpTreap<OBJ, SLOTS, COMPARE> treap(arena, new_version, compare);
+    auto t = treap.at(root, version);
 
-            tracker = tracker.left();
-            to_remove.set_left_at(new_version) = *tracker;
-            tracker.add_left_map(new_version);
-            tracker.add_right_map(new_version);
+    for(pds::fpBatchOp<OBJ>& op : batch){
+
+        if(op.op == pds::fpOp::insert){
+
+            // The batch is logged after it is applied, so its objects are moved only if there is no log:
+            pds::fpFatNode<OBJ, SLOTS>* node = log != nullptr 
+                ? master_node(std::as_const(op.obj), new_version) : master_node(std::move(op.obj), new_version);
+
+            t = treap.insert(t, node);
         }
         else{
+            t = treap.erase(t, op.obj);
+        }
+    }
+    treap.set_root(root, t);
 
-/***************  ILLUSTRATION  **************************
+    if(log != nullptr)
+        log->log_apply(batch, version, new_version);
 
-          +++ version +++    |   +++ new_version +++
-                             |
-      to_remove:[6]          |           [11]
-               /   \        ==>>        /   \
-            [4]     [16]     |       [4]     [16]
-                   /         |              /
-               [11]          |          [13]
-                   \         |
-                    [13]     |
+    return (last_version = new_version);
+}
 
-***********************************************************/
 
-            while(track_to_leaf.left_not_null()){
+template <class OBJ, class COMPARE, class SLOTS>
+template <class OP>
+pds::version_t pds::fpSet<OBJ, COMPARE, SLOTS>::combine(pds::version_t v1, pds::version_t v2, const char* func_name, 
+    pds::fpLogOp log_op, OP&& op){
 
-                track_to_leaf[new_version] = *track_to_leaf;
-                track_to_leaf.add_right_map(new_version);
-                track_to_leaf = track_to_leaf.left();
-            }
-            to_remove[new_version] = *track_to_leaf;
+    // MasterVersion is changed in place, so a new version must not share its subtrees.
+    if(v1 == MasterVersion || v2 == MasterVersion)
+        throw pds::VersionZeroIllegal("Version 0 is not valid for " + std::string(func_name));
 
-            if(track_to_leaf.right_not_null()){
+    check_version(func_name, v1);
+    check_version(func_name, v2);
 
-                track_to_leaf[new_version] = track_to_leaf.get_right();
-                track_to_leaf.add_left_map(new_version);
+    pds::version_t new_version = last_version + 1;
 
-                track_to_leaf = track_to_leaf.right();
-                track_to_leaf.add_left_map(new_version);
-                track_to_leaf.add_right_map(new_version);
-            }
-            else{
-                track_to_leaf[new_version] = nullptr;
+    pds::fpTreap<OBJ, SLOTS, COMPARE> treap(arena, new_version, compare);
+    View t = op(treap, treap.at(root, v1), treap.at(root, v2));
+    treap.set_root(root, t);
+
+    if(log != nullptr)
+        log->log_combine(log_op, v1, v2, new_version);
+
+    return (last_version = new_version);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+pds::version_t pds::fpSet<OBJ, COMPARE, SLOTS>::merge_union(pds::version_t v1, pds::version_t v2){
+
+    return combine(v1, v2, "fpSet::merge_union", pds::fpLogOp::merge_union, 
+        [](pds::fpTreap<OBJ, SLOTS, COMPARE>& treap, const View& x, const View& y){ return treap.unite(x, y); });
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+pds::version_t pds::fpSet<OBJ, COMPARE, SLOTS>::intersect(pds::version_t v1, pds::version_t v2){
+
+    return combine(v1, v2, "fpSet::intersect", pds::fpLogOp::intersect, 
+        [](pds::fpTreap<OBJ, SLOTS, COMPARE>& treap, const View& x, const View& y){ return treap.intersect(x, y); });
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+pds::version_t pds::fpSet<OBJ, COMPARE, SLOTS>::subtract(pds::version_t v1, pds::version_t v2){
+
+    return combine(v1, v2, "fpSet::subtract", pds::fpLogOp::subtract, 
+        [](pds::fpTreap<OBJ, SLOTS, COMPARE>& treap, const View& x, const View& y){ return treap.subtract(x, y); });
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+void pds::fpSet<OBJ, COMPARE, SLOTS>::retire(pds::version_t version){
+
+    if(version == MasterVersion)
+        throw pds::VersionZeroIllegal("Version 0 is not valid for retire");
+
+    check_version("fpSet::retire", version);
+
+    retain_only([version](pds::version_t v){ return v != version; });
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+template <class PRED>
+std::size_t pds::fpSet<OBJ, COMPARE, SLOTS>::retain_only(PRED&& keep){
+
+    std::vector<bool> live(last_version + 1, false);
+    std::size_t retired = 0;
+
+    live[MasterVersion] = true;
+
+    for(pds::version_t v = 1; v <= last_version; ++v){
+
+        pds::version_t slot;
+
+        if(root.resolve(v, slot) == nullptr)
+            continue;
+
+        live[v] = keep(v);
+        retired += !live[v];
+    }
+
+    if(retired > 0){
+
+        if(log != nullptr){
+
+            std::vector<pds::version_t> versions;
+            versions.reserve(retired);
+
+            for(pds::version_t v = 1; v < live.size(); ++v){
+
+                pds::version_t slot;
+
+                if(!live[v] && root.resolve(v, slot) != nullptr)
+                    versions.push_back(v);
             }
+            log->log_retire(versions);
+        }
+        collect(live);
+        retired_versions += retired;
+    }
+    return retired;
+}
 
-            to_remove.set_right_at(new_version) = tracker.get_right();
-            to_remove.set_left_at(new_version) = tracker.get_left();
-            tracker = tracker.left();
-            tracker.add_left_map(new_version);
-            tracker.add_right_map(new_version);
+
+template <class OBJ, class COMPARE, class SLOTS>
+void pds::fpSet<OBJ, COMPARE, SLOTS>::collect(const std::vector<bool>& live){
+
+    using node_ptr = pds::fpFatNode<OBJ, SLOTS>*;
+    using treap = pds::fpTreap<OBJ, SLOTS, COMPARE>;
+
+    // The keys that index the children of every reached node. 
+    // A View that was already reached is not walked again, so shared subtrees are walked once.
+    std::unordered_map<node_ptr, std::unordered_set<pds::version_t>> keys;
+
+    auto mark = [&keys](auto& self, const View& t) -> void {
+
+        if(t.node == nullptr || !keys[t.node].insert(t.key).second)
+            return;
+
+        self(self, treap::left(t));
+        self(self, treap::right(t));
+    };
+
+    for(pds::version_t v = 1; v < live.size(); ++v){
+
+        if(live[v])
+            mark(mark, treap::at(root, v));
+    }
+
+    // A live object may be reached only through copies of its master node, so the objects are compared.
+    std::vector<const OBJ*> objs;
+    objs.reserve(keys.size());
+
+    for(const auto& [node, node_keys] : keys)
+        objs.push_back(&node->get_obj());
+
+    std::sort(objs.begin(), objs.end(), [this](const OBJ* a, const OBJ* b){ return compare(*a, *b); });
+
+    std::vector<node_ptr> kept;
+    auto live_obj = objs.begin();
+
+    auto walk = [&](auto& self, const View& t) -> void {
+
+        if(t.node == nullptr)
+            return;
+
+        self(self, treap::left(t));
+
+        while(live_obj != objs.end() && compare(**live_obj, t.node->get_obj()))
+            ++live_obj;
+
+        if(live_obj != objs.end() && !compare(t.node->get_obj(), **live_obj))
+            kept.push_back(t.node);
+
+        self(self, treap::right(t));
+    };
+    walk(walk, treap::at(root, MasterVersion));
+
+    /*
+        Rebuild the master tree from its kept nodes in O(K), instead of removing the dead ones:
+        the shape of a treap is determined by its priorities, so the tree of the kept nodes is 
+        built like a Cartesian tree, and the parents are linked after their children.
+    */
+    std::vector<std::size_t> left(kept.size(), kept.size()), right(kept.size(), kept.size());
+    std::vector<std::size_t> path;
+
+    for(std::size_t i = 0; i < kept.size(); ++i){
+
+        std::size_t last = kept.size();
+
+        while(!path.empty() && kept[path.back()]->get_priority() < kept[i]->get_priority()){
+
+            last = path.back();
+            path.pop_back();
         }
+        left[i] = last;
+
+        if(!path.empty())
+            right[path.back()] = i;
+
+        path.push_back(i);
     }
 
-    // push the size of the new version
-    sizes.push_back(sizes[version] - 1);
+    auto link = [&](auto& self, std::size_t i) -> pds::fpChild<OBJ, SLOTS> {
 
-    return (last_version = new_version);
+        if(i == kept.size())
+            return {};
+
+        pds::fpChild<OBJ, SLOTS> l = self(self, left[i]);
+        pds::fpChild<OBJ, SLOTS> r = self(self, right[i]);
+
+        kept[i]->left.slot(MasterVersion) = l;
+        kept[i]->right.slot(MasterVersion) = r;
+
+        return {kept[i], l.size + r.size + 1};
+    };
+    root.slot(MasterVersion) = link(link, path.empty() ? kept.size() : path.front());
+
+    mark(mark, treap::at(root, MasterVersion));
+
+    // Drop the slots that no live version looks up, and the nodes that no live version reaches:
+    root.retain_if([&live](pds::version_t v){ return v < live.size() && live[v]; });
+
+    for(auto& [node, node_keys] : keys){
+
+        auto reached = [&node_keys](pds::version_t v){ return node_keys.contains(v); };
+
+        node->left.retain_if(reached);
+        node->right.retain_if(reached);
+
+        if(node->next != nullptr && !keys.contains(node->next))
+            node->next = nullptr;
+    }
+
+    arena.release_if([&keys](node_ptr node){ return !keys.contains(node); });
 }
 
 
-template <class OBJ>
-pds::version_t pds::fpSet<OBJ>::remove(OBJ&& obj, pds::version_t version){
+template <class OBJ, class COMPARE, class SLOTS>
+void pds::fpSet<OBJ, COMPARE, SLOTS>::check_version(const char* func_name, pds::version_t version){
 
-    return remove(std::as_const(obj), version);
+    PDS_THROW_IF_VERSION_NOT_EXIST(func_name, version, last_version);
+
+    pds::version_t slot;
+
+    if(retired_versions > 0 && root.resolve(version, slot) == nullptr)
+        throw pds::VersionNotExist(
+            std::string(func_name) + ": Version " + std::to_string(version) + " was retired"
+        );
 }
 
 
-template <class OBJ>
-bool pds::fpSet<OBJ>::contains(const OBJ& obj, pds::version_t version){
+template <class OBJ, class COMPARE, class SLOTS>
+bool pds::fpSet<OBJ, COMPARE, SLOTS>::contains(const OBJ& obj, pds::version_t version){
+
+    check_version("fpSet::contains", version);
+
+    return contains_unchecked(obj, version);
+}
+
 
-    PDS_THROW_IF_VERSION_NOT_EXIST("fpSet::contains", version, last_version);
+template <class OBJ, class COMPARE, class SLOTS>
+template <class KEY> requires pds::fpTransparent<COMPARE>
+bool pds::fpSet<OBJ, COMPARE, SLOTS>::contains(const KEY& key, pds::version_t version){
 
-    pds::fpSetTracker<OBJ> tracker(root, version);
+    check_version("fpSet::contains", version);
+
+    return find_unchecked(key, version);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+bool pds::fpSet<OBJ, COMPARE, SLOTS>::contains_unchecked(const OBJ& obj, pds::version_t version){
+
+    return find_unchecked(obj, version);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+template <class KEY> requires pds::fpTransparent<COMPARE>
+bool pds::fpSet<OBJ, COMPARE, SLOTS>::contains_unchecked(const KEY& key, pds::version_t version){
+
+    return find_unchecked(key, version);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+template <class KEY>
+bool pds::fpSet<OBJ, COMPARE, SLOTS>::find_unchecked(const KEY& key, pds::version_t version){
+
+    pds::fpSetTracker<OBJ, SLOTS, false> tracker(root, version);
 
     while(tracker.not_null()){
 
-        if(obj < tracker.obj()){
+        if(compare(key, tracker.obj())){
 
             tracker = tracker.left();
         }
-        else if(tracker.obj() < obj){
+        else if(compare(tracker.obj(), key)){
 
             tracker = tracker.right();
         }
@@ -525,58 +1657,299 @@ bool pds::fpSet<OBJ>::contains(const OBJ& obj, pds::version_t version){
 }
 
 
-template <class OBJ>
-std::vector<OBJ> pds::fpSet<OBJ>::to_vector(const pds::version_t version) {
+template <class OBJ, class COMPARE, class SLOTS>
+std::size_t pds::fpSet<OBJ, COMPARE, SLOTS>::rank(const OBJ& obj, pds::version_t version){
 
-    PDS_THROW_IF_VERSION_NOT_EXIST("fpSet::to_vector", version, last_version);
+    check_version("fpSet::rank", version);
 
-    std::vector<OBJ> obj_vec;
+    std::size_t less = 0;
+    pds::fpSetTracker<OBJ, SLOTS, false> tracker(root, version);
 
-    /*** Inorder Stack Traversal ***/
-    std::stack<pds::fpSetTracker<OBJ>> trav_stack;
-    pds::fpSetTracker<OBJ> tracker(root, version);
+    while(tracker.not_null()){
 
-    while(tracker.not_null() || !trav_stack.empty()){
+        if(compare(tracker.obj(), obj)){
 
-        while(tracker.not_null()){
+            // the node and its left subtree are the part of the subtree that is not on the right.
+            std::size_t subtree = tracker.size();
+            tracker.right();
+            less += subtree - tracker.size();
+        }
+        else{
+            tracker.left();
+        }
+    }
+    return less;
+}
 
-            trav_stack.push(tracker);
-            tracker = tracker.left();
+
+template <class OBJ, class COMPARE, class SLOTS>
+const OBJ& pds::fpSet<OBJ, COMPARE, SLOTS>::select(std::size_t k, pds::version_t version){
+
+    check_version("fpSet::select", version);
+
+    if(k >= size(version))
+        throw pds::ObjectNotExist(
+            "fpSet::select: Version " + std::to_string(version) + " has only " 
+            + std::to_string(size(version)) + " objects"
+        );
+
+    pds::fpSetTracker<OBJ, SLOTS, false> tracker(root, version);
+
+    while(true){
+
+        std::size_t left = tracker.left_size();
+
+        if(k < left){
+
+            tracker.left();
         }
-        tracker = trav_stack.top();
-        trav_stack.pop();
+        else if(k == left){
 
-        obj_vec.push_back(tracker.obj());
-        tracker = tracker.right();
+            return tracker.obj();
+        }
+        else{
+            k -= left + 1;
+            tracker.right();
+        }
+    }
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+std::vector<OBJ> pds::fpSet<OBJ, COMPARE, SLOTS>::to_vector(const pds::version_t version) {
+
+    check_version("fpSet::to_vector", version);
+
+    std::vector<OBJ> obj_vec;
+    obj_vec.reserve(size(version));
+
+    for(iterator it = iterator::first(root, version); it != iterator(root, version); ++it){
+
+        obj_vec.push_back(*it);
     }
     return obj_vec;
 }
 
 
-template <class OBJ>
-pds::version_t pds::fpSet<OBJ>::size(pds::version_t version) const noexcept {
+template <class OBJ, class COMPARE, class SLOTS>
+pds::fpDiff<OBJ> pds::fpSet<OBJ, COMPARE, SLOTS>::diff(pds::version_t a, pds::version_t b){
+
+    check_version("fpSet::diff", a);
+    check_version("fpSet::diff", b);
+
+    pds::fpDiff<OBJ> changes;
+
+    diff_views(pds::fpTreap<OBJ, SLOTS, COMPARE>::at(root, a), pds::fpTreap<OBJ, SLOTS, COMPARE>::at(root, b), nullptr, nullptr, changes);
+
+    return changes;
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+void pds::fpSet<OBJ, COMPARE, SLOTS>::diff_views(View x, View y, const OBJ* lo, const OBJ* hi, pds::fpDiff<OBJ>& changes) const {
+
+    using treap = pds::fpTreap<OBJ, SLOTS, COMPARE>;
+
+    if(x == y)
+        return;
+
+    treap::narrow(x, lo, hi, compare);
+    treap::narrow(y, lo, hi, compare);
 
-    try{
-        return sizes.at(version);
+    if(x == y)
+        return;
+
+    if(x.node == nullptr){
+
+        collect(y, lo, hi, changes.inserted);
+        return;
     }
-    catch(const std::out_of_range&){
+    if(y.node == nullptr){
 
-        return 0;
+        collect(x, lo, hi, changes.removed);
+        return;
+    }
+
+    if(x.node == y.node){
+
+        const OBJ* obj = &x.node->get_obj();
+
+        diff_views(treap::left(x), treap::left(y), lo, obj, changes);
+        diff_views(treap::right(x), treap::right(y), obj, hi, changes);
+        return;
     }
+
+    /*
+        Split both sides by the root with the higher priority.
+        Every version is a treap of the same fixed priorities, so that root can not be 
+        anywhere in the other side, whose root has a lower priority.
+    */
+    bool split_x = y.node->get_priority() <= x.node->get_priority();
+    const View& pivot = split_x ? x : y;
+    const View& other = split_x ? y : x;
+    const OBJ* obj = &pivot.node->get_obj();
+
+    bool in_other = pivot.node->get_priority() == other.node->get_priority() && treap::contains(other, *obj, compare);
+
+    diff_views(split_x ? treap::left(x) : x, split_x ? y : treap::left(y), lo, obj, changes);
+
+    if(!in_other)
+        (split_x ? changes.removed : changes.inserted).push_back(*obj);
+
+    diff_views(split_x ? treap::right(x) : x, split_x ? y : treap::right(y), obj, hi, changes);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+void pds::fpSet<OBJ, COMPARE, SLOTS>::collect(const View& t, const OBJ* lo, const OBJ* hi, std::vector<OBJ>& out) const {
+
+    View in_range = t;
+    pds::fpTreap<OBJ, SLOTS, COMPARE>::narrow(in_range, lo, hi, compare);
+
+    if(in_range.node == nullptr)
+        return;
+
+    const OBJ* obj = &in_range.node->get_obj();
+
+    collect(pds::fpTreap<OBJ, SLOTS, COMPARE>::left(in_range), lo, obj, out);
+    out.push_back(*obj);
+    collect(pds::fpTreap<OBJ, SLOTS, COMPARE>::right(in_range), obj, hi, out);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+typename pds::fpSet<OBJ, COMPARE, SLOTS>::iterator pds::fpSet<OBJ, COMPARE, SLOTS>::begin(pds::version_t version){
+
+    check_version("fpSet::begin", version);
+
+    return iterator::first(root, version);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+typename pds::fpSet<OBJ, COMPARE, SLOTS>::iterator pds::fpSet<OBJ, COMPARE, SLOTS>::end(pds::version_t version){
+
+    check_version("fpSet::end", version);
+
+    return iterator(root, version);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+typename pds::fpSet<OBJ, COMPARE, SLOTS>::reverse_iterator pds::fpSet<OBJ, COMPARE, SLOTS>::rbegin(pds::version_t version){
+
+    return reverse_iterator(end(version));
 }
 
 
-template <class OBJ>
-pds::version_t pds::fpSet<OBJ>::curr_version() const noexcept {
+template <class OBJ, class COMPARE, class SLOTS>
+typename pds::fpSet<OBJ, COMPARE, SLOTS>::reverse_iterator pds::fpSet<OBJ, COMPARE, SLOTS>::rend(pds::version_t version){
+
+    return reverse_iterator(begin(version));
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+typename pds::fpSet<OBJ, COMPARE, SLOTS>::iterator pds::fpSet<OBJ, COMPARE, SLOTS>::lower_bound(const OBJ& obj, pds::version_t version){
+
+    check_version("fpSet::lower_bound", version);
+
+    return iterator::lower_bound(root, version, obj, compare);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+template <class KEY> requires pds::fpTransparent<COMPARE>
+typename pds::fpSet<OBJ, COMPARE, SLOTS>::iterator pds::fpSet<OBJ, COMPARE, SLOTS>::lower_bound(const KEY& key, pds::version_t version){
+
+    check_version("fpSet::lower_bound", version);
+
+    return iterator::lower_bound(root, version, key, compare);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+typename pds::fpSet<OBJ, COMPARE, SLOTS>::iterator pds::fpSet<OBJ, COMPARE, SLOTS>::upper_bound(const OBJ& obj, pds::version_t version){
+
+    check_version("fpSet::upper_bound", version);
+
+    return iterator::upper_bound(root, version, obj, compare);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+template <class KEY> requires pds::fpTransparent<COMPARE>
+typename pds::fpSet<OBJ, COMPARE, SLOTS>::iterator pds::fpSet<OBJ, COMPARE, SLOTS>::upper_bound(const KEY& key, pds::version_t version){
+
+    check_version("fpSet::upper_bound", version);
+
+    return iterator::upper_bound(root, version, key, compare);
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+std::ranges::subrange<typename pds::fpSet<OBJ, COMPARE, SLOTS>::iterator> 
+pds::fpSet<OBJ, COMPARE, SLOTS>::range(const OBJ& lo, const OBJ& hi, pds::version_t version){
+
+    check_version("fpSet::range", version);
+
+    if(!compare(lo, hi))
+        return {iterator(root, version), iterator(root, version)};
+
+    return {iterator::lower_bound(root, version, lo, compare), iterator::lower_bound(root, version, hi, compare)};
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+pds::version_t pds::fpSet<OBJ, COMPARE, SLOTS>::size(pds::version_t version) const noexcept {
+
+    if(version > last_version)
+        return 0;
+
+    pds::version_t slot;
+    const pds::fpChild<OBJ, SLOTS>* child = root.resolve(version, slot);
+
+    return child == nullptr ? 0 : child->size;
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+pds::version_t pds::fpSet<OBJ, COMPARE, SLOTS>::curr_version() const noexcept {
 
     return last_version;
 }
 
 
-template <class OBJ>
-void pds::fpSet<OBJ>::print(pds::version_t version){
+template <class OBJ, class COMPARE, class SLOTS>
+pds::fpMemoryStats pds::fpSet<OBJ, COMPARE, SLOTS>::memory_stats() const noexcept {
+
+    pds::fpMemoryStats stats;
+    const pds::fpMemoryCounters* counters = arena.counters();
+
+    stats.versions = last_version.load(std::memory_order_relaxed) - retired_versions;
+
+    // A set that was moved from holds nothing:
+    if(counters == nullptr)
+        return stats;
+
+    stats.nodes = counters->nodes.load(std::memory_order_relaxed);
+    stats.slots = counters->slots.load(std::memory_order_relaxed);
+    stats.object_bytes = stats.nodes * sizeof(OBJ);
+    stats.slot_bytes = counters->slot_bytes.load(std::memory_order_relaxed);
+    stats.index_bytes = counters->index_bytes.load(std::memory_order_relaxed);
+
+    // While a writer makes a block, its nodes may be counted before its bytes:
+    std::size_t arena_bytes = counters->node_bytes.load(std::memory_order_relaxed);
+    stats.node_bytes = std::max(arena_bytes, stats.object_bytes) - stats.object_bytes;
+
+    return stats;
+}
+
+
+template <class OBJ, class COMPARE, class SLOTS>
+void pds::fpSet<OBJ, COMPARE, SLOTS>::print(pds::version_t version){
 
-    PDS_THROW_IF_VERSION_NOT_EXIST("pset::print", version, last_version);
+    check_version("pset::print", version);
 
     std::vector<OBJ> vec = to_vector(version);
 
@@ -0,0 +1,378 @@
+/**
+ * @file fpSetImage.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief read-only fully persistent set, queried in place from a frozen image.
+ * @version 0.1
+ * @date 2025-01-14
+ */
+
+#ifndef FULLY_PERSISTENT_SET_IMAGE_HPP
+#define FULLY_PERSISTENT_SET_IMAGE_HPP
+
+#include "internal/fpImage.hpp"
+
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pds{
+
+    /**
+     * @class fpSetImage
+     * @brief The versions of a frozen fpSet (see @ref pds::fpSet::freeze), read where they are.
+     *
+     * @details Nothing is built when an image is opened: the file is mapped to memory and only its
+     *  header is checked, so opening costs the same for any size, and processes that map the same
+     *  file share its pages. Every query walks the nodes of the image like @ref pds::fpSet does
+     *  with pds::fpFlatSlots: one search in a sorted range of slots per level.
+     *
+     * @tparam OBJ the object type of the frozen fpSet. Must be trivially copyable.
+     * @tparam COMPARE the order of the frozen fpSet, see @ref pds::fpSet.
+     *
+     * @note Thread safety: an image is never changed, so any number of threads may query it.
+     *
+     * @example
+     * ```
+     * std::ofstream out("set.img", std::ios::binary);
+     * fps.freeze(out);
+     * out.close();
+     *
+     * pds::fpSetImage<int> image = pds::fpSetImage<int>::open("set.img");
+     * image.contains(5, 3);
+     * ```
+     */
+    template <class OBJ, class COMPARE = std::less<>>
+    class fpSetImage{
+
+        static_assert(std::is_trivially_copyable_v<OBJ>, "fpSetImage: OBJ must be trivially copyable");
+
+        using Node = pds::fpImageNode<OBJ>;
+
+        const char* data = nullptr;
+        std::size_t length = 0;
+        bool mapped = false;            ///< true if 'data' was mapped by open, and is unmapped by the destructor.
+
+        const pds::fpImageHeader* header = nullptr;
+        const Node* nodes = nullptr;
+        const pds::fpImageEntry* entries = nullptr;
+        [[no_unique_address]] COMPARE compare;    ///< the order of the frozen set.
+
+        /// @brief the entry of 'version' in the entries [begin, end), or nullptr.
+        const pds::fpImageEntry* find(std::uint64_t begin, std::uint64_t end, pds::version_t version) const;
+
+        /// @brief the node of a child index. throws pds::CorruptedSnapshot if it is out of the image.
+        const Node& node(std::uint64_t child) const;
+
+        /// @brief the root entry of 'version'. throws pds::VersionNotExist if there is no such version.
+        const pds::fpImageEntry& root_entry(pds::version_t version, const char* func_name) const;
+
+        /// @brief the entry of the subtree in the entries [begin, end) that is indexed by 'key'.
+        const pds::fpImageEntry& child_entry(std::uint64_t begin, std::uint64_t end, pds::version_t key) const;
+
+        void collect(const pds::fpImageEntry& entry, std::vector<OBJ>& out) const;
+
+    public:
+        /**
+         * @brief An image in memory, that must outlive it.
+         *
+         * @param data the first byte of the image. Must be aligned to 8 bytes (and to alignof(OBJ)).
+         * @param length the size of the image in bytes.
+         * @param compare the order of the frozen set. The image does not hold it, it must order
+         *  the objects like the comparator of the set.
+         *
+         * @exception
+         * - pds::CorruptedSnapshot
+         *      thrown if: the memory does not hold an image of OBJ.
+         */
+        fpSetImage(const void* data, std::size_t length, COMPARE compare = COMPARE());
+
+        /**
+         * @brief Maps an image file to memory (read only).
+         *
+         * @param compare the order of the frozen set, see @ref fpSetImage().
+         *
+         * @exception
+         * - std::system_error
+         *      thrown if: the file can not be opened or mapped.
+         *
+         * - pds::CorruptedSnapshot
+         *      thrown if: the file does not hold an image of OBJ.
+         *
+         * @note Time complexity: O(1), the pages are read from the file when they are queried.
+         */
+        static fpSetImage open(const std::string& path, COMPARE compare = COMPARE());
+
+        fpSetImage(const fpSetImage&) = delete;
+        fpSetImage& operator=(const fpSetImage&) = delete;
+        fpSetImage(fpSetImage&& other) noexcept;
+        fpSetImage& operator=(fpSetImage&& other) noexcept;
+        ~fpSetImage();
+
+        /**
+         * @brief Check if an object is in a specific version. see @ref pds::fpSet::contains.
+         *
+         * @exception
+         * - pds::VersionNotExist
+         *      thrown if: the frozen set has no such version.
+         */
+        bool contains(const OBJ& obj, pds::version_t version = MasterVersion) const;
+
+        /**
+         * @brief the objects of a version, sorted. see @ref pds::fpSet::to_vector.
+         *
+         * @exception
+         * - pds::VersionNotExist
+         *      thrown if: the frozen set has no such version.
+         */
+        std::vector<OBJ> to_vector(pds::version_t version = MasterVersion) const;
+
+        /// @brief size of 'version', or 0 if it not exists. see @ref pds::fpSet::size.
+        pds::version_t size(pds::version_t version = MasterVersion) const noexcept;
+
+        /// @brief the last version of the frozen set.
+        pds::version_t curr_version() const noexcept;
+    };
+};
+
+
+template <class OBJ, class COMPARE>
+pds::fpSetImage<OBJ, COMPARE>::fpSetImage(const void* data, std::size_t length, COMPARE compare)
+
+    : data(static_cast<const char*>(data)), length(length), compare(std::move(compare)) {
+
+    if(reinterpret_cast<std::uintptr_t>(data) % std::max(alignof(pds::fpImageHeader), alignof(Node)) != 0)
+        throw pds::CorruptedSnapshot("fpSetImage: the image is not aligned");
+
+    if(length < sizeof(pds::fpImageHeader))
+        throw pds::CorruptedSnapshot("fpSetImage: the image is too short");
+
+    header = reinterpret_cast<const pds::fpImageHeader*>(this->data);
+
+    if(header->magic != image_magic || header->obj_size != sizeof(OBJ))
+        throw pds::CorruptedSnapshot("fpSetImage: the memory does not hold an image of this object type");
+
+    // Only the bounds of the arrays are checked here, the entries are checked when they are read.
+    // An offset is checked before it is used, so a corrupted one cannot wrap around.
+    auto inside = [length](std::uint64_t offset, std::uint64_t count, std::size_t size){
+        return offset <= length && count <= (length - offset) / size;
+    };
+
+    if(header->nodes_offset % alignof(Node) != 0 || header->entries_offset % alignof(pds::fpImageEntry) != 0
+        || !inside(header->nodes_offset, header->nodes, sizeof(Node))
+        || !inside(header->entries_offset, header->entries, sizeof(pds::fpImageEntry))
+        || header->root_begin > header->root_end || header->root_end > header->entries)
+        throw pds::CorruptedSnapshot("fpSetImage: the image is cut or corrupted");
+
+    nodes = reinterpret_cast<const Node*>(this->data + header->nodes_offset);
+    entries = reinterpret_cast<const pds::fpImageEntry*>(this->data + header->entries_offset);
+}
+
+
+template <class OBJ, class COMPARE>
+pds::fpSetImage<OBJ, COMPARE> pds::fpSetImage<OBJ, COMPARE>::open(const std::string& path, COMPARE compare){
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if(fd < 0)
+        throw std::system_error(errno, std::generic_category(), "fpSetImage::open: " + path);
+
+    struct stat st;
+
+    if(::fstat(fd, &st) != 0 || st.st_size == 0){
+
+        int error = st.st_size == 0 ? EINVAL : errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "fpSetImage::open: " + path);
+    }
+
+    void* map = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    int error = errno;
+
+    // The mapping keeps the file, the descriptor is not needed anymore.
+    ::close(fd);
+
+    if(map == MAP_FAILED)
+        throw std::system_error(error, std::generic_category(), "fpSetImage::open: " + path);
+
+    try{
+        fpSetImage image(map, st.st_size, std::move(compare));
+        image.mapped = true;
+        return image;
+    }
+    catch(...){
+        ::munmap(map, st.st_size);
+        throw;
+    }
+}
+
+
+template <class OBJ, class COMPARE>
+pds::fpSetImage<OBJ, COMPARE>::fpSetImage(fpSetImage&& other) noexcept
+
+    : data(std::exchange(other.data, nullptr)), length(std::exchange(other.length, 0)),
+      mapped(std::exchange(other.mapped, false)), header(other.header), nodes(other.nodes), entries(other.entries),
+      compare(std::move(other.compare)) {
+}
+
+
+template <class OBJ, class COMPARE>
+pds::fpSetImage<OBJ, COMPARE>& pds::fpSetImage<OBJ, COMPARE>::operator=(fpSetImage&& other) noexcept {
+
+    if(this != &other){
+
+        if(mapped)
+            ::munmap(const_cast<char*>(data), length);
+
+        data = std::exchange(other.data, nullptr);
+        length = std::exchange(other.length, 0);
+        mapped = std::exchange(other.mapped, false);
+        header = other.header;
+        nodes = other.nodes;
+        entries = other.entries;
+        compare = std::move(other.compare);
+    }
+    return *this;
+}
+
+
+template <class OBJ, class COMPARE>
+pds::fpSetImage<OBJ, COMPARE>::~fpSetImage(){
+
+    if(mapped)
+        ::munmap(const_cast<char*>(data), length);
+}
+
+
+template <class OBJ, class COMPARE>
+const pds::fpImageEntry* pds::fpSetImage<OBJ, COMPARE>::find(std::uint64_t begin, std::uint64_t end, pds::version_t version) const {
+
+    if(begin == end)
+        return nullptr;
+
+    const pds::fpImageEntry* first = entries + begin;
+    const std::uint64_t count = end - begin;
+
+    // A fat pointer that holds every version (i.e. the root) is indexed directly, like fpFlatSlots.
+    if(first[count - 1].version == count - 1)
+        return version < count ? &first[version] : nullptr;
+
+    const pds::fpImageEntry* it = std::lower_bound(first, first + count, version,
+        [](const pds::fpImageEntry& e, pds::version_t v){ return e.version < v; });
+
+    return (it != first + count && it->version == version) ? it : nullptr;
+}
+
+
+template <class OBJ, class COMPARE>
+const typename pds::fpSetImage<OBJ, COMPARE>::Node& pds::fpSetImage<OBJ, COMPARE>::node(std::uint64_t child) const {
+
+    if(child > header->nodes)
+        throw pds::CorruptedSnapshot("fpSetImage: a slot points out of the image");
+
+    const Node& n = nodes[child - 1];
+
+    if(n.left_begin > n.left_end || n.left_end > header->entries
+        || n.right_begin > n.right_end || n.right_end > header->entries)
+        throw pds::CorruptedSnapshot("fpSetImage: a node points out of the image");
+
+    return n;
+}
+
+
+template <class OBJ, class COMPARE>
+const pds::fpImageEntry& pds::fpSetImage<OBJ, COMPARE>::root_entry(pds::version_t version, const char* func_name) const {
+
+    const pds::fpImageEntry* entry = find(header->root_begin, header->root_end, version);
+
+    if(entry == nullptr)
+        throw pds::VersionNotExist(
+            std::string(func_name) + ": Version " + std::to_string(version) + " is not exist"
+        );
+
+    return *entry;
+}
+
+
+template <class OBJ, class COMPARE>
+const pds::fpImageEntry& pds::fpSetImage<OBJ, COMPARE>::child_entry(std::uint64_t begin, std::uint64_t end, pds::version_t key) const {
+
+    const pds::fpImageEntry* entry = find(begin, end, key);
+
+    if(entry == nullptr)
+        throw pds::CorruptedSnapshot("fpSetImage: a node has no slot for version " + std::to_string(key));
+
+    return *entry;
+}
+
+
+template <class OBJ, class COMPARE>
+bool pds::fpSetImage<OBJ, COMPARE>::contains(const OBJ& obj, pds::version_t version) const {
+
+    const pds::fpImageEntry* entry = &root_entry(version, "fpSetImage::contains");
+
+    while(entry->child != 0){
+
+        const Node& n = node(entry->child);
+
+        if(compare(obj, n.obj)){
+
+            entry = &child_entry(n.left_begin, n.left_end, entry->slot);
+        }
+        else if(compare(n.obj, obj)){
+
+            entry = &child_entry(n.right_begin, n.right_end, entry->slot);
+        }
+        else return true;
+    }
+    return false;
+}
+
+
+template <class OBJ, class COMPARE>
+void pds::fpSetImage<OBJ, COMPARE>::collect(const pds::fpImageEntry& entry, std::vector<OBJ>& out) const {
+
+    if(entry.child == 0)
+        return;
+
+    const Node& n = node(entry.child);
+
+    collect(child_entry(n.left_begin, n.left_end, entry.slot), out);
+    out.push_back(n.obj);
+    collect(child_entry(n.right_begin, n.right_end, entry.slot), out);
+}
+
+
+template <class OBJ, class COMPARE>
+std::vector<OBJ> pds::fpSetImage<OBJ, COMPARE>::to_vector(pds::version_t version) const {
+
+    const pds::fpImageEntry& entry = root_entry(version, "fpSetImage::to_vector");
+
+    std::vector<OBJ> out;
+    out.reserve(entry.size);
+
+    collect(entry, out);
+    return out;
+}
+
+
+template <class OBJ, class COMPARE>
+pds::version_t pds::fpSetImage<OBJ, COMPARE>::size(pds::version_t version) const noexcept {
+
+    const pds::fpImageEntry* entry = find(header->root_begin, header->root_end, version);
+
+    return entry == nullptr ? 0 : entry->size;
+}
+
+
+template <class OBJ, class COMPARE>
+pds::version_t pds::fpSetImage<OBJ, COMPARE>::curr_version() const noexcept {
+
+    return header->last_version;
+}
+
+
+#endif /* FULLY_PERSISTENT_SET_IMAGE_HPP */
@@ -0,0 +1,564 @@
+/**
+ * @file fpSetLog.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief write-ahead log of the updates of a fully persistent set, and its recovery.
+ * @version 0.1
+ * @date 2025-01-20
+ */
+
+#ifndef FULLY_PERSISTENT_SET_LOG_HPP
+#define FULLY_PERSISTENT_SET_LOG_HPP
+
+#include "fpSet.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <spanstream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pds{
+
+    /// @brief The first 8 bytes of a log. see @ref fpSetLog.
+    const std::uint64_t log_magic = 0x3130474F4C504650ULL;     // "PFPLOG01"
+
+    /**
+     * @class fpSetLog
+     * @brief An append-only log file of the updates of an fpSet, with group commit.
+     *
+     * @details Attached with @ref pds::fpSet::set_log, the log gets every update before the set publishes it.
+     *  The records are buffered and written with one fdatasync for every 'group_size' records,
+     *  so a version is durable once @ref durable_version reaches it (or after @ref sync).
+     *
+     *  A record is [length][payload][checksum]: the operation, the version it creates, its base
+     *  versions and its objects (written by CODEC, see @ref pds::fpCodec). A crash can leave a
+     *  torn record at the end of the file, which @ref replay drops.
+     *
+     *  To recover: load the last snapshot (see @ref pds::fpSet::save), replay the log on it, and
+     *  only then attach a log again. The records of versions that the snapshot already has are skipped,
+     *  so the log may be truncated after a snapshot, but does not have to be.
+     *
+     * @tparam OBJ the object type of the set.
+     * @tparam CODEC writes and reads the objects, see @ref pds::fpCodec.
+     *
+     * @attention If writing the file fails, the update that was logged is cancelled, and the log writes
+     *  nothing more: every next update and @ref sync throw. The file may hold the record of the update
+     *  that was cancelled, so the set is behind its log: recover from the snapshot and the log.
+     *
+     * @example
+     * ```
+     * pds::fpSet<int> fps = pds::fpSet<int>::load(snapshot);
+     * pds::fpSetLog<int>::replay(fps, "set.wal");
+     *
+     * pds::fpSetLog<int> wal("set.wal", 64);
+     * fps.set_log(&wal);
+     * fps.insert(5);       // durable after 64 records, or after wal.sync()
+     * ```
+     */
+    template <class OBJ, class CODEC = pds::fpCodec<OBJ>>
+    class fpSetLog final : public pds::fpLogSink<OBJ>{
+
+        /// @brief appends every written character to 'pending', so the codec writes straight to the group.
+        class Buffer : public std::streambuf{
+            std::string& out;
+        public:
+            explicit Buffer(std::string& out) : out(out) {}
+        protected:
+            int_type overflow(int_type c) override {
+
+                if(c != traits_type::eof())
+                    out.push_back(traits_type::to_char_type(c));
+                return traits_type::not_eof(c);
+            }
+
+            std::streamsize xsputn(const char* s, std::streamsize n) override {
+
+                out.append(s, n);
+                return n;
+            }
+        };
+
+        int fd = -1;
+        std::size_t group_size;
+        CODEC codec;
+
+        std::string pending;                    ///< the records that were not synced yet.
+        std::size_t pending_written = 0;        ///< the bytes of 'pending' that the file already has.
+        std::size_t pending_records = 0;
+        pds::version_t pending_version = 0;     ///< the last version that 'pending' creates.
+        pds::version_t durable = 0;             ///< the last version that the file holds.
+        bool failed = false;
+
+        Buffer buf{pending};
+        std::ostream out{&buf};
+
+        /// @brief FNV-1a of a record payload.
+        static std::uint32_t checksum(const char* data, std::size_t length) noexcept;
+
+        /// @brief throws std::system_error of 'errno' and marks the log as failed.
+        [[noreturn]] void fail(const char* func_name);
+
+        /// @brief throws std::system_error if the log failed before.
+        void check_failed(const char* func_name) const;
+
+        /// @brief frames the record that 'write' writes after its operation, and commits the group if it is full.
+        template <class WRITE>
+        void append(pds::fpLogOp op, pds::version_t version, WRITE&& write);
+
+        /// @brief writes 'pending' to the file and syncs it.
+        void flush();
+
+    public:
+        /**
+         * @brief Opens a log file for appending. A new file gets the header of a log.
+         *
+         * @param path the log file. An existing log must have been replayed first (see @ref replay).
+         * @param group_size the number of records that are written and synced together. 0 is taken as 1.
+         *
+         * @exception
+         * - std::system_error
+         *      thrown if: the file can not be opened or written.
+         *
+         * - pds::CorruptedSnapshot
+         *      thrown if: the file is not empty and is not a log.
+         */
+        fpSetLog(const std::string& path, std::size_t group_size = 1, CODEC codec = {});
+
+        /// @brief The set keeps a pointer to its log, so a log is not copied or moved.
+        fpSetLog(const fpSetLog&) = delete;
+        fpSetLog& operator=(const fpSetLog&) = delete;
+
+        /// @brief syncs the records that are left, unless the log failed. Errors are ignored, call @ref sync to see them.
+        ~fpSetLog();
+
+        /**
+         * @brief Writes and syncs the records of the group that is not full yet.
+         *
+         * @exception
+         * - std::system_error
+         *      thrown if: writing or syncing the file failed, now or before.
+         */
+        void sync();
+
+        /**
+         * @brief Drops every record from the file, after a snapshot of the set was saved.
+         *
+         * @exception
+         * - std::system_error
+         *      thrown if: writing or truncating the file failed.
+         */
+        void truncate();
+
+        /// @brief the last version whose record is synced to the file, or 0.
+        pds::version_t durable_version() const noexcept;
+
+        /**
+         * @brief Applies the records of a log file to 'fps', from the first version that 'fps' has not.
+         *
+         * @details A torn record at the end of the file ends the log: it is cut from the file, so a log
+         *  can be opened for appending next. A missing file is an empty log.
+         *
+         * @param fps the set to recover, usually just loaded from a snapshot. It must not have a log attached.
+         *
+         * @exception
+         * - pds::CorruptedSnapshot
+         *      thrown if: the file is not a log, a record before the last one is corrupted,
+         *      a record can not be decoded, or the log does not continue the versions of 'fps'.
+         *
+         * @return the number of records that were applied.
+         *
+         * @note Time complexity: the time of the updates of the records that are applied.
+         */
+        template <class COMPARE, class SLOTS>
+        static std::size_t replay(pds::fpSet<OBJ, COMPARE, SLOTS>& fps, const std::string& path, CODEC codec = {});
+
+        void log_update(pds::fpOp op, const OBJ& obj, pds::version_t base, pds::version_t version) override;
+        void log_apply(const std::vector<pds::fpBatchOp<OBJ>>& batch, pds::version_t base, pds::version_t version) override;
+        void log_combine(pds::fpLogOp op, pds::version_t v1, pds::version_t v2, pds::version_t version) override;
+        void log_retire(const std::vector<pds::version_t>& versions) override;
+    };
+};
+
+
+template <class OBJ, class CODEC>
+pds::fpSetLog<OBJ, CODEC>::fpSetLog(const std::string& path, std::size_t group_size, CODEC codec)
+
+    : group_size(std::max<std::size_t>(group_size, 1)), codec(std::move(codec)) {
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+    if(fd < 0)
+        throw std::system_error(errno, std::generic_category(), "fpSetLog: " + path);
+
+    struct stat st;
+    std::uint64_t magic = 0;
+
+    if(::fstat(fd, &st) != 0){
+
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "fpSetLog: " + path);
+    }
+
+    if(st.st_size == 0){
+
+        pds::fpCodec<std::uint64_t>::write(out, log_magic);
+
+        try{
+            flush();
+        }
+        catch(...){
+            ::close(fd);
+            throw;
+        }
+    }
+    else if(::pread(fd, &magic, sizeof(magic), 0) != sizeof(magic) || magic != log_magic){
+
+        ::close(fd);
+        throw pds::CorruptedSnapshot("fpSetLog: " + path + " is not an fpSet log");
+    }
+}
+
+
+template <class OBJ, class CODEC>
+pds::fpSetLog<OBJ, CODEC>::~fpSetLog(){
+
+    try{
+        if(!failed)
+            sync();
+    }
+    catch(...){
+    }
+    ::close(fd);
+}
+
+
+template <class OBJ, class CODEC>
+std::uint32_t pds::fpSetLog<OBJ, CODEC>::checksum(const char* data, std::size_t length) noexcept {
+
+    return pds::fpChecksum::of(data, length);
+}
+
+
+template <class OBJ, class CODEC>
+void pds::fpSetLog<OBJ, CODEC>::fail(const char* func_name){
+
+    int error = errno;
+    failed = true;
+    throw std::system_error(error, std::generic_category(), func_name);
+}
+
+
+template <class OBJ, class CODEC>
+void pds::fpSetLog<OBJ, CODEC>::check_failed(const char* func_name) const {
+
+    if(failed)
+        throw std::system_error(EIO, std::generic_category(), func_name);
+}
+
+
+template <class OBJ, class CODEC>
+template <class WRITE>
+void pds::fpSetLog<OBJ, CODEC>::append(pds::fpLogOp op, pds::version_t version, WRITE&& write){
+
+    check_failed("fpSetLog: the log failed before, recover from it");
+
+    std::size_t start = pending.size();
+
+    // A record that was not written whole is dropped, so the group goes on without it:
+    try{
+        // The length is written when the payload is done:
+        pds::fpCodec<std::uint32_t>::write(out, 0);
+
+        out.put(static_cast<char>(op));
+        pds::fpVarint::write(out, version);
+        write();
+
+        std::uint32_t length = pending.size() - start - sizeof(length);
+        std::memcpy(pending.data() + start, &length, sizeof(length));
+
+        pds::fpCodec<std::uint32_t>::write(out, checksum(pending.data() + start + sizeof(length), length));
+    }
+    catch(...){
+        pending.resize(start);
+        throw;
+    }
+
+    if(version != 0)
+        pending_version = version;
+
+    if(++pending_records >= group_size)
+        flush();
+}
+
+
+template <class OBJ, class CODEC>
+void pds::fpSetLog<OBJ, CODEC>::flush(){
+
+    // A write that was cut goes on from where it stopped, so no byte is in the file twice:
+    while(pending_written < pending.size()){
+
+        ssize_t n = ::write(fd, pending.data() + pending_written, pending.size() - pending_written);
+
+        if(n < 0 && errno == EINTR)
+            continue;
+
+        if(n < 0)
+            fail("fpSetLog: writing the log failed");
+
+        pending_written += n;
+    }
+
+    if(::fdatasync(fd) != 0)
+        fail("fpSetLog: syncing the log failed");
+
+    pending.clear();
+    pending_written = 0;
+    pending_records = 0;
+    durable = pending_version;
+}
+
+
+template <class OBJ, class CODEC>
+void pds::fpSetLog<OBJ, CODEC>::sync(){
+
+    check_failed("fpSetLog::sync: the log failed before, recover from it");
+
+    if(pending_records > 0)
+        flush();
+}
+
+
+template <class OBJ, class CODEC>
+void pds::fpSetLog<OBJ, CODEC>::truncate(){
+
+    sync();
+
+    if(::ftruncate(fd, sizeof(log_magic)) != 0 || ::fdatasync(fd) != 0)
+        fail("fpSetLog: truncating the log failed");
+}
+
+
+template <class OBJ, class CODEC>
+pds::version_t pds::fpSetLog<OBJ, CODEC>::durable_version() const noexcept {
+
+    return durable;
+}
+
+
+template <class OBJ, class CODEC>
+void pds::fpSetLog<OBJ, CODEC>::log_update(pds::fpOp op, const OBJ& obj, pds::version_t base, pds::version_t version){
+
+    pds::fpLogOp log_op = (op == pds::fpOp::insert) ? pds::fpLogOp::insert : pds::fpLogOp::remove;
+
+    append(log_op, version, [&]{
+        pds::fpVarint::write(out, base);
+        codec.write(out, obj);
+    });
+}
+
+
+template <class OBJ, class CODEC>
+void pds::fpSetLog<OBJ, CODEC>::log_apply(const std::vector<pds::fpBatchOp<OBJ>>& batch,
+    pds::version_t base, pds::version_t version){
+
+    append(pds::fpLogOp::apply, version, [&]{
+        pds::fpVarint::write(out, base);
+        pds::fpVarint::write(out, batch.size());
+
+        for(const pds::fpBatchOp<OBJ>& op : batch){
+
+            out.put(static_cast<char>(op.op));
+            codec.write(out, op.obj);
+        }
+    });
+}
+
+
+template <class OBJ, class CODEC>
+void pds::fpSetLog<OBJ, CODEC>::log_combine(pds::fpLogOp op, pds::version_t v1, pds::version_t v2, pds::version_t version){
+
+    append(op, version, [&]{
+        pds::fpVarint::write(out, v1);
+        pds::fpVarint::write(out, v2);
+    });
+}
+
+
+template <class OBJ, class CODEC>
+void pds::fpSetLog<OBJ, CODEC>::log_retire(const std::vector<pds::version_t>& versions){
+
+    // Retiring creates no version:
+    append(pds::fpLogOp::retire, 0, [&]{
+        pds::fpVarint::write(out, versions.size());
+
+        for(pds::version_t v : versions)
+            pds::fpVarint::write(out, v);
+    });
+}
+
+
+template <class OBJ, class CODEC>
+template <class COMPARE, class SLOTS>
+std::size_t pds::fpSetLog<OBJ, CODEC>::replay(pds::fpSet<OBJ, COMPARE, SLOTS>& fps, const std::string& path, CODEC codec){
+
+    std::ifstream file(path, std::ios::binary);
+
+    if(!file)
+        return 0;
+
+    if(pds::fpCodec<std::uint64_t>::read(file) != log_magic || !file)
+        throw pds::CorruptedSnapshot("fpSetLog::replay: " + path + " is not an fpSet log");
+
+    const std::uint64_t size = std::filesystem::file_size(path);
+    std::uint64_t end = sizeof(log_magic);     // the end of the last whole record.
+    std::size_t applied = 0;
+    std::string payload;
+
+    while(true){
+
+        std::uint32_t length = pds::fpCodec<std::uint32_t>::read(file);
+
+        // A length that was torn may be anything:
+        if(!file || length > size - end)
+            break;
+
+        payload.resize(length);
+        file.read(payload.data(), length);
+
+        std::uint32_t sum = pds::fpCodec<std::uint32_t>::read(file);
+
+        // A torn write, or the end of the log:
+        if(!file)
+            break;
+
+        // Only the last record can be torn, a corrupted record before it is not dropped with the records after it:
+        if(sum != checksum(payload.data(), length)){
+
+            if(end + sizeof(length) + length + sizeof(sum) < size)
+                throw pds::CorruptedSnapshot("fpSetLog::replay: a record of " + path + " is corrupted");
+            break;
+        }
+
+        std::ispanstream in(std::span<const char>(payload.data(), payload.size()));
+
+        auto read = [&]{
+
+            std::uint64_t value = pds::fpVarint::read(in);
+
+            if(!in)
+                throw pds::CorruptedSnapshot("fpSetLog::replay: a record of " + path + " can not be decoded");
+            return value;
+        };
+
+        auto read_obj = [&]{
+
+            OBJ obj = codec.read(in);
+
+            if(!in)
+                throw pds::CorruptedSnapshot("fpSetLog::replay: a record of " + path + " can not be decoded");
+            return obj;
+        };
+
+        pds::fpLogOp op = static_cast<pds::fpLogOp>(in.get());
+        pds::version_t version = read();
+
+        if(op == pds::fpLogOp::retire){
+
+            std::uint64_t count = read();
+
+            // Every version takes a byte at least:
+            if(count > length)
+                throw pds::CorruptedSnapshot("fpSetLog::replay: a record of " + path + " can not be decoded");
+
+            std::vector<pds::version_t> versions(count);
+
+            for(pds::version_t& v : versions)
+                v = read();
+
+            std::sort(versions.begin(), versions.end());
+
+            // Versions that are already retired are not asked about, so a retire is applied once:
+            applied += fps.retain_only([&versions](pds::version_t v){
+                return !std::binary_search(versions.begin(), versions.end(), v);
+            }) > 0;
+        }
+        else if(version > fps.curr_version()){
+
+            if(version != fps.curr_version() + 1)
+                throw pds::CorruptedSnapshot("fpSetLog::replay: the log does not continue the versions of the set");
+
+            pds::version_t created;
+
+            switch(op){
+
+                case pds::fpLogOp::insert:{
+                    pds::version_t base = read();
+                    created = fps.insert(read_obj(), base);
+                    break;
+                }
+                case pds::fpLogOp::remove:{
+                    pds::version_t base = read();
+                    created = fps.remove(read_obj(), base);
+                    break;
+                }
+                case pds::fpLogOp::apply:{
+                    pds::version_t base = read();
+                    std::uint64_t count = read();
+
+                    // Every operation takes a byte at least:
+                    if(count > length)
+                        throw pds::CorruptedSnapshot("fpSetLog::replay: a record of " + path + " can not be decoded");
+
+                    std::vector<pds::fpBatchOp<OBJ>> batch;
+                    batch.reserve(count);
+
+                    for(; count > 0; --count){
+
+                        pds::fpOp batch_op = static_cast<pds::fpOp>(in.get());
+                        batch.push_back(pds::fpBatchOp<OBJ>{batch_op, read_obj()});
+                    }
+                    created = fps.apply(std::move(batch), base);
+                    break;
+                }
+                case pds::fpLogOp::merge_union:{
+                    pds::version_t v1 = read();
+                    created = fps.merge_union(v1, read());
+                    break;
+                }
+                case pds::fpLogOp::intersect:{
+                    pds::version_t v1 = read();
+                    created = fps.intersect(v1, read());
+                    break;
+                }
+                case pds::fpLogOp::subtract:{
+                    pds::version_t v1 = read();
+                    created = fps.subtract(v1, read());
+                    break;
+                }
+                default:
+                    throw pds::CorruptedSnapshot("fpSetLog::replay: a record of " + path + " has an unknown operation");
+            }
+
+            if(created != version)
+                throw pds::CorruptedSnapshot("fpSetLog::replay: the log does not continue the versions of the set");
+
+            ++applied;
+        }
+        end += sizeof(length) + length + sizeof(sum);
+    }
+
+    file.close();
+
+    if(size > end)
+        std::filesystem::resize_file(path, end);
+
+    return applied;
+}
+
+
+#endif /* FULLY_PERSISTENT_SET_LOG_HPP */
@@ -0,0 +1,500 @@
+/**
+ * @file fpString.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief fully persistent string, a rope of shared chunks.
+ * @version 0.1
+ * @date 2025-02-10
+ */
+
+#ifndef FULLY_PERSISTENT_STRING_HPP
+#define FULLY_PERSISTENT_STRING_HPP
+
+#include "fpSet.hpp"
+
+#include <array>
+#include <memory>
+#include <string_view>
+
+namespace pds{
+
+    /**
+     * @brief The object of a fat node of fpString: a slice of a text that is allocated once.
+     *  A chunk that is cut in two makes two slices of the same text, so the characters are never copied.
+     */
+    struct fpStringChunk{
+        std::shared_ptr<const std::string> text;
+        std::size_t offset;
+        std::size_t length;
+
+        std::string_view view() const noexcept { return std::string_view(*text).substr(offset, length); }
+
+        fpStringChunk slice(std::size_t from, std::size_t count) const { return {text, offset + from, count}; }
+    };
+
+    /// @brief A chunk weighs its characters, so the sizes of the subtrees are numbers of characters.
+    template <>
+    struct fpWeight<fpStringChunk>{
+
+        static std::size_t of(const fpStringChunk& chunk) noexcept { return chunk.length; }
+    };
+
+
+    /**
+     * @class fpString
+     * @brief Fully persistent string: every insert, erase, substr and concat creates a new version,
+     *  and every version stays readable and updatable.
+     *
+     * @details A version is a rope: a treap of chunks like the sequence of @ref pds::fpList,
+     *  where the slots keep the number of characters of every subtree, so a position is found
+     *  on the way down. An update cuts the rope at its positions, which slices at most two chunks,
+     *  and joins the parts, so it writes O(log(N)) slots of the new version in expectation,
+     *  while N is the number of chunks. The text of an inserted string is allocated once,
+     *  and its chunks are shared by all the versions that hold them.
+     *
+     *  A version is read without building a std::string: @ref write streams its chunks to an
+     *  std::ostream as they are.
+     *
+     * @tparam SLOTS the storage engine of the version slots, see @ref pds::fpSet.
+     *
+     * @note The versions are numbered like the versions of fpSet: Version 1 is empty
+     *  and every update returns the next version. MasterVersion is not a version of a string.
+     *
+     * @example
+     * ```
+     * pds::fpString<> doc;
+     * doc.insert(0, "hello world");        // Version 2
+     * doc.erase(5, 6);                     // Version 3: "hello"
+     * doc.insert(5, ", rope", 2);          // Version 4: "hello, rope world"
+     * doc.write(std::cout, 4);
+     * ```
+     */
+    template <class SLOTS = pds::fpHashSlots>
+    class fpString{
+
+        using View = typename pds::fpTreap<fpStringChunk, SLOTS>::View;
+
+        pds::fpFatNodeArena<fpStringChunk, SLOTS> arena;    ///< owns all the fat nodes.
+        pds::fpFatNodePtr<fpStringChunk, SLOTS> root;       ///< the root of every version.
+        pds::version_t last_version;
+        std::uint64_t chunks_made = 0;                      ///< the sequence of the priority of the next chunk.
+
+        /// @brief 'version', or the last version for default_version. throws if it not exists.
+        pds::version_t check_version(const char* func_name, pds::version_t version) const;
+
+        /// @brief throws pds::IndexOutOfRange if 'pos' is bigger than 'bound'.
+        static void check_pos(const char* func_name, std::size_t pos, std::size_t bound);
+
+        /// @brief throws pds::IndexOutOfRange if 'pos' is not smaller than 'size', so there is no character at it.
+        static void check_char(const char* func_name, std::size_t pos, std::size_t size);
+
+        /// @brief a new single node View of 'chunk' in the new version of 'treap'.
+        View leaf(pds::fpTreap<fpStringChunk, SLOTS>& treap, fpStringChunk chunk);
+
+        /**
+         * @brief split 't' at 'pos' and at 'pos + count' in one pass: the characters before 'pos',
+         *  the 'count' characters from it and the rest.
+         * @details The chunks that hold the two positions are sliced once, and only the slices of the
+         *  kept parts are made, so no slice is left out of every version.
+         * @param middle keep only the middle part, or only the two parts around it. The other parts are empty.
+         */
+        std::array<View, 3> cut(pds::fpTreap<fpStringChunk, SLOTS>& treap, const View& t,
+            std::size_t pos, std::size_t count, bool middle);
+
+    public:
+        /// @brief Version 1, the empty string.
+        fpString();
+
+        /// @brief The fat nodes point to each other inside the arena, so a string can be moved but not copied.
+        fpString(const fpString&) = delete;
+        fpString& operator=(const fpString&) = delete;
+        fpString(fpString&&) = default;
+        fpString& operator=(fpString&&) = default;
+
+
+        /**
+         * @brief Inserts 'text' before position 'pos' in a new version, based on 'version'.
+         *
+         * @param pos the position of the text, in [0, size(version)].
+         * @param text the text. Taken by value: it is moved into one chunk, that is never copied.
+         * @param version the version to update. if 'version'=default_version update the last version.
+         *
+         * @exception
+         * - pds::IndexOutOfRange
+         *      thrown if: 'pos' is bigger than size(version)
+         *
+         * - pds::VersionZeroIllegal
+         *      thrown if: version is 0
+         *
+         * - pds::VersionNotExist
+         *      thrown if: version is bigger than what returned with 'curr_version()'
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log(N)) expected, while N is the number of chunks of 'version'.
+         */
+        pds::version_t insert(std::size_t pos, std::string text, pds::version_t version = default_version);
+
+
+        /// @brief insert(size(version), text, version).
+        pds::version_t append(std::string text, pds::version_t version = default_version);
+
+
+        /**
+         * @brief Removes 'count' characters from position 'pos' in a new version, based on 'version'.
+         *  Like std::string::erase, the characters after 'pos' are removed if there are fewer than 'count'.
+         *
+         * @exception
+         * - pds::IndexOutOfRange
+         *      thrown if: 'pos' is bigger than size(version)
+         *
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref insert.
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log(N)) expected.
+         */
+        pds::version_t erase(std::size_t pos, std::size_t count, pds::version_t version = default_version);
+
+
+        /**
+         * @brief Creates a new version with the 'count' characters from position 'pos' of 'version'.
+         *  Like std::string::substr, the version ends with 'version' if it has fewer than 'count' characters after 'pos'.
+         *
+         * @exception
+         * - pds::IndexOutOfRange
+         *      thrown if: 'pos' is bigger than size(version)
+         *
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref insert.
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log(N)) expected.
+         */
+        pds::version_t substr(std::size_t pos, std::size_t count, pds::version_t version = default_version);
+
+
+        /**
+         * @brief Creates a new version with the text of 'v1' followed by the text of 'v2'.
+         *
+         * @exception
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref insert.
+         *
+         * @return pds::version_t of the new version.
+         *
+         * @note Time complexity: O(log(N1 + N2)) expected.
+         */
+        pds::version_t concat(pds::version_t v1, pds::version_t v2);
+
+
+        /**
+         * @brief The character at 'pos' in 'version'.
+         *
+         * @exception
+         * - pds::IndexOutOfRange
+         *      thrown if: 'pos' is not smaller than size(version)
+         *
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref insert.
+         *
+         * @note Time complexity: O(log(N)) expected.
+         */
+        char at(std::size_t pos, pds::version_t version = default_version);
+
+
+        /**
+         * @brief Streams the text of 'version' to 'out', chunk by chunk, without building a std::string.
+         *
+         * @exception
+         * - pds::VersionZeroIllegal, pds::VersionNotExist
+         *      see @ref insert.
+         *
+         * @note Time complexity: O(N + size(version)).
+         */
+        void write(std::ostream& out, pds::version_t version = default_version);
+
+
+        /// @brief the text of 'version'. throws like @ref write.
+        std::string to_string(pds::version_t version = default_version);
+
+
+        /// @brief number of characters in 'version', or 0 if it not exists.
+        std::size_t size(pds::version_t version = default_version) const noexcept;
+
+
+        /// @brief the last version.
+        pds::version_t curr_version() const noexcept;
+    };
+};
+
+
+template <class SLOTS>
+pds::fpString<SLOTS>::fpString() : root(1), last_version(1) {
+}
+
+
+template <class SLOTS>
+pds::version_t pds::fpString<SLOTS>::check_version(const char* func_name, pds::version_t version) const {
+
+    if(version == default_version)
+        return last_version;
+
+    if(version == MasterVersion)
+        throw pds::VersionZeroIllegal(std::string(func_name) + ": Version 0 is not a version of a string");
+
+    if(version > last_version)
+        throw pds::VersionNotExist(
+            std::string(func_name) + ": Version " + std::to_string(version) + " is not exist"
+        );
+
+    return version;
+}
+
+
+template <class SLOTS>
+void pds::fpString<SLOTS>::check_pos(const char* func_name, std::size_t pos, std::size_t bound){
+
+    if(pos > bound)
+        throw pds::IndexOutOfRange(
+            std::string(func_name) + ": Position " + std::to_string(pos) + " is out of range"
+        );
+}
+
+
+template <class SLOTS>
+void pds::fpString<SLOTS>::check_char(const char* func_name, std::size_t pos, std::size_t size){
+
+    // Not 'pos + 1 > size', which wraps around for the last position:
+    if(pos >= size)
+        throw pds::IndexOutOfRange(
+            std::string(func_name) + ": Position " + std::to_string(pos) + " is out of range"
+        );
+}
+
+
+template <class SLOTS>
+typename pds::fpString<SLOTS>::View
+pds::fpString<SLOTS>::leaf(pds::fpTreap<fpStringChunk, SLOTS>& treap, fpStringChunk chunk){
+
+    pds::fpFatNode<fpStringChunk, SLOTS>* node = arena.make(
+        std::move(chunk), last_version + 1, pds::fpTreap<fpStringChunk, SLOTS>::priority(chunks_made++)
+    );
+    return treap.link(node, View{}, View{});
+}
+
+
+template <class SLOTS>
+std::array<typename pds::fpString<SLOTS>::View, 3>
+pds::fpString<SLOTS>::cut(pds::fpTreap<fpStringChunk, SLOTS>& treap, const View& t,
+    std::size_t pos, std::size_t count, bool middle){
+
+    if(middle && count == 0)
+        return {};
+
+    auto first = [](const View& v) -> const fpStringChunk& {
+
+        std::size_t index = 0;
+        return pds::fpTreap<fpStringChunk, SLOTS>::nth(v, index).node->get_obj();
+    };
+
+    // A chunk that holds a position inside it goes to the right of the split, as the first chunk there:
+    auto [l, r] = treap.split_at(t, pos);
+    auto [m, rest] = treap.split_at(r, pos + count - l.size);
+
+    std::size_t from = pos - l.size;
+    std::size_t to = pos + count - l.size - m.size;
+
+    // Both positions are inside the first chunk of 'rest', it is sliced in three:
+    if(from > 0 && m.size == 0){
+
+        const fpStringChunk& chunk = first(rest);
+
+        if(middle)
+            return {View{}, leaf(treap, chunk.slice(from, count)), View{}};
+
+        View after = treap.split_at(rest, chunk.length).second;
+
+        return {treap.join(l, leaf(treap, chunk.slice(0, from))), View{},
+                treap.join(leaf(treap, chunk.slice(to, chunk.length - to)), after)};
+    }
+
+    if(from > 0){
+
+        const fpStringChunk& chunk = first(m);
+
+        if(middle)
+            m = treap.join(leaf(treap, chunk.slice(from, chunk.length - from)), treap.split_at(m, chunk.length).second);
+        else
+            l = treap.join(l, leaf(treap, chunk.slice(0, from)));
+    }
+
+    if(to > 0){
+
+        const fpStringChunk& chunk = first(rest);
+
+        if(middle)
+            m = treap.join(m, leaf(treap, chunk.slice(0, to)));
+        else
+            rest = treap.join(leaf(treap, chunk.slice(to, chunk.length - to)), treap.split_at(rest, chunk.length).second);
+    }
+
+    if(middle)
+        return {View{}, m, View{}};
+
+    return {l, View{}, rest};
+}
+
+
+template <class SLOTS>
+pds::version_t pds::fpString<SLOTS>::insert(std::size_t pos, std::string text, pds::version_t version){
+
+    version = check_version("fpString::insert", version);
+
+    View t = pds::fpTreap<fpStringChunk, SLOTS>::at(root, version);
+    check_pos("fpString::insert", pos, t.size);
+
+    pds::fpTreap<fpStringChunk, SLOTS> treap(arena, last_version + 1);
+
+    if(!text.empty()){
+
+        auto [l, m, r] = cut(treap, t, pos, 0, false);
+        std::size_t length = text.size();
+
+        t = treap.join(treap.join(l, leaf(treap, {std::make_shared<const std::string>(std::move(text)), 0, length})), r);
+    }
+    treap.set_root(root, t);
+
+    return ++last_version;
+}
+
+
+template <class SLOTS>
+pds::version_t pds::fpString<SLOTS>::append(std::string text, pds::version_t version){
+
+    version = check_version("fpString::append", version);
+
+    return insert(size(version), std::move(text), version);
+}
+
+
+template <class SLOTS>
+pds::version_t pds::fpString<SLOTS>::erase(std::size_t pos, std::size_t count, pds::version_t version){
+
+    version = check_version("fpString::erase", version);
+
+    View t = pds::fpTreap<fpStringChunk, SLOTS>::at(root, version);
+    check_pos("fpString::erase", pos, t.size);
+
+    count = std::min(count, t.size - pos);
+
+    pds::fpTreap<fpStringChunk, SLOTS> treap(arena, last_version + 1);
+
+    auto [l, m, r] = cut(treap, t, pos, count, false);
+    treap.set_root(root, treap.join(l, r));
+
+    return ++last_version;
+}
+
+
+template <class SLOTS>
+pds::version_t pds::fpString<SLOTS>::substr(std::size_t pos, std::size_t count, pds::version_t version){
+
+    version = check_version("fpString::substr", version);
+
+    View t = pds::fpTreap<fpStringChunk, SLOTS>::at(root, version);
+    check_pos("fpString::substr", pos, t.size);
+
+    count = std::min(count, t.size - pos);
+
+    pds::fpTreap<fpStringChunk, SLOTS> treap(arena, last_version + 1);
+
+    treap.set_root(root, cut(treap, t, pos, count, true)[1]);
+
+    return ++last_version;
+}
+
+
+template <class SLOTS>
+pds::version_t pds::fpString<SLOTS>::concat(pds::version_t v1, pds::version_t v2){
+
+    v1 = check_version("fpString::concat", v1);
+    v2 = check_version("fpString::concat", v2);
+
+    pds::fpTreap<fpStringChunk, SLOTS> treap(arena, last_version + 1);
+    treap.set_root(root, treap.join(
+        pds::fpTreap<fpStringChunk, SLOTS>::at(root, v1), pds::fpTreap<fpStringChunk, SLOTS>::at(root, v2)
+    ));
+
+    return ++last_version;
+}
+
+
+template <class SLOTS>
+char pds::fpString<SLOTS>::at(std::size_t pos, pds::version_t version){
+
+    version = check_version("fpString::at", version);
+
+    View t = pds::fpTreap<fpStringChunk, SLOTS>::at(root, version);
+    check_char("fpString::at", pos, t.size);
+
+    return pds::fpTreap<fpStringChunk, SLOTS>::nth(t, pos).node->get_obj().view()[pos];
+}
+
+
+template <class SLOTS>
+void pds::fpString<SLOTS>::write(std::ostream& out, pds::version_t version){
+
+    version = check_version("fpString::write", version);
+
+    using iterator = pds::fpSetIterator<fpStringChunk, SLOTS>;
+
+    for(iterator it = iterator::first(root, version); it != iterator(root, version); ++it){
+
+        std::string_view chunk = it->view();
+        out.write(chunk.data(), chunk.size());
+    }
+}
+
+
+template <class SLOTS>
+std::string pds::fpString<SLOTS>::to_string(pds::version_t version){
+
+    version = check_version("fpString::to_string", version);
+
+    std::string text;
+    text.reserve(size(version));
+
+    using iterator = pds::fpSetIterator<fpStringChunk, SLOTS>;
+
+    for(iterator it = iterator::first(root, version); it != iterator(root, version); ++it){
+
+        text += it->view();
+    }
+    return text;
+}
+
+
+template <class SLOTS>
+std::size_t pds::fpString<SLOTS>::size(pds::version_t version) const noexcept {
+
+    if(version == default_version)
+        version = last_version;
+
+    pds::version_t slot;
+    const pds::fpChild<fpStringChunk, SLOTS>* child = (version == MasterVersion) ? nullptr : root.resolve(version, slot);
+
+    return child == nullptr ? 0 : child->size;
+}
+
+
+template <class SLOTS>
+pds::version_t pds::fpString<SLOTS>::curr_version() const noexcept {
+
+    return last_version;
+}
+
+
+#endif /* FULLY_PERSISTENT_STRING_HPP */
@@ -21,18 +21,24 @@ namespace pds{
     class VersionNotExist : public pdsExcept {
         /*
             thrown by:
-                - pds::fpSet::insert_impl
+                - pds::fpSet::insert
                 - pds::fpSet::remove
                 - pds::fpSet::contains
                 - pds::fpSet::to_vector
                 - pds::fpSet::print
+                - pds::fpSet::retire (and every query of a retired version, but size that returns 0)
+                - pds::fpMap - every function of a version
+                - pds::fpList - every function of a version
+                - pds::fpString - every function of a version
+                - pds::fpPriorityQueue - every function of a version
+                - pds::fpHashSet - every function of a version
 
                 - pds::pSet::contains
                 - pds::pSet::to_vector
                 - pds::pSet::print
                 
                 - pds::fat_node_tracker - almost all func
-                - pds::UnionFind::Find
+                - pds::fpVersionIndex::map
         */
     public:
         VersionNotExist(std::string&& m) : pdsExcept(std::move(m)){}
@@ -41,8 +47,16 @@ namespace pds{
     class VersionZeroIllegal : public pdsExcept{
         /*
             thrown by:
-                - pds::fpSet::insert_impl
+                - pds::fpSet::insert
                 - pds::fpSet::remove
+                - pds::fpSet::apply
+                - pds::fpSet::merge_union, intersect, subtract
+                - pds::fpSet::retire
+                - pds::fpMap - every function of a version
+                - pds::fpList - every function of a version
+                - pds::fpString - every function of a version
+                - pds::fpPriorityQueue - every function of a version
+                - pds::fpHashSet - every function of a version
         */
     public:
         VersionZeroIllegal(std::string&& m) : pdsExcept(std::move(m)){}
@@ -52,7 +66,9 @@ namespace pds{
         /*
             thrown by:
                 - pds::pSet::insert_impl
-                - pds::fpSet::insert_impl
+                - pds::fpSet::insert
+                - pds::fpSet::apply
+                - pds::fpHashSet::insert
         */
     public:
         ObjectAlreadyExist(std::string&& m) : pdsExcept(std::move(m)){}
@@ -63,11 +79,46 @@ namespace pds{
             thrown by:
                 - pds::pSet::remove
                 - pds::fpSet::remove
+                - pds::fpSet::apply
+                - pds::fpSet::select
+                - pds::fpMap::get, erase
+                - pds::fpPriorityQueue::top, pop (of an empty version)
+                - pds::fpHashSet::remove
         */
     public:
         ObjectNotExist(std::string&& m) : pdsExcept(std::move(m)){}
     };
 
+    class ObjectsNotSorted : public pdsExcept{
+        /*
+            thrown by:
+                - pds::fpSet::from_sorted
+        */
+    public:
+        ObjectsNotSorted(std::string&& m) : pdsExcept(std::move(m)){}
+    };
+
+    class IndexOutOfRange : public pdsExcept{
+        /*
+            thrown by:
+                - pds::fpList::insert_at, erase_at, at, split
+                - pds::fpString::insert, erase, substr, at
+        */
+    public:
+        IndexOutOfRange(std::string&& m) : pdsExcept(std::move(m)){}
+    };
+
+    class CorruptedSnapshot : public pdsExcept{
+        /*
+            thrown by:
+                - pds::fpSet::load
+                - pds::fpSetImage::fpSetImage, open (and the queries of an image that points out of itself)
+                - pds::fpSetLog::fpSetLog, replay
+        */
+    public:
+        CorruptedSnapshot(std::string&& m) : pdsExcept(std::move(m)){}
+    };
+
     class NullTracker : public pdsExcept{
         /*
             thrown by:
@@ -81,6 +132,7 @@ namespace pds{
         /*
             thrown by:
                 - pds::FatNode::back
+                - pds::fpSlotTable<fpConcurrentSlots>::slot, alias, adopt (a version older than the newest one)
         */
     public:
         OperationNotSupported(std::string&& m) : pdsExcept(std::move(m)){}
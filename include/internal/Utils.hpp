@@ -11,23 +11,28 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cstdbool>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <exception>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <memory_resource>
 #include <sstream>
 #include <stack>
 #include <string>
 #include <typeinfo>
 #include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -45,6 +50,18 @@
                     throw pds::VersionNotExist("fat_node_tracker::"     \
             + std::string(func_name) + ": Version " + std::to_string(vrs) + " is not exist"); } } while(0)
 
+#define PDS_THROW_IF_NULL_TRACKER_NODE(func_name)                                           \
+            do{ if(!exist)                                                                  \
+                    throw pds::VersionNotExist("fat_node_tracker::" + std::string(func_name)  \
+                        + ": Version " + std::to_string(track_version) + " is not exist");  \
+                if(node == nullptr)                                                         \
+                    throw pds::NullTracker("fat_node_tracker::" + std::string(func_name)    \
+                        + ": table.at(" + std::to_string(track_version) + ") is nullptr"); } while(0)
+
+#define PDS_CHECK_NULL_TRACKER_NODE(func_name)                          \
+            do{ if constexpr(CHECKED) PDS_THROW_IF_NULL_TRACKER_NODE(func_name); \
+                else assert(exist && node != nullptr); } while(0)
+
 #define PDS_THROW_IF_VERSION_NOT_EXIST(func_name, vrs, last_vrs)        \
             do{ if(vrs > last_vrs)                                      \
                     throw pds::VersionNotExist(std::string(func_name)   \
@@ -86,6 +103,14 @@ namespace pds{
      *      D. Finally, for easy insert & remove algorithms.
      */
     const version_t MasterVersion = 0;
+
+
+    /**
+     * @brief A comparator that compares the objects with other types too, like std::less<>.
+     *  The sets look up any key by such a comparator, see @ref pds::fpSet::contains.
+     */
+    template <class COMPARE>
+    concept fpTransparent = requires { typename COMPARE::is_transparent; };
 };
 
 #endif /* PERSISTENT_DATA_STRUCTURE_UTILITYS_HPP */
\ No newline at end of file
@@ -0,0 +1,196 @@
+/**
+ * @file fpCodec.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief binary encoding of the objects and the numbers of a fully persistent snapshot.
+ * @version 0.1
+ * @date 2025-01-06
+ */
+#ifndef FULLY_PERSISTENT_CODEC_HPP
+#define FULLY_PERSISTENT_CODEC_HPP
+
+#include "Utils.hpp"
+
+namespace pds{
+
+    /**
+     * @brief Writes and reads one object of a snapshot (see @ref pds::fpSet::save).
+     *
+     * @details A codec is any type with:
+     *  - void write(std::ostream& out, const OBJ& obj)
+     *  - OBJ read(std::istream& in)
+     *
+     *  The default codec copies the bytes of a trivially copyable object, and writes a 'std::string'
+     *  as its length and its characters. Other objects need a specialization or a codec of their own.
+     */
+    template <class OBJ>
+    struct fpCodec{
+
+        static_assert(std::is_trivially_copyable_v<OBJ>,
+            "fpCodec: OBJ is not trivially copyable, pass a codec to save and load");
+
+        static void write(std::ostream& out, const OBJ& obj){
+
+            out.write(reinterpret_cast<const char*>(&obj), sizeof(OBJ));
+        }
+
+        static OBJ read(std::istream& in){
+
+            OBJ obj;
+            in.read(reinterpret_cast<char*>(&obj), sizeof(OBJ));
+            return obj;
+        }
+    };
+
+    template <>
+    struct fpCodec<std::string>{
+
+        static void write(std::ostream& out, const std::string& obj){
+
+            pds::fpCodec<std::uint64_t>::write(out, obj.size());
+            out.write(obj.data(), obj.size());
+        }
+
+        static std::string read(std::istream& in){
+
+            std::uint64_t length = pds::fpCodec<std::uint64_t>::read(in);
+
+            // A corrupted length must not allocate more than the stream holds.
+            std::string obj;
+            for(char buf[4096]; in && length > 0; length -= in.gcount()){
+
+                in.read(buf, std::min<std::uint64_t>(length, sizeof(buf)));
+                obj.append(buf, in.gcount());
+            }
+            return obj;
+        }
+    };
+
+
+    /**
+     * @brief The numbers of a snapshot: unsigned LEB128, 7 bits in every byte,
+     *  so the small numbers that most slots hold take one byte.
+     */
+    struct fpVarint{
+
+        static void write(std::ostream& out, std::uint64_t value){
+
+            std::streambuf* buf = out.rdbuf();
+
+            while(value >= 0x80){
+
+                buf->sputc(static_cast<char>(value | 0x80));
+                value >>= 7;
+            }
+            if(buf->sputc(static_cast<char>(value)) == std::char_traits<char>::eof())
+                out.setstate(std::ios_base::badbit);
+        }
+
+        /// @brief sets the failbit of 'in' if it ends before the number does.
+        static std::uint64_t read(std::istream& in){
+
+            std::streambuf* buf = in.rdbuf();
+            std::uint64_t value = 0;
+
+            for(unsigned shift = 0; shift < 64; shift += 7){
+
+                int byte = buf->sbumpc();
+
+                if(byte == std::char_traits<char>::eof())
+                    break;
+
+                value |= std::uint64_t(byte & 0x7f) << shift;
+
+                if((byte & 0x80) == 0)
+                    return value;
+            }
+            in.setstate(std::ios_base::failbit);
+            return 0;
+        }
+    };
+
+    /**
+     * @brief FNV-1a of a run of bytes, 32 bits. The log checksums every record with it, and a snapshot
+     *  ends with the one of all its bytes.
+     */
+    struct fpChecksum{
+
+        std::uint32_t hash = 2166136261u;
+
+        void add(const char* data, std::size_t length) noexcept {
+
+            for(std::size_t i = 0; i < length; ++i){
+
+                hash ^= static_cast<unsigned char>(data[i]);
+                hash *= 16777619u;
+            }
+        }
+
+        static std::uint32_t of(const char* data, std::size_t length) noexcept {
+
+            fpChecksum sum;
+            sum.add(data, length);
+            return sum.hash;
+        }
+    };
+
+
+    /**
+     * @brief A stream buffer between a snapshot and its stream, that sums every byte that goes through it.
+     *
+     * @details It holds no bytes of its own: a read takes from 'target' exactly the bytes that were asked for,
+     *  so the checksum that follows a snapshot is still in 'target' when the snapshot is read.
+     */
+    class fpChecksumBuf : public std::streambuf {
+
+        std::streambuf* target;
+
+    public:
+        pds::fpChecksum sum;
+
+        explicit fpChecksumBuf(std::streambuf* target) : target(target) {}
+
+    protected:
+        int_type overflow(int_type ch) override {
+
+            if(traits_type::eq_int_type(ch, traits_type::eof()))
+                return traits_type::not_eof(ch);
+
+            char c = traits_type::to_char_type(ch);
+            sum.add(&c, 1);
+            return target->sputc(c);
+        }
+
+        std::streamsize xsputn(const char* data, std::streamsize count) override {
+
+            sum.add(data, count);
+            return target->sputn(data, count);
+        }
+
+        int_type underflow() override {
+
+            return target->sgetc();
+        }
+
+        int_type uflow() override {
+
+            int_type ch = target->sbumpc();
+
+            if(!traits_type::eq_int_type(ch, traits_type::eof())){
+
+                char c = traits_type::to_char_type(ch);
+                sum.add(&c, 1);
+            }
+            return ch;
+        }
+
+        std::streamsize xsgetn(char* data, std::streamsize count) override {
+
+            std::streamsize got = target->sgetn(data, count);
+            sum.add(data, got);
+            return got;
+        }
+    };
+};
+
+#endif /* FULLY_PERSISTENT_CODEC_HPP */
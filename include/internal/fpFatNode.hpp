@@ -1,34 +1,150 @@
 #ifndef FULLY_PERSISTENT_FAT_NODE_HPP
 #define FULLY_PERSISTENT_FAT_NODE_HPP
 
-#include "Utils.hpp"
-#include "UnionFind.hpp"
+#include "fpSlotTable.hpp"
+
+#include <optional>
 
 namespace pds{
 
-    template <class OBJ>
+    template <class OBJ, class SLOTS>
     struct fpFatNodePtr;
 
-    template <class OBJ>
+    /**
+     * @brief The number of versions that a fat pointer of a node may index.
+     * @details A new version that would write to a node whose fat pointers are full writes to a copy
+     *  of the node instead (see @ref pds::fpTreap), so every fat pointer below the root is searched 
+     *  in O(1) however many versions the set has.
+     */
+    const std::size_t fpFatNodeCapacity = 32;
+
+    template <class OBJ, class SLOTS = pds::fpHashSlots>
     class fpFatNode{
         const OBJ obj;
+        const std::uint64_t priority;   ///< treap priority, the same for all versions.
     public:
-        pds::fpFatNodePtr<OBJ> left;
-        pds::fpFatNodePtr<OBJ> right;
+        pds::fpFatNodePtr<OBJ, SLOTS> left;
+        pds::fpFatNodePtr<OBJ, SLOTS> right;
+        pds::fpFatNode<OBJ, SLOTS>* next = nullptr;     ///< the copy that took over when this node was full.
 
-        fpFatNode(const OBJ& obj, pds::version_t version);
-        fpFatNode(OBJ&& obj, pds::version_t version);
+        /// @brief the fat pointers of the node allocate from 'resource', and are counted by 'counters' if given.
+        fpFatNode(const OBJ& obj, pds::version_t version, std::uint64_t priority = 0, 
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource(), pds::fpMemoryCounters* counters = nullptr);
+        fpFatNode(OBJ&& obj, pds::version_t version, std::uint64_t priority = 0, 
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource(), pds::fpMemoryCounters* counters = nullptr);
 
         const OBJ& get_obj() const;
+        std::uint64_t get_priority() const;
+    };
+
+    /**
+     * @brief The slot value of a fat pointer: the child of one version and the size of its subtree
+     *  in that version, so order statistics need no extra lookups.
+     */
+    template <class OBJ, class SLOTS = pds::fpHashSlots>
+    struct fpChild{
+        pds::fpFatNode<OBJ, SLOTS>* node = nullptr;     ///< a node of the arena.
+        std::size_t size = 0;                           ///< number of objects under 'node'.
     };
 
-    template <class OBJ>
-    struct fpFatNodePtr{
-        std::unordered_map<pds::version_t, std::shared_ptr<pds::fpFatNode<OBJ>>> table;
-        pds::UnionFind versions_map;
+    /**
+     * @brief A fat pointer: the child of every version, as a raw pointer to a node of the arena.
+     *  Following it does not touch any reference count.
+     */
+    template <class OBJ, class SLOTS = pds::fpHashSlots>
+    struct fpFatNodePtr : pds::fpSlotTable<pds::fpChild<OBJ, SLOTS>, SLOTS>{
 
-        fpFatNodePtr(pds::version_t first_version);
-        pds::version_t map(const pds::version_t version);
+        fpFatNodePtr(pds::version_t first_version, std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+                     pds::fpMemoryCounters* counters = nullptr);
+    };
+
+    /**
+     * @class fpFatNodeArena
+     * @brief Owns all the fat nodes of one fpSet.
+     *
+     * @details The master tree keeps every node that was ever inserted, so a node lives
+     *  until no version of its set reaches it (see @ref pds::fpSet::retire). 
+     *  The nodes are allocated in blocks and never move. A released node leaves its place
+     *  to the next node that is made, and a block whose nodes were all released is freed.
+     *
+     *  The blocks, and the slot tables of the nodes, are allocated from the memory resource of the arena.
+     *  The arena keeps the pds::fpMemoryCounters of its nodes and of its blocks, and the fat pointers
+     *  of its nodes add to them.
+     */
+    template <class OBJ, class SLOTS = pds::fpHashSlots>
+    class fpFatNodeArena{
+
+        using Place = std::optional<pds::fpFatNode<OBJ, SLOTS>>;
+
+        static constexpr std::size_t BLOCK = 64;    ///< nodes per block.
+
+        using Block = std::array<Place, BLOCK>;
+
+        /// @brief returns a block to the resource that allocated it.
+        struct BlockDeleter{
+            std::pmr::memory_resource* resource;
+
+            void operator()(Block* block) const { std::pmr::polymorphic_allocator<Block>(resource).delete_object(block); }
+        };
+
+        /// @brief returns the counters to the resource that allocated them.
+        struct CountersDeleter{
+            std::pmr::memory_resource* resource;
+
+            void operator()(pds::fpMemoryCounters* counters) const { 
+                std::pmr::polymorphic_allocator<pds::fpMemoryCounters>(resource).delete_object(counters); 
+            }
+        };
+
+        // Before the blocks, so the fat pointers of the nodes are destroyed while their counters live.
+        std::unique_ptr<pds::fpMemoryCounters, CountersDeleter> counts;
+
+        std::pmr::vector<std::unique_ptr<Block, BlockDeleter>> blocks;
+        std::pmr::vector<Place*> free_places;   ///< the empty places of all the blocks, reused by make.
+        std::size_t live = 0;
+        std::pmr::memory_resource* resource;
+
+        /// @brief adds the change of heap_bytes() from 'before' to the counters.
+        void count_bytes(std::size_t before) noexcept;
+
+    public:
+        /// @brief an empty arena, that allocates from 'resource'. 'resource' must outlive the arena.
+        explicit fpFatNodeArena(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        fpFatNodeArena(const fpFatNodeArena&) = delete;
+        fpFatNodeArena& operator=(const fpFatNodeArena&) = delete;
+        fpFatNodeArena(fpFatNodeArena&&) = default;
+        fpFatNodeArena& operator=(fpFatNodeArena&& other);
+
+        /**
+         * @brief construct a new node in the arena. The pointer is valid until the node is released.
+         * @details 'args' are the arguments of the node up to its priority, the arena adds its resource.
+         */
+        template <typename... Args>
+        pds::fpFatNode<OBJ, SLOTS>* make(Args&&... args);
+
+        /// @brief number of nodes in the arena.
+        std::size_t size() const noexcept;
+
+        /// @brief the memory resource of the arena.
+        std::pmr::memory_resource* get_resource() const noexcept;
+
+        /// @brief bytes of the blocks, their free places included, of the lists of the arena, and of its counters.
+        std::size_t heap_bytes() const noexcept;
+
+        /// @brief the running totals of the nodes and their fat pointers. nullptr for an arena that was moved from.
+        pds::fpMemoryCounters* counters() const noexcept;
+
+        /// @brief destroy every node for which 'dead(node)' is true. return the number of destroyed nodes.
+        template <class PRED>
+        std::size_t release_if(PRED&& dead);
+
+        /// @brief call 'func(node)' for every node in the arena.
+        template <class FUNC>
+        void for_each(FUNC&& func);
+
+        template <class FUNC>
+        void for_each(FUNC&& func) const;
     };
 };
 
@@ -37,45 +153,216 @@ namespace pds{
 /// fpFatNode
 ////////////////////////////////////
 
-template <class OBJ>
-pds::fpFatNode<OBJ>::fpFatNode(const OBJ& obj, pds::version_t version)
+template <class OBJ, class SLOTS>
+pds::fpFatNode<OBJ, SLOTS>::fpFatNode(const OBJ& obj, pds::version_t version, std::uint64_t priority, 
+    std::pmr::memory_resource* resource, pds::fpMemoryCounters* counters)
 
-    : obj(obj), left(version), right(version) {
+    : obj(obj), priority(priority), left(version, resource, counters), right(version, resource, counters) {
 }
 
-template <class OBJ>
-pds::fpFatNode<OBJ>::fpFatNode(OBJ&& obj, pds::version_t version)
+template <class OBJ, class SLOTS>
+pds::fpFatNode<OBJ, SLOTS>::fpFatNode(OBJ&& obj, pds::version_t version, std::uint64_t priority, 
+    std::pmr::memory_resource* resource, pds::fpMemoryCounters* counters)
 
-    : obj(std::move(obj)), left(version), right(version) {
+    : obj(std::move(obj)), priority(priority), left(version, resource, counters), right(version, resource, counters) {
 }
 
-template <class OBJ>
-const OBJ& pds::fpFatNode<OBJ>::get_obj() const {
+template <class OBJ, class SLOTS>
+const OBJ& pds::fpFatNode<OBJ, SLOTS>::get_obj() const {
 
     return obj;
 }
 
+template <class OBJ, class SLOTS>
+std::uint64_t pds::fpFatNode<OBJ, SLOTS>::get_priority() const {
+
+    return priority;
+}
+
 
 ////////////////////////////////////
 /// fpFatNodePtr
 ////////////////////////////////////
 
-template <class OBJ>
-pds::fpFatNodePtr<OBJ>::fpFatNodePtr(pds::version_t first_version) 
-            
-    : table{{MasterVersion, nullptr}, {first_version, nullptr}} {
+template <class OBJ, class SLOTS>
+pds::fpFatNodePtr<OBJ, SLOTS>::fpFatNodePtr(pds::version_t first_version, std::pmr::memory_resource* resource,
+    pds::fpMemoryCounters* counters)
 
-    versions_map.add(first_version);
+    : pds::fpSlotTable<pds::fpChild<OBJ, SLOTS>, SLOTS>(resource, counters) {
+
+    this->slot(MasterVersion) = {};
+    this->slot(first_version) = {};
 }
 
-template <class OBJ>
-pds::version_t pds::fpFatNodePtr<OBJ>::map(const pds::version_t version){
 
-    if(version == MasterVersion)
-        return MasterVersion;
+////////////////////////////////////
+/// fpFatNodeArena
+////////////////////////////////////
+
+template <class OBJ, class SLOTS>
+pds::fpFatNodeArena<OBJ, SLOTS>::fpFatNodeArena(std::pmr::memory_resource* resource)
+
+    : counts(std::pmr::polymorphic_allocator<pds::fpMemoryCounters>(resource).template new_object<pds::fpMemoryCounters>(),
+             CountersDeleter{resource}),
+      blocks(resource), free_places(resource), resource(resource) {
+
+    count_bytes(0);
+}
+
+template <class OBJ, class SLOTS>
+pds::fpFatNodeArena<OBJ, SLOTS>& pds::fpFatNodeArena<OBJ, SLOTS>::operator=(fpFatNodeArena&& other){
+
+    // The nodes are destroyed first, while their counters live:
+    blocks.clear();
+
+    // The lists of another resource are copied, so their capacity may change:
+    std::size_t before = other.heap_bytes();
+
+    counts = std::move(other.counts);
+    blocks = std::move(other.blocks);
+    free_places = std::move(other.free_places);
+    live = std::exchange(other.live, 0);
+    resource = other.resource;
+
+    count_bytes(before);
+
+    return *this;
+}
+
+template <class OBJ, class SLOTS>
+void pds::fpFatNodeArena<OBJ, SLOTS>::count_bytes(std::size_t before) noexcept {
+
+    if(counts != nullptr)
+        pds::fpMemoryCounters::add(counts->node_bytes, heap_bytes() - before);
+}
+
+template <class OBJ, class SLOTS>
+template <typename... Args>
+pds::fpFatNode<OBJ, SLOTS>* pds::fpFatNodeArena<OBJ, SLOTS>::make(Args&&... args){
+
+    if(free_places.empty()){
+
+        std::size_t before = heap_bytes();
+
+        std::unique_ptr<Block, BlockDeleter> fresh(
+            std::pmr::polymorphic_allocator<Block>(resource).template new_object<Block>(), BlockDeleter{resource}
+        );
+        Block& block = *blocks.emplace_back(std::move(fresh));
+
+        // The places are taken from the back, so a new block is filled in order.
+        for(std::size_t i = BLOCK; i > 0; --i)
+            free_places.push_back(&block[i - 1]);
+
+        count_bytes(before);
+    }
+
+    Place* place = free_places.back();
+    free_places.pop_back();
+    ++live;
+
+    pds::fpFatNode<OBJ, SLOTS>* node = &place->emplace(std::forward<Args>(args)..., resource, counts.get());
+
+    if(counts != nullptr)
+        pds::fpMemoryCounters::add(counts->nodes, 1);
+
+    return node;
+}
+
+template <class OBJ, class SLOTS>
+std::size_t pds::fpFatNodeArena<OBJ, SLOTS>::size() const noexcept {
+
+    return live;
+}
+
+template <class OBJ, class SLOTS>
+std::pmr::memory_resource* pds::fpFatNodeArena<OBJ, SLOTS>::get_resource() const noexcept {
+
+    return resource;
+}
+
+template <class OBJ, class SLOTS>
+std::size_t pds::fpFatNodeArena<OBJ, SLOTS>::heap_bytes() const noexcept {
+
+    return blocks.size() * sizeof(Block) + blocks.capacity() * sizeof(typename decltype(blocks)::value_type) 
+        + free_places.capacity() * sizeof(Place*) + (counts != nullptr ? sizeof(pds::fpMemoryCounters) : 0);
+}
+
+template <class OBJ, class SLOTS>
+pds::fpMemoryCounters* pds::fpFatNodeArena<OBJ, SLOTS>::counters() const noexcept {
+
+    return counts.get();
+}
+
+template <class OBJ, class SLOTS>
+template <class PRED>
+std::size_t pds::fpFatNodeArena<OBJ, SLOTS>::release_if(PRED&& dead){
+
+    std::size_t released = 0;
+    std::size_t before = heap_bytes();
+
+    for(std::unique_ptr<Block, BlockDeleter>& block : blocks){
+
+        for(Place& place : *block){
+
+            if(place.has_value() && dead(&*place)){
+
+                place.reset();
+                ++released;
+            }
+        }
+    }
+
+    std::erase_if(blocks, [](const std::unique_ptr<Block, BlockDeleter>& block){
+        return std::none_of(block->begin(), block->end(), [](const Place& place){ return place.has_value(); });
+    });
+
+    free_places.clear();
+
+    for(auto block = blocks.rbegin(); block != blocks.rend(); ++block){
+
+        for(std::size_t i = BLOCK; i > 0; --i){
+
+            if(!(**block)[i - 1].has_value())
+                free_places.push_back(&(**block)[i - 1]);
+        }
+    }
+    live -= released;
+
+    if(counts != nullptr)
+        pds::fpMemoryCounters::add(counts->nodes, -released);
+
+    count_bytes(before);
+
+    return released;
+}
+
+template <class OBJ, class SLOTS>
+template <class FUNC>
+void pds::fpFatNodeArena<OBJ, SLOTS>::for_each(FUNC&& func){
+
+    for(std::unique_ptr<Block, BlockDeleter>& block : blocks){
+
+        for(Place& place : *block){
+
+            if(place.has_value())
+                func(&*place);
+        }
+    }
+}
+
+template <class OBJ, class SLOTS>
+template <class FUNC>
+void pds::fpFatNodeArena<OBJ, SLOTS>::for_each(FUNC&& func) const {
+
+    for(const std::unique_ptr<Block, BlockDeleter>& block : blocks){
+
+        for(const Place& place : *block){
 
-    return versions_map.Find(version);
+            if(place.has_value())
+                func(&*place);
+        }
+    }
 }
 
 
-#endif /* FULLY_PERSISTENT_FAT_NODE_HPP */
\ No newline at end of file
+#endif /* FULLY_PERSISTENT_FAT_NODE_HPP */
@@ -0,0 +1,309 @@
+/**
+ * @file fpHashTrie.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief hash array mapped trie of the fully persistent hash set.
+ * @version 0.1
+ * @date 2025-02-24
+ */
+#ifndef FULLY_PERSISTENT_HASH_TRIE_HPP
+#define FULLY_PERSISTENT_HASH_TRIE_HPP
+
+#include "Utils.hpp"
+
+#include <bit>
+#include <memory>
+#include <memory_resource>
+
+namespace pds{
+
+    /// @brief An object of a hash set and its hash. Stored once, and pointed to by every version that has it.
+    template <class OBJ>
+    struct fpHashLeaf{
+        OBJ obj;
+        std::size_t hash;
+    };
+
+
+    /**
+     * @brief A branch of the trie: the entries of the 32 values of 5 bits of the hash, at one level.
+     *
+     * @details An entry is a leaf or a branch of the next level. Only the present entries are stored,
+     *  after the header, in the order of their bits: the bit of an entry is set in 'leaf_map' or in 'node_map',
+     *  and its index is the number of entries with a lower bit.
+     *  A branch below the last level of the hash holds leaves with equal hashes only, and no maps.
+     *
+     *  A branch is never changed once it was made, so any number of versions may share it.
+     */
+    struct alignas(void*) fpHashBranch{
+        std::uint32_t leaf_map;
+        std::uint32_t node_map;
+        std::uint32_t count;
+
+        const void** entries() noexcept { return reinterpret_cast<const void**>(this + 1); }
+        const void* const* entries() const noexcept { return reinterpret_cast<const void* const*>(this + 1); }
+    };
+
+
+    /**
+     * @class fpHashTrie
+     * @brief The operations of a persistent hash array mapped trie, on the branches that it owns.
+     *
+     * @details A version of the trie is its root branch (nullptr is the empty trie).
+     *  An update copies the branches on the path of the hash and shares all the others,
+     *  so it makes O(log32(K)) branches of up to 32 entries, and a lookup follows O(log32(K)) branches.
+     *  A branch that holds a single leaf is replaced by the leaf in its parent, so a trie has one shape
+     *  for its leaves, whatever the updates that made it were.
+     *
+     *  The branches are allocated from a monotonic buffer and freed together with the trie.
+     */
+    template <class OBJ>
+    class fpHashTrie{
+
+        using Leaf = pds::fpHashLeaf<OBJ>;
+        using Branch = pds::fpHashBranch;
+
+        static constexpr unsigned BITS = 5;
+        static constexpr unsigned HASH_BITS = 64;
+
+        std::unique_ptr<std::pmr::monotonic_buffer_resource> pool;
+
+        /// @brief a new branch with the maps and room for 'count' entries.
+        Branch* make(std::uint32_t leaf_map, std::uint32_t node_map, std::uint32_t count);
+
+        /// @brief a new branch with the entries of 'b', where the entry at 'index' is replaced with 'entry'.
+        Branch* replace(const Branch* b, std::uint32_t index, const void* entry);
+
+        /// @brief a branch at 'shift' with the two leaves 'x' and 'y' of different objects.
+        const Branch* pair(const Leaf* x, const Leaf* y, unsigned shift);
+
+        /// @brief the single leaf of 'b', or nullptr if it has more entries.
+        static const Leaf* single_leaf(const Branch* b) noexcept;
+
+        static std::uint32_t bit_of(std::size_t hash, unsigned shift) noexcept;
+
+    public:
+        fpHashTrie();
+
+        /// @brief the hash of an object in the trie: 'hash' mixed, so every 5 bits of it are spread.
+        static std::size_t mix(std::size_t hash) noexcept;
+
+        /// @brief the leaf of 'obj' in 'root', or nullptr. 'hash' is the mixed hash of 'obj'.
+        static const Leaf* find(const Branch* root, const OBJ& obj, std::size_t hash);
+
+        /// @brief the root of a new version with the leaves of 'root' and 'x', which must not be in 'root'.
+        const Branch* insert(const Branch* root, const Leaf* x, unsigned shift = 0);
+
+        /// @brief the root of a new version with the leaves of 'root' but 'x', which must be in 'root'.
+        const Branch* remove(const Branch* root, const Leaf* x, unsigned shift = 0);
+
+        /// @brief call 'func(obj)' for every object under 'root'.
+        template <class FUNC>
+        static void for_each(const Branch* root, FUNC&& func, unsigned shift = 0);
+    };
+};
+
+
+template <class OBJ>
+pds::fpHashTrie<OBJ>::fpHashTrie() : pool(std::make_unique<std::pmr::monotonic_buffer_resource>()) {
+}
+
+template <class OBJ>
+std::size_t pds::fpHashTrie<OBJ>::mix(std::size_t hash) noexcept {
+
+    // The splitmix64 finalizer is a bijection, so different hashes stay different.
+    std::uint64_t z = hash;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+template <class OBJ>
+std::uint32_t pds::fpHashTrie<OBJ>::bit_of(std::size_t hash, unsigned shift) noexcept {
+
+    return std::uint32_t(1) << ((hash >> shift) & ((1u << BITS) - 1));
+}
+
+template <class OBJ>
+pds::fpHashBranch* pds::fpHashTrie<OBJ>::make(std::uint32_t leaf_map, std::uint32_t node_map, std::uint32_t count){
+
+    void* memory = pool->allocate(sizeof(Branch) + count * sizeof(const void*), alignof(Branch));
+    return new (memory) Branch{leaf_map, node_map, count};
+}
+
+template <class OBJ>
+pds::fpHashBranch* pds::fpHashTrie<OBJ>::replace(const Branch* b, std::uint32_t index, const void* entry){
+
+    Branch* c = make(b->leaf_map, b->node_map, b->count);
+    std::copy(b->entries(), b->entries() + b->count, c->entries());
+    c->entries()[index] = entry;
+    return c;
+}
+
+template <class OBJ>
+const pds::fpHashBranch* pds::fpHashTrie<OBJ>::pair(const Leaf* x, const Leaf* y, unsigned shift){
+
+    if(shift >= HASH_BITS){
+
+        Branch* c = make(0, 0, 2);
+        c->entries()[0] = x;
+        c->entries()[1] = y;
+        return c;
+    }
+
+    std::uint32_t x_bit = bit_of(x->hash, shift);
+    std::uint32_t y_bit = bit_of(y->hash, shift);
+
+    if(x_bit == y_bit){
+
+        Branch* c = make(0, x_bit, 1);
+        c->entries()[0] = pair(x, y, shift + BITS);
+        return c;
+    }
+
+    Branch* c = make(x_bit | y_bit, 0, 2);
+    c->entries()[x_bit < y_bit ? 0 : 1] = x;
+    c->entries()[x_bit < y_bit ? 1 : 0] = y;
+    return c;
+}
+
+template <class OBJ>
+const pds::fpHashLeaf<OBJ>* pds::fpHashTrie<OBJ>::single_leaf(const Branch* b) noexcept {
+
+    return (b->count == 1 && b->node_map == 0) ? static_cast<const Leaf*>(b->entries()[0]) : nullptr;
+}
+
+template <class OBJ>
+const pds::fpHashLeaf<OBJ>* pds::fpHashTrie<OBJ>::find(const Branch* root, const OBJ& obj, std::size_t hash){
+
+    const Branch* b = root;
+
+    for(unsigned shift = 0; b != nullptr; shift += BITS){
+
+        if(shift >= HASH_BITS){
+
+            for(std::uint32_t i = 0; i < b->count; ++i){
+
+                const Leaf* leaf = static_cast<const Leaf*>(b->entries()[i]);
+
+                if(leaf->obj == obj)
+                    return leaf;
+            }
+            return nullptr;
+        }
+
+        std::uint32_t bit = bit_of(hash, shift);
+        std::uint32_t index = std::popcount((b->leaf_map | b->node_map) & (bit - 1));
+
+        if(b->leaf_map & bit){
+
+            const Leaf* leaf = static_cast<const Leaf*>(b->entries()[index]);
+            return (leaf->hash == hash && leaf->obj == obj) ? leaf : nullptr;
+        }
+
+        b = (b->node_map & bit) ? static_cast<const Branch*>(b->entries()[index]) : nullptr;
+    }
+    return nullptr;
+}
+
+template <class OBJ>
+const pds::fpHashBranch* pds::fpHashTrie<OBJ>::insert(const Branch* root, const Leaf* x, unsigned shift){
+
+    if(root == nullptr){
+
+        Branch* c = make(bit_of(x->hash, shift), 0, 1);
+        c->entries()[0] = x;
+        return c;
+    }
+
+    if(shift >= HASH_BITS){
+
+        Branch* c = make(0, 0, root->count + 1);
+        std::copy(root->entries(), root->entries() + root->count, c->entries());
+        c->entries()[root->count] = x;
+        return c;
+    }
+
+    std::uint32_t bit = bit_of(x->hash, shift);
+    std::uint32_t index = std::popcount((root->leaf_map | root->node_map) & (bit - 1));
+
+    if(root->node_map & bit)
+        return replace(root, index, insert(static_cast<const Branch*>(root->entries()[index]), x, shift + BITS));
+
+    if(root->leaf_map & bit){
+
+        // The leaf that holds the place moves down, together with 'x'.
+        Branch* c = replace(root, index, pair(static_cast<const Leaf*>(root->entries()[index]), x, shift + BITS));
+        c->leaf_map &= ~bit;
+        c->node_map |= bit;
+        return c;
+    }
+
+    Branch* c = make(root->leaf_map | bit, root->node_map, root->count + 1);
+    std::copy(root->entries(), root->entries() + index, c->entries());
+    c->entries()[index] = x;
+    std::copy(root->entries() + index, root->entries() + root->count, c->entries() + index + 1);
+    return c;
+}
+
+template <class OBJ>
+const pds::fpHashBranch* pds::fpHashTrie<OBJ>::remove(const Branch* root, const Leaf* x, unsigned shift){
+
+    std::uint32_t bit = 0;
+    std::uint32_t index = 0;
+
+    if(shift >= HASH_BITS){
+
+        while(root->entries()[index] != x)
+            ++index;
+    }
+    else{
+        bit = bit_of(x->hash, shift);
+        index = std::popcount((root->leaf_map | root->node_map) & (bit - 1));
+
+        if(root->node_map & bit){
+
+            const Branch* child = remove(static_cast<const Branch*>(root->entries()[index]), x, shift + BITS);
+            const Leaf* leaf = single_leaf(child);
+
+            if(leaf == nullptr)
+                return replace(root, index, child);
+
+            // A child with a single leaf is replaced by the leaf.
+            Branch* c = replace(root, index, leaf);
+            c->leaf_map |= bit;
+            c->node_map &= ~bit;
+            return c;
+        }
+    }
+
+    if(root->count == 1)
+        return nullptr;
+
+    Branch* c = make(root->leaf_map & ~bit, root->node_map, root->count - 1);
+    std::copy(root->entries(), root->entries() + index, c->entries());
+    std::copy(root->entries() + index + 1, root->entries() + root->count, c->entries() + index);
+    return c;
+}
+
+template <class OBJ>
+template <class FUNC>
+void pds::fpHashTrie<OBJ>::for_each(const Branch* root, FUNC&& func, unsigned shift){
+
+    if(root == nullptr)
+        return;
+
+    // The entries are in the order of their bits, and a branch below the last level has no bits.
+    std::uint32_t all = (shift < HASH_BITS) ? root->leaf_map | root->node_map : 0;
+
+    for(std::uint32_t i = 0; i < root->count; ++i, all &= all - 1){
+
+        if(root->node_map & all & (~all + 1))
+            for_each(static_cast<const Branch*>(root->entries()[i]), func, shift + BITS);
+        else
+            func(static_cast<const Leaf*>(root->entries()[i])->obj);
+    }
+}
+
+
+#endif /* FULLY_PERSISTENT_HASH_TRIE_HPP */
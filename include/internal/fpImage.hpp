@@ -0,0 +1,65 @@
+/**
+ * @file fpImage.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief the frozen layout of a fully persistent set, that is queried in place (see pds::fpSetImage).
+ * @version 0.1
+ * @date 2025-01-14
+ */
+#ifndef FULLY_PERSISTENT_IMAGE_HPP
+#define FULLY_PERSISTENT_IMAGE_HPP
+
+#include "Utils.hpp"
+
+namespace pds{
+
+    /// @brief The first 8 bytes of an image. see @ref fpSet::freeze.
+    const std::uint64_t image_magic = 0x3130474D49504650ULL;    // "PFPIMG01"
+
+    /**
+     * @brief The header at offset 0 of an image.
+     *
+     * @details An image is the header, the array of nodes and the array of slot entries.
+     *  Every fat pointer is a range of the entries, sorted by version, and a child is the
+     *  index of its node, so the image holds offsets only and can be mapped at any address.
+     *  The numbers are in the byte order of the machine that wrote the image.
+     */
+    struct fpImageHeader{
+        std::uint64_t magic;
+        std::uint64_t obj_size;         ///< sizeof(OBJ) of the writer.
+        std::uint64_t last_version;
+        std::uint64_t nodes;            ///< number of nodes.
+        std::uint64_t entries;          ///< number of slot entries, of all the fat pointers.
+        std::uint64_t nodes_offset;     ///< the nodes array, from the start of the image.
+        std::uint64_t entries_offset;   ///< the entries array, from the start of the image.
+        std::uint64_t root_begin;       ///< the root fat pointer: the entries [root_begin, root_end).
+        std::uint64_t root_end;
+    };
+
+    /// @brief One slot of a frozen fat pointer: like an entry of pds::fpFlatSlots.
+    struct fpImageEntry{
+        std::uint64_t version;
+        std::uint64_t slot;
+        std::uint64_t child;    ///< 0 for an empty subtree, otherwise the index of the node + 1.
+        std::uint64_t size;     ///< number of objects under 'child'.
+    };
+
+    /// @brief One frozen fat node. Its fat pointers are ranges of the entries.
+    template <class OBJ>
+    struct fpImageNode{
+        std::uint64_t left_begin;
+        std::uint64_t left_end;
+        std::uint64_t right_begin;
+        std::uint64_t right_end;
+        OBJ obj;
+    };
+
+    /// @brief 'offset' rounded up to the alignment of T.
+    template <class T>
+    constexpr std::uint64_t image_align(std::uint64_t offset){
+
+        return (offset + alignof(T) - 1) / alignof(T) * alignof(T);
+    }
+};
+
+#endif /* FULLY_PERSISTENT_IMAGE_HPP */
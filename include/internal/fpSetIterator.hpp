@@ -0,0 +1,289 @@
+/**
+ * @file fpSetIterator.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief ordered iterator over one version of the fully persistent set.
+ * @version 0.1
+ * @date 2024-11-27
+ */
+#ifndef FULLY_PERSISTENT_SET_ITERATOR_HPP
+#define FULLY_PERSISTENT_SET_ITERATOR_HPP
+
+#include "fpFatNode.hpp"
+
+#include <ranges>
+
+namespace pds{
+
+    /**
+     * @class fpSetIterator
+     * @brief Bidirectional iterator over the sorted objects of one version of a fpSet.
+     *
+     * @details The iterator keeps the path from the root of the version to the current node,
+     *  so moving to the next or previous object is amortized O(1) fat pointer lookups and
+     *  the objects are never copied.
+     *  A version that was created is never changed, so its iterators stay valid while the set lives,
+     *  except for the iterators of MasterVersion, which are invalidated by inserting a new object.
+     *
+     *  The end iterator has an empty path. Decrementing it moves to the last object.
+     */
+    template <class OBJ, class SLOTS>
+    class fpSetIterator{
+
+        /// @brief a node on the path and the slot that indexes its children.
+        struct Step{
+            pds::fpFatNode<OBJ, SLOTS>* node;
+            pds::version_t key;
+            bool right;     ///< the node is the right child of the step before it.
+
+            bool operator==(const Step&) const = default;
+        };
+
+        pds::fpFatNodePtr<OBJ, SLOTS>* root;
+        pds::version_t version;
+        std::vector<Step> path;
+
+        /// @brief push the View of 'version' in 'field'. return false if it is empty.
+        bool push(pds::fpFatNodePtr<OBJ, SLOTS>& field, pds::version_t key);
+
+        void push_leftmost(pds::fpFatNodePtr<OBJ, SLOTS>& field, pds::version_t key);
+        void push_rightmost(pds::fpFatNodePtr<OBJ, SLOTS>& field, pds::version_t key);
+
+        template <class LESS>
+        void seek(LESS&& less_than_target);
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = OBJ;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const OBJ*;
+        using reference = const OBJ&;
+
+        fpSetIterator();
+
+        /// @brief the end iterator of 'version'. 'version' must exist.
+        fpSetIterator(pds::fpFatNodePtr<OBJ, SLOTS>& root, pds::version_t version);
+
+        /// @brief the first object of 'version'.
+        static fpSetIterator first(pds::fpFatNodePtr<OBJ, SLOTS>& root, pds::version_t version);
+
+        /**
+         * @brief the first object of 'version' that is not less than 'key' by 'compare', the order of the set.
+         * @details 'key' is an OBJ, or any type that 'compare' compares with OBJ.
+         */
+        template <class COMPARE = std::less<>, class KEY>
+        static fpSetIterator lower_bound(pds::fpFatNodePtr<OBJ, SLOTS>& root, pds::version_t version, const KEY& key,
+                                         const COMPARE& compare = COMPARE());
+
+        /// @brief the first object of 'version' that is greater than 'key'. see @ref lower_bound.
+        template <class COMPARE = std::less<>, class KEY>
+        static fpSetIterator upper_bound(pds::fpFatNodePtr<OBJ, SLOTS>& root, pds::version_t version, const KEY& key,
+                                         const COMPARE& compare = COMPARE());
+
+        reference operator*() const;
+        pointer operator->() const;
+
+        fpSetIterator& operator++();
+        fpSetIterator operator++(int);
+        fpSetIterator& operator--();
+        fpSetIterator operator--(int);
+
+        bool operator==(const fpSetIterator& other) const;
+    };
+};
+
+
+template <class OBJ, class SLOTS>
+pds::fpSetIterator<OBJ, SLOTS>::fpSetIterator() : root(nullptr), version(MasterVersion) {
+}
+
+template <class OBJ, class SLOTS>
+pds::fpSetIterator<OBJ, SLOTS>::fpSetIterator(pds::fpFatNodePtr<OBJ, SLOTS>& root, pds::version_t version)
+
+    : root(&root), version(version) {
+}
+
+template <class OBJ, class SLOTS>
+bool pds::fpSetIterator<OBJ, SLOTS>::push(pds::fpFatNodePtr<OBJ, SLOTS>& field, pds::version_t key){
+
+    pds::fpChild<OBJ, SLOTS>* child = field.resolve(key, key);
+
+    assert(child != nullptr);
+
+    if(child->node == nullptr)
+        return false;
+
+    path.push_back(Step{child->node, key, !path.empty() && &field == &path.back().node->right});
+    return true;
+}
+
+template <class OBJ, class SLOTS>
+void pds::fpSetIterator<OBJ, SLOTS>::push_leftmost(pds::fpFatNodePtr<OBJ, SLOTS>& field, pds::version_t key){
+
+    for(pds::fpFatNodePtr<OBJ, SLOTS>* next = &field; push(*next, key); next = &path.back().node->left){
+
+        key = path.back().key;
+    }
+}
+
+template <class OBJ, class SLOTS>
+void pds::fpSetIterator<OBJ, SLOTS>::push_rightmost(pds::fpFatNodePtr<OBJ, SLOTS>& field, pds::version_t key){
+
+    for(pds::fpFatNodePtr<OBJ, SLOTS>* next = &field; push(*next, key); next = &path.back().node->right){
+
+        key = path.back().key;
+    }
+}
+
+template <class OBJ, class SLOTS>
+template <class LESS>
+void pds::fpSetIterator<OBJ, SLOTS>::seek(LESS&& less_than_target){
+
+    // The path to the answer is a prefix of the search path.
+    std::size_t found = 0;
+
+    pds::fpFatNodePtr<OBJ, SLOTS>* next = root;
+    pds::version_t key = version;
+
+    while(push(*next, key)){
+
+        Step& step = path.back();
+        key = step.key;
+
+        if(less_than_target(step.node->get_obj())){
+
+            next = &step.node->right;
+        }
+        else{
+            found = path.size();
+            next = &step.node->left;
+        }
+    }
+    path.resize(found);
+}
+
+template <class OBJ, class SLOTS>
+pds::fpSetIterator<OBJ, SLOTS> pds::fpSetIterator<OBJ, SLOTS>::first(pds::fpFatNodePtr<OBJ, SLOTS>& root, pds::version_t version){
+
+    fpSetIterator it(root, version);
+    it.push_leftmost(root, version);
+    return it;
+}
+
+template <class OBJ, class SLOTS>
+template <class COMPARE, class KEY>
+pds::fpSetIterator<OBJ, SLOTS> pds::fpSetIterator<OBJ, SLOTS>::lower_bound(
+    pds::fpFatNodePtr<OBJ, SLOTS>& root, pds::version_t version, const KEY& key, const COMPARE& compare){
+
+    fpSetIterator it(root, version);
+    it.seek([&key, &compare](const OBJ& node_obj){ return compare(node_obj, key); });
+    return it;
+}
+
+template <class OBJ, class SLOTS>
+template <class COMPARE, class KEY>
+pds::fpSetIterator<OBJ, SLOTS> pds::fpSetIterator<OBJ, SLOTS>::upper_bound(
+    pds::fpFatNodePtr<OBJ, SLOTS>& root, pds::version_t version, const KEY& key, const COMPARE& compare){
+
+    fpSetIterator it(root, version);
+    it.seek([&key, &compare](const OBJ& node_obj){ return !compare(key, node_obj); });
+    return it;
+}
+
+template <class OBJ, class SLOTS>
+typename pds::fpSetIterator<OBJ, SLOTS>::reference pds::fpSetIterator<OBJ, SLOTS>::operator*() const {
+
+    assert(!path.empty());
+    return path.back().node->get_obj();
+}
+
+template <class OBJ, class SLOTS>
+typename pds::fpSetIterator<OBJ, SLOTS>::pointer pds::fpSetIterator<OBJ, SLOTS>::operator->() const {
+
+    return &**this;
+}
+
+template <class OBJ, class SLOTS>
+pds::fpSetIterator<OBJ, SLOTS>& pds::fpSetIterator<OBJ, SLOTS>::operator++(){
+
+    assert(!path.empty());
+
+    Step curr = path.back();
+    std::size_t depth = path.size();
+
+    push_leftmost(curr.node->right, curr.key);
+
+    if(path.size() > depth)
+        return *this;
+
+    // No right subtree: the next object is the closest ancestor whose left subtree was left.
+    // The path and not the order finds it, so it works for a sequence as well (see @ref pds::fpList).
+    bool from_right;
+    do{
+        from_right = path.back().right;
+        path.pop_back();
+    }
+    while(!path.empty() && from_right);
+
+    return *this;
+}
+
+template <class OBJ, class SLOTS>
+pds::fpSetIterator<OBJ, SLOTS> pds::fpSetIterator<OBJ, SLOTS>::operator++(int){
+
+    fpSetIterator old = *this;
+    ++*this;
+    return old;
+}
+
+template <class OBJ, class SLOTS>
+pds::fpSetIterator<OBJ, SLOTS>& pds::fpSetIterator<OBJ, SLOTS>::operator--(){
+
+    if(path.empty()){
+
+        push_rightmost(*root, version);
+        return *this;
+    }
+
+    Step curr = path.back();
+    std::size_t depth = path.size();
+
+    push_rightmost(curr.node->left, curr.key);
+
+    if(path.size() > depth)
+        return *this;
+
+    // No left subtree: the previous object is the closest ancestor whose right subtree was left.
+    bool from_left;
+    do{
+        from_left = !path.back().right;
+        path.pop_back();
+    }
+    while(!path.empty() && from_left);
+
+    return *this;
+}
+
+template <class OBJ, class SLOTS>
+pds::fpSetIterator<OBJ, SLOTS> pds::fpSetIterator<OBJ, SLOTS>::operator--(int){
+
+    fpSetIterator old = *this;
+    --*this;
+    return old;
+}
+
+template <class OBJ, class SLOTS>
+bool pds::fpSetIterator<OBJ, SLOTS>::operator==(const fpSetIterator& other) const {
+
+    if(path.empty() || other.path.empty())
+        return path.empty() && other.path.empty();
+
+    if(path.back().node != other.path.back().node)
+        return false;
+
+    // A sequence may hold a subtree twice in one version, so the same node is not the same position.
+    return path == other.path;
+}
+
+
+#endif /* FULLY_PERSISTENT_SET_ITERATOR_HPP */
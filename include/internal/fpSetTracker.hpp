@@ -5,36 +5,62 @@
 
 namespace pds{
 
-    template <class OBJ>
+    /**
+     * @class fpSetTracker
+     * @brief Walks over one version of a fpSet tree.
+     *
+     * @tparam CHECKED 
+     *  - true (default): every call validates the tracked slot and throws on failure.
+     *  - false: the version was validated at the API boundary, so the tracker only asserts
+     *      (in debug builds) and does a single lookup per level without exception machinery.
+     */
+    template <class OBJ, class SLOTS = pds::fpHashSlots, bool CHECKED = true>
     class fpSetTracker{
 
-        pds::fpFatNodePtr<OBJ>* ptr;
+        using node_ptr = pds::fpFatNode<OBJ, SLOTS>*;
+        using child_t = pds::fpChild<OBJ, SLOTS>;
+
+        pds::fpFatNodePtr<OBJ, SLOTS>* ptr;
         pds::version_t track_version;
 
-    public:
-        fpSetTracker(pds::fpFatNodePtr<OBJ>& root, pds::version_t version);
+        /* 
+            The node of 'track_version', resolved once on every move, so reading the 
+            tracked node does not look up the table again.
+            Writing to the table of 'track_version' itself (only MasterVersion does it)
+            is seen by a checked operator* but not by the cached node.
+        */
+        pds::fpFatNode<OBJ, SLOTS>* node;
+        std::size_t subtree_size;
+        bool exist;     ///< false if 'track_version' has no slot in 'ptr'.
 
-        std::shared_ptr<pds::fpFatNode<OBJ>>& operator[](const pds::version_t new_version);
+        void resolve(const child_t* value);
+        void move_to(pds::fpFatNodePtr<OBJ, SLOTS>& child, const char* func_name);
 
-        std::shared_ptr<pds::fpFatNode<OBJ>> operator*() const;
+        pds::fpFatNodePtr<OBJ, SLOTS>& left_ptr(const char* func_name) const;
+        pds::fpFatNodePtr<OBJ, SLOTS>& right_ptr(const char* func_name) const;
 
-        const OBJ& obj() const;
+    public:
+        fpSetTracker(pds::fpFatNodePtr<OBJ, SLOTS>& root, pds::version_t version);
 
-        fpSetTracker<OBJ>& left();
-        fpSetTracker<OBJ>& right();
+        node_ptr operator*() const;
 
-        void add_left_map(const pds::version_t new_version);
-        void add_right_map(const pds::version_t new_version);
+        const OBJ& obj() const;
 
-        std::shared_ptr<fpFatNode<OBJ>> get_left() const;
-        std::shared_ptr<fpFatNode<OBJ>> get_right() const;
+        fpSetTracker& left();
+        fpSetTracker& right();
 
-        std::shared_ptr<fpFatNode<OBJ>>& set_left_at(const pds::version_t new_version);
-        std::shared_ptr<fpFatNode<OBJ>>& set_right_at(const pds::version_t new_version);
+        node_ptr get_left() const;
+        node_ptr get_right() const;
 
         bool null() const;
         bool not_null() const;
 
+        /// @brief number of objects in the tracked subtree.
+        std::size_t size() const;
+
+        /// @brief number of objects in the left subtree of the tracked node.
+        std::size_t left_size() const;
+
         bool left_null() const;
         bool left_not_null() const;
         bool right_null() const;
@@ -42,186 +68,208 @@ namespace pds{
     };
 };
 
-template <class OBJ>
-pds::fpSetTracker<OBJ>::fpSetTracker(pds::fpFatNodePtr<OBJ>& root, pds::version_t version) 
+template <class OBJ, class SLOTS, bool CHECKED>
+pds::fpSetTracker<OBJ, SLOTS, CHECKED>::fpSetTracker(pds::fpFatNodePtr<OBJ, SLOTS>& root, pds::version_t version) 
         
     : ptr(&root), track_version(version) {
+
+    // The root of a version may share the slot of another version (e.g. an empty batch).
+    resolve(ptr->resolve(version, track_version));
 }
 
-template <class OBJ>
-std::shared_ptr<pds::fpFatNode<OBJ>>& pds::fpSetTracker<OBJ>::operator[](const pds::version_t new_version){
+template <class OBJ, class SLOTS, bool CHECKED>
+void pds::fpSetTracker<OBJ, SLOTS, CHECKED>::resolve(const child_t* value){
+
+    exist = value != nullptr;
+    node = exist ? value->node : nullptr;
+    subtree_size = exist ? value->size : 0;
+}
 
-    if(new_version != MasterVersion){
+template <class OBJ, class SLOTS, bool CHECKED>
+void pds::fpSetTracker<OBJ, SLOTS, CHECKED>::move_to(pds::fpFatNodePtr<OBJ, SLOTS>& child, const char* func_name){
 
-        ptr->versions_map.add(new_version);
-    }
-    return ptr->table[new_version];
+    child_t* value = child.resolve(track_version, track_version);
+
+    if constexpr(!CHECKED)
+        assert(value != nullptr);
+
+    else if(value == nullptr)
+        throw pds::VersionNotExist("fat_node_tracker::" 
+            + std::string(func_name) + ": Version " + std::to_string(track_version) + " has no parent");
+
+    ptr = &child;
+    resolve(value);
 }
 
-template <class OBJ>
-std::shared_ptr<pds::fpFatNode<OBJ>> pds::fpSetTracker<OBJ>::operator*() const {
+template <class OBJ, class SLOTS, bool CHECKED>
+pds::fpFatNodePtr<OBJ, SLOTS>& pds::fpSetTracker<OBJ, SLOTS, CHECKED>::left_ptr(const char* func_name) const {
 
-    try{
-        return ptr->table.at(track_version);
+    PDS_CHECK_NULL_TRACKER_NODE(func_name);
+
+    return node->left;
+}
+
+template <class OBJ, class SLOTS, bool CHECKED>
+pds::fpFatNodePtr<OBJ, SLOTS>& pds::fpSetTracker<OBJ, SLOTS, CHECKED>::right_ptr(const char* func_name) const {
+
+    PDS_CHECK_NULL_TRACKER_NODE(func_name);
+
+    return node->right;
+}
+
+template <class OBJ, class SLOTS, bool CHECKED>
+typename pds::fpSetTracker<OBJ, SLOTS, CHECKED>::node_ptr pds::fpSetTracker<OBJ, SLOTS, CHECKED>::operator*() const {
+
+    if constexpr(!CHECKED){
+
+        assert(exist);
+        return node;
     }
-    catch(const std::out_of_range&){
 
+    child_t* child = ptr->find(track_version);
+
+    if(child == nullptr)
         throw pds::VersionNotExist(
             "fpSetTracker::operator*: Version " + std::to_string(track_version) + " is not exist"
         );
-    }
+
+    return child->node;
 }
 
-template <class OBJ>
-bool pds::fpSetTracker<OBJ>::null() const {
+template <class OBJ, class SLOTS, bool CHECKED>
+bool pds::fpSetTracker<OBJ, SLOTS, CHECKED>::null() const {
     
-    try{
-        return ptr->table.at(track_version) == nullptr;
-    }
-    catch(const std::out_of_range&){
+    if constexpr(!CHECKED)
+        assert(exist);
 
+    else if(!exist)
         throw pds::VersionNotExist(
             "fpSetTracker::null: Version " + std::to_string(track_version) + " is not exist"
         );
-    }
+
+    return node == nullptr;
 }
 
-template <class OBJ>
-bool pds::fpSetTracker<OBJ>::not_null() const {
+template <class OBJ, class SLOTS, bool CHECKED>
+bool pds::fpSetTracker<OBJ, SLOTS, CHECKED>::not_null() const {
 
-    try{
-        return ptr->table.at(track_version) != nullptr;
-    }
-    catch(const std::out_of_range&){
+    if constexpr(!CHECKED)
+        assert(exist);
 
+    else if(!exist)
         throw pds::VersionNotExist(
             "fpSetTracker::not_null: Version " + std::to_string(track_version) + " is not exist"
         );
-    }
+
+    return node != nullptr;
 }
 
-template <class OBJ>
-const OBJ& pds::fpSetTracker<OBJ>::obj() const {
+template <class OBJ, class SLOTS, bool CHECKED>
+std::size_t pds::fpSetTracker<OBJ, SLOTS, CHECKED>::size() const {
 
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("obj", track_version);
+    if constexpr(!CHECKED)
+        assert(exist);
 
-    return ptr->table.at(track_version)->get_obj();
+    else if(!exist)
+        throw pds::VersionNotExist(
+            "fpSetTracker::size: Version " + std::to_string(track_version) + " is not exist"
+        );
+
+    return subtree_size;
 }
 
-template <class OBJ>
-void pds::fpSetTracker<OBJ>::add_left_map(const pds::version_t new_version){
+template <class OBJ, class SLOTS, bool CHECKED>
+std::size_t pds::fpSetTracker<OBJ, SLOTS, CHECKED>::left_size() const {
 
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("add_left_map", new_version);
+    pds::version_t key;
+    const child_t* left = left_ptr("left_size").resolve(track_version, key);
 
-    ptr->table.at(new_version)->left.versions_map.add(new_version);
-    ptr->table.at(new_version)->left.versions_map.Union(new_version, track_version);
-}
+    if constexpr(!CHECKED)
+        assert(left != nullptr);
 
-template <class OBJ>
-void pds::fpSetTracker<OBJ>::add_right_map(const pds::version_t new_version){
+    else if(left == nullptr)
+        throw pds::VersionNotExist("fat_node_tracker::left_size: Version " 
+            + std::to_string(track_version) + " has no parent");
 
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("add_right_map", new_version);
-    
-    ptr->table.at(new_version)->right.versions_map.add(new_version);
-    ptr->table.at(new_version)->right.versions_map.Union(new_version, track_version);
+    return left->size;
 }
 
-template <class OBJ>
-pds::fpSetTracker<OBJ>& pds::fpSetTracker<OBJ>::left(){
+template <class OBJ, class SLOTS, bool CHECKED>
+const OBJ& pds::fpSetTracker<OBJ, SLOTS, CHECKED>::obj() const {
 
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("left", track_version);
-    
-    ptr = &(ptr->table.at(track_version)->left);
-    track_version = ptr->map(track_version);
-    return *this;
+    PDS_CHECK_NULL_TRACKER_NODE("obj");
+
+    return node->get_obj();
 }
 
-template <class OBJ>
-pds::fpSetTracker<OBJ>& pds::fpSetTracker<OBJ>::right(){
+template <class OBJ, class SLOTS, bool CHECKED>
+pds::fpSetTracker<OBJ, SLOTS, CHECKED>& pds::fpSetTracker<OBJ, SLOTS, CHECKED>::left(){
 
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("right", track_version);
-    
-    ptr = &(ptr->table.at(track_version)->right);
-    track_version = ptr->map(track_version);
+    move_to(left_ptr("left"), "left");
     return *this;
 }
 
-template <class OBJ>
-bool pds::fpSetTracker<OBJ>::left_null() const {
-
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("left_null", track_version);
+template <class OBJ, class SLOTS, bool CHECKED>
+pds::fpSetTracker<OBJ, SLOTS, CHECKED>& pds::fpSetTracker<OBJ, SLOTS, CHECKED>::right(){
 
-    pds::fpFatNodePtr<OBJ>* left_ptr = &(ptr->table.at(track_version)->left);
-
-    return left_ptr->table.at(left_ptr->map(track_version)) == nullptr;
+    move_to(right_ptr("right"), "right");
+    return *this;
 }
 
-template <class OBJ>
-bool pds::fpSetTracker<OBJ>::right_null() const {
+template <class OBJ, class SLOTS, bool CHECKED>
+bool pds::fpSetTracker<OBJ, SLOTS, CHECKED>::left_null() const {
 
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("right_null", track_version);
-
-    pds::fpFatNodePtr<OBJ>* right_ptr = &(ptr->table.at(track_version)->right);
-
-    return right_ptr->table.at(right_ptr->map(track_version)) == nullptr;
+    return get_left() == nullptr;
 }
 
-template <class OBJ>
-bool pds::fpSetTracker<OBJ>::left_not_null() const {
-
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("left_not_null", track_version);
+template <class OBJ, class SLOTS, bool CHECKED>
+bool pds::fpSetTracker<OBJ, SLOTS, CHECKED>::right_null() const {
 
-    pds::fpFatNodePtr<OBJ>* left_ptr = &(ptr->table.at(track_version)->left);
-
-    return left_ptr->table.at(left_ptr->map(track_version)) != nullptr;
+    return get_right() == nullptr;
 }
 
-template <class OBJ>
-bool pds::fpSetTracker<OBJ>::right_not_null() const {
+template <class OBJ, class SLOTS, bool CHECKED>
+bool pds::fpSetTracker<OBJ, SLOTS, CHECKED>::left_not_null() const {
 
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("right_not_null", track_version);
+    return get_left() != nullptr;
+}
 
-    pds::fpFatNodePtr<OBJ>* right_ptr = &(ptr->table.at(track_version)->right);
+template <class OBJ, class SLOTS, bool CHECKED>
+bool pds::fpSetTracker<OBJ, SLOTS, CHECKED>::right_not_null() const {
 
-    return right_ptr->table.at(right_ptr->map(track_version)) != nullptr;
+    return get_right() != nullptr;
 }
 
-template <class OBJ>
-std::shared_ptr<pds::fpFatNode<OBJ>> pds::fpSetTracker<OBJ>::get_left() const {
-
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("get_left", track_version);
+template <class OBJ, class SLOTS, bool CHECKED>
+typename pds::fpSetTracker<OBJ, SLOTS, CHECKED>::node_ptr pds::fpSetTracker<OBJ, SLOTS, CHECKED>::get_left() const {
 
-    pds::fpFatNodePtr<OBJ>* left_ptr = &(ptr->table.at(track_version)->left);
-    return left_ptr->table.at(left_ptr->map(track_version));
-}
+    pds::version_t key;
+    const child_t* left = left_ptr("get_left").resolve(track_version, key);
 
-template <class OBJ>
-std::shared_ptr<pds::fpFatNode<OBJ>> pds::fpSetTracker<OBJ>::get_right() const {
+    if constexpr(!CHECKED)
+        assert(left != nullptr);
 
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("get_right", track_version);
+    else if(left == nullptr)
+        throw pds::VersionNotExist("fpSetTracker::get_left: Version " 
+            + std::to_string(track_version) + " has no parent");
 
-    pds::fpFatNodePtr<OBJ>* right_ptr = &(ptr->table.at(track_version)->right);
-    return right_ptr->table.at(right_ptr->map(track_version));
+    return left->node;
 }
 
-template <class OBJ>
-std::shared_ptr<pds::fpFatNode<OBJ>>& pds::fpSetTracker<OBJ>::set_left_at(const pds::version_t new_version){
-
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("set_left_at", new_version);
+template <class OBJ, class SLOTS, bool CHECKED>
+typename pds::fpSetTracker<OBJ, SLOTS, CHECKED>::node_ptr pds::fpSetTracker<OBJ, SLOTS, CHECKED>::get_right() const {
 
-    pds::fpFatNodePtr<OBJ>* left_ptr = &(ptr->table.at(new_version)->left);
-    left_ptr->versions_map.add(new_version);
-    return left_ptr->table[new_version];
-}
+    pds::version_t key;
+    const child_t* right = right_ptr("get_right").resolve(track_version, key);
 
-template <class OBJ>
-std::shared_ptr<pds::fpFatNode<OBJ>>& pds::fpSetTracker<OBJ>::set_right_at(const pds::version_t new_version){
+    if constexpr(!CHECKED)
+        assert(right != nullptr);
 
-    PDS_THROW_IF_TRACK_VERSION_NOT_EXIST("set_right_at", new_version);
+    else if(right == nullptr)
+        throw pds::VersionNotExist("fpSetTracker::get_right: Version " 
+            + std::to_string(track_version) + " has no parent");
 
-    pds::fpFatNodePtr<OBJ>* right_ptr = &(ptr->table.at(new_version)->right);
-    right_ptr->versions_map.add(new_version);
-    return right_ptr->table[new_version];
+    return right->node;
 }
 
-#endif /* FULLY_PERSISTENT_SET_TRACKER_HPP */
\ No newline at end of file
+#endif /* FULLY_PERSISTENT_SET_TRACKER_HPP */
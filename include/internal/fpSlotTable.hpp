@@ -0,0 +1,1127 @@
+/**
+ * @file fpSlotTable.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief storage engines for the version slots of a fully persistent fat pointer.
+ * @version 0.1
+ * @date 2024-11-12
+ */
+#ifndef FULLY_PERSISTENT_SLOT_TABLE_HPP
+#define FULLY_PERSISTENT_SLOT_TABLE_HPP
+
+#include "Utils.hpp"
+#include "fpVersionIndex.hpp"
+
+namespace pds{
+
+    /**
+     * @brief Slot engine tag: a 'std::unordered_map' of slots and a 'pds::fpVersionIndex'
+     *  that maps every version to the slot it shares.
+     */
+    struct fpHashSlots{};
+
+
+    /**
+     * @brief Slot engine tag: a sorted small-vector of (version, slot, value) entries.
+     *
+     * @details The first 'INLINE' entries are stored inside the fat pointer itself,
+     *  more entries fall back to one heap block.
+     *  Every entry keeps its resolved slot, so a lookup is a single search
+     *  without hashing and without mutating the table.
+     *
+     * @tparam INLINE number of entries stored inline.
+     */
+    template <std::size_t INLINE = 2>
+    struct fpFlatSlots{};
+
+
+    /**
+     * @brief Slot engine tag: the flat engine for one writer thread and many reader threads.
+     *
+     * @details The entries are only appended, and an entry that was published never moves:
+     *  when a block is full, its entries are copied to a block twice as big that is published 
+     *  atomically, and the old block stays alive (until the table is destroyed) for the readers 
+     *  that still hold it. A lookup only loads from the table, so the versions that the writer 
+     *  already returned can be read by any number of threads while it creates the next ones.
+     *
+     * @tparam INLINE number of entries stored inline.
+     */
+    template <std::size_t INLINE = 2>
+    struct fpConcurrentSlots{};
+
+
+    /**
+     * @brief The running totals of the memory of one set: its arena and its slot tables add every change 
+     *  to them when they make it, so @ref pds::fpSet::memory_stats reads them in O(1).
+     *
+     * @details Only the writer thread changes them, so a change is a plain load and store, and a reader
+     *  may load every total at any time (but not all of them at once).
+     */
+    struct fpMemoryCounters{
+        std::atomic<std::size_t> nodes = 0;         ///< fat nodes of the arena.
+        std::atomic<std::size_t> node_bytes = 0;    ///< the blocks and the lists of the arena, and these counters.
+        std::atomic<std::size_t> slots = 0;         ///< versions of the counted slot tables.
+        std::atomic<std::size_t> slot_bytes = 0;    ///< see @ref pds::fpSlotTable::heap_bytes.
+        std::atomic<std::size_t> index_bytes = 0;   ///< see @ref pds::fpSlotTable::index_bytes.
+
+        /// @brief adds 'delta' to 'total', modulo 2^64 so a delta may take away. Only the writer thread.
+        static void add(std::atomic<std::size_t>& total, std::size_t delta) noexcept {
+
+            if(delta != 0)
+                total.store(total.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+
+        /// @brief adds what 'table' holds to the totals.
+        template <class TABLE>
+        void count_in(const TABLE& table) noexcept {
+
+            add(slots, table.versions());
+            add(slot_bytes, table.heap_bytes());
+            add(index_bytes, table.index_bytes());
+        }
+
+        /// @brief takes what 'table' holds from the totals.
+        template <class TABLE>
+        void count_out(const TABLE& table) noexcept {
+
+            add(slots, -table.versions());
+            add(slot_bytes, -table.heap_bytes());
+            add(index_bytes, -table.index_bytes());
+        }
+    };
+
+
+    /**
+     * @brief Adds to the counters of a slot table what the table changed between the construction
+     *  and the destruction of the guard. A table without counters (nullptr) is not counted.
+     */
+    template <class TABLE>
+    class fpCountGuard{
+        const TABLE& table;
+        pds::fpMemoryCounters* counters;
+        std::size_t slots = 0, slot_bytes = 0, index_bytes = 0;
+    public:
+        fpCountGuard(const TABLE& table, pds::fpMemoryCounters* counters) noexcept : table(table), counters(counters) {
+
+            if(counters != nullptr){
+
+                slots = table.versions();
+                slot_bytes = table.heap_bytes();
+                index_bytes = table.index_bytes();
+            }
+        }
+
+        fpCountGuard(const fpCountGuard&) = delete;
+        fpCountGuard& operator=(const fpCountGuard&) = delete;
+
+        ~fpCountGuard(){
+
+            if(counters != nullptr){
+
+                pds::fpMemoryCounters::add(counters->slots, table.versions() - slots);
+                pds::fpMemoryCounters::add(counters->slot_bytes, table.heap_bytes() - slot_bytes);
+                pds::fpMemoryCounters::add(counters->index_bytes, table.index_bytes() - index_bytes);
+            }
+        }
+    };
+
+
+    /**
+     * @class fpSlotTable
+     * @brief Maps every version that passes through a fat pointer to its slot.
+     *
+     * @details A slot is the version that owns a value in the table.
+     *  Other versions may share it with @ref alias.
+     *  The mapping of a version never changes once it was added, and the value of a slot
+     *  is sealed once its version was created (except for MasterVersion).
+     *
+     * @tparam T the value type of a slot. Must be default constructible.
+     * @tparam SLOTS the engine tag: pds::fpHashSlots or pds::fpFlatSlots.
+     *
+     *  Every engine allocates from the memory resource that it was constructed with,
+     *  which must outlive the table. A table that was given pds::fpMemoryCounters keeps them up to date 
+     *  with its versions and its bytes until it is destroyed or moved from, so they must outlive it too.
+     */
+    template <class T, class SLOTS>
+    class fpSlotTable;
+
+
+    template <class T>
+    class fpSlotTable<T, pds::fpHashSlots>{
+
+        std::pmr::unordered_map<pds::version_t, T> table;
+        pds::fpVersionIndex versions_map;
+        pds::fpMemoryCounters* counters;
+
+    public:
+        explicit fpSlotTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+                             pds::fpMemoryCounters* counters = nullptr);
+        fpSlotTable(const fpSlotTable&) = delete;
+        fpSlotTable& operator=(const fpSlotTable&) = delete;
+
+        /// @brief the counters of 'other' move with its slots.
+        fpSlotTable(fpSlotTable&& other) noexcept;
+        fpSlotTable& operator=(fpSlotTable&& other);
+        ~fpSlotTable();
+
+        /// @brief map 'version' to its slot. throws pds::VersionNotExist if 'version' is unknown.
+        pds::version_t map(const pds::version_t version);
+
+        /// @brief the value of 'slot', or nullptr if 'slot' not exists.
+        T* find(const pds::version_t slot);
+        const T* find(const pds::version_t slot) const;
+
+        /// @brief map 'version' to 'slot' and return its value, or nullptr if 'version' is unknown.
+        T* resolve(const pds::version_t version, pds::version_t& slot);
+        const T* resolve(const pds::version_t version, pds::version_t& slot) const;
+
+        /// @brief add 'version' as a slot of its own.
+        T& slot(const pds::version_t version);
+
+        /// @brief 'version' will share the slot of 'target'.
+        void alias(const pds::version_t version, const pds::version_t target);
+
+        /// @brief 'version' will share 'slot' of another fat pointer, whose value is 'value'.
+        void adopt(const pds::version_t version, const pds::version_t slot, const T& value);
+
+        /// @brief number of versions in the table (MasterVersion included).
+        std::size_t versions() const noexcept;
+
+        /// @brief bytes of the slots that the table allocated: the nodes and the buckets of the hash table.
+        std::size_t heap_bytes() const noexcept;
+
+        /// @brief bytes of the versions map.
+        std::size_t index_bytes() const noexcept;
+
+        /// @brief drop the versions for which 'keep(version)' is false. A slot that no kept version maps to is freed.
+        template <class PRED>
+        void retain_if(PRED&& keep);
+
+        /// @brief call 'func(version, slot, value)' for every version in the table, in order.
+        template <class FUNC>
+        void for_each(FUNC&& func) const;
+    };
+
+
+    template <class T, std::size_t INLINE>
+    class fpSlotTable<T, pds::fpFlatSlots<INLINE>>{
+
+        static_assert(INLINE > 0, "fpFlatSlots: INLINE must be positive");
+
+        struct Entry{
+            pds::version_t version;
+            pds::version_t slot;
+            T value;
+        };
+
+        std::size_t count = 0;
+        std::array<Entry, INLINE> inline_entries;
+        std::pmr::vector<Entry> heap_entries;   ///< in use only after spilling the inline entries.
+        pds::fpMemoryCounters* counters;
+
+        Entry* data();
+        const Entry* data() const;
+        Entry* find_entry(const pds::version_t version);
+        const Entry* find_entry(const pds::version_t version) const;
+        Entry& add_entry(const pds::version_t version);
+
+    public:
+        explicit fpSlotTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+                             pds::fpMemoryCounters* counters = nullptr);
+        fpSlotTable(const fpSlotTable&) = delete;
+        fpSlotTable& operator=(const fpSlotTable&) = delete;
+
+        /// @brief the counters of 'other' move with its entries.
+        fpSlotTable(fpSlotTable&& other) noexcept;
+        fpSlotTable& operator=(fpSlotTable&& other);
+        ~fpSlotTable();
+
+        /// @brief map 'version' to its slot. throws pds::VersionNotExist if 'version' is unknown.
+        pds::version_t map(const pds::version_t version);
+
+        /// @brief the value of 'slot', or nullptr if 'slot' not exists.
+        T* find(const pds::version_t slot);
+        const T* find(const pds::version_t slot) const;
+
+        /// @brief map 'version' to 'slot' and return its value, or nullptr if 'version' is unknown.
+        T* resolve(const pds::version_t version, pds::version_t& slot);
+        const T* resolve(const pds::version_t version, pds::version_t& slot) const;
+
+        /// @brief add 'version' as a slot of its own.
+        T& slot(const pds::version_t version);
+
+        /// @brief 'version' will share the slot of 'target'.
+        void alias(const pds::version_t version, const pds::version_t target);
+
+        /// @brief 'version' will share 'slot' of another fat pointer, whose value is 'value'.
+        void adopt(const pds::version_t version, const pds::version_t slot, const T& value);
+
+        /// @brief number of versions in the table (MasterVersion included).
+        std::size_t versions() const noexcept;
+
+        /// @brief bytes of the slots that the table allocated: the spilled entries. 0 while they are inline.
+        std::size_t heap_bytes() const noexcept;
+
+        /// @brief 0: the entries are their own versions map.
+        std::size_t index_bytes() const noexcept;
+
+        /// @brief drop the versions for which 'keep(version)' is false. A slot that no kept version maps to is freed.
+        template <class PRED>
+        void retain_if(PRED&& keep);
+
+        /// @brief call 'func(version, slot, value)' for every version in the table, in order.
+        template <class FUNC>
+        void for_each(FUNC&& func) const;
+    };
+
+
+    template <class T, std::size_t INLINE>
+    class fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>{
+
+        static_assert(INLINE > 0, "fpConcurrentSlots: INLINE must be positive");
+
+        struct Entry{
+            pds::version_t version;
+            pds::version_t slot;
+            T value;
+        };
+
+        /// @brief a block of entries, allocated together with its header.
+        struct Block{
+            std::size_t capacity;
+            Block* retired;     ///< the previous block, for the readers that still hold it.
+
+            Entry* entries() noexcept { return reinterpret_cast<Entry*>(this + 1); }
+            const Entry* entries() const noexcept { return reinterpret_cast<const Entry*>(this + 1); }
+        };
+
+        std::atomic<std::size_t> count = 0;         ///< published entries.
+        std::array<Entry, INLINE> inline_entries;   ///< kept as they are after spilling.
+        std::atomic<Block*> heap = nullptr;
+        std::size_t block_bytes = 0;                ///< of 'heap' and the blocks that it retired.
+        std::pmr::memory_resource* resource;
+        pds::fpMemoryCounters* counters;
+
+        Entry* find_entry(const pds::version_t version);
+        const Entry* find_entry(const pds::version_t version) const;
+
+        /// @brief write the entry of 'version' and only then publish it.
+        ///  throws pds::OperationNotSupported if 'version' is older than the newest version.
+        Entry& add_entry(const pds::version_t version, const pds::version_t slot, const T& value);
+
+        /// @brief a block of 'capacity' entries, whose first entries are the 'n' entries of 'from'.
+        Block* make_block(std::size_t capacity, const Entry* from, std::size_t n, Block* retired);
+
+        /// @brief free 'block' and the blocks that it retired.
+        void free_blocks(Block* block) noexcept;
+
+    public:
+        explicit fpSlotTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+                             pds::fpMemoryCounters* counters = nullptr);
+        fpSlotTable(const fpSlotTable&) = delete;
+        fpSlotTable& operator=(const fpSlotTable&) = delete;
+
+        /// @brief not thread safe: no reader can use 'other' while it is moved. The counters of 'other' move with its entries.
+        fpSlotTable(fpSlotTable&& other) noexcept;
+        fpSlotTable& operator=(fpSlotTable&& other) noexcept;
+        ~fpSlotTable();
+
+        /// @brief map 'version' to its slot. throws pds::VersionNotExist if 'version' is unknown.
+        pds::version_t map(const pds::version_t version);
+
+        /// @brief the value of 'slot', or nullptr if 'slot' not exists.
+        T* find(const pds::version_t slot);
+        const T* find(const pds::version_t slot) const;
+
+        /// @brief map 'version' to 'slot' and return its value, or nullptr if 'version' is unknown.
+        T* resolve(const pds::version_t version, pds::version_t& slot);
+        const T* resolve(const pds::version_t version, pds::version_t& slot) const;
+
+        /// @brief add 'version' as a slot of its own. Only the writer thread, and only for the newest version.
+        ///  The slot is published with a default value, so the writer must set it before 'version' 
+        ///  itself is published to the readers.
+        T& slot(const pds::version_t version);
+
+        /// @brief 'version' will share the slot of 'target'. Only the writer thread, and only for the newest version.
+        void alias(const pds::version_t version, const pds::version_t target);
+
+        /// @brief 'version' will share 'slot' of another fat pointer, whose value is 'value'. 
+        ///  Only the writer thread, and only for the newest version.
+        void adopt(const pds::version_t version, const pds::version_t slot, const T& value);
+
+        /// @brief number of versions in the table (MasterVersion included).
+        std::size_t versions() const noexcept;
+
+        /// @brief bytes of the slots that the table allocated: the blocks, the retired ones included.
+        std::size_t heap_bytes() const noexcept;
+
+        /// @brief 0: the entries are their own versions map.
+        std::size_t index_bytes() const noexcept;
+
+        /// @brief drop the versions for which 'keep(version)' is false. Not thread safe: no reader may use the table.
+        template <class PRED>
+        void retain_if(PRED&& keep);
+
+        /// @brief call 'func(version, slot, value)' for every version in the table, in order.
+        template <class FUNC>
+        void for_each(FUNC&& func) const;
+    };
+};
+
+
+////////////////////////////////////
+/// fpSlotTable<fpHashSlots>
+////////////////////////////////////
+
+template <class T>
+pds::fpSlotTable<T, pds::fpHashSlots>::fpSlotTable(std::pmr::memory_resource* resource, pds::fpMemoryCounters* counters) 
+
+    : table(resource), versions_map(resource), counters(counters) {
+}
+
+template <class T>
+pds::fpSlotTable<T, pds::fpHashSlots>::fpSlotTable(fpSlotTable&& other) noexcept
+
+    : table(std::move(other.table)), versions_map(std::move(other.versions_map)), 
+      counters(std::exchange(other.counters, nullptr)) {
+
+    // The containers took the memory of 'other', so what it counted is counted here.
+}
+
+template <class T>
+pds::fpSlotTable<T, pds::fpHashSlots>& pds::fpSlotTable<T, pds::fpHashSlots>::operator=(fpSlotTable&& other){
+
+    if(this != &other){
+
+        // Containers of another resource copy the slots, so both tables are counted again:
+        if(counters != nullptr)
+            counters->count_out(*this);
+
+        if(other.counters != nullptr)
+            other.counters->count_out(other);
+
+        table = std::move(other.table);
+        versions_map = std::move(other.versions_map);
+        counters = std::exchange(other.counters, nullptr);
+
+        if(counters != nullptr)
+            counters->count_in(*this);
+    }
+    return *this;
+}
+
+template <class T>
+pds::fpSlotTable<T, pds::fpHashSlots>::~fpSlotTable(){
+
+    if(counters != nullptr)
+        counters->count_out(*this);
+}
+
+template <class T>
+pds::version_t pds::fpSlotTable<T, pds::fpHashSlots>::map(const pds::version_t version){
+
+    if(version == MasterVersion)
+        return MasterVersion;
+
+    return versions_map.map(version);
+}
+
+template <class T>
+T* pds::fpSlotTable<T, pds::fpHashSlots>::find(const pds::version_t slot){
+
+    return const_cast<T*>(std::as_const(*this).find(slot));
+}
+
+template <class T>
+const T* pds::fpSlotTable<T, pds::fpHashSlots>::find(const pds::version_t slot) const {
+
+    auto it = table.find(slot);
+
+    return it == table.end() ? nullptr : &it->second;
+}
+
+template <class T>
+T* pds::fpSlotTable<T, pds::fpHashSlots>::resolve(const pds::version_t version, pds::version_t& slot){
+
+    return const_cast<T*>(std::as_const(*this).resolve(version, slot));
+}
+
+template <class T>
+const T* pds::fpSlotTable<T, pds::fpHashSlots>::resolve(const pds::version_t version, pds::version_t& slot) const {
+
+    const pds::version_t* mapped = versions_map.find(version);
+
+    if(mapped == nullptr)
+        return nullptr;
+
+    slot = *mapped;
+    return find(slot);
+}
+
+template <class T>
+T& pds::fpSlotTable<T, pds::fpHashSlots>::slot(const pds::version_t version){
+
+    pds::fpCountGuard guard(*this, counters);
+
+    if(version != MasterVersion){
+
+        versions_map.add(version, version);
+    }
+    return table[version];
+}
+
+template <class T>
+void pds::fpSlotTable<T, pds::fpHashSlots>::alias(const pds::version_t version, const pds::version_t target){
+
+    pds::fpCountGuard guard(*this, counters);
+
+    // 'target' is a version, or a slot that was adopted without a version of its own.
+    const pds::version_t* mapped = versions_map.find(target);
+
+    if(mapped == nullptr && !table.contains(target))
+        throw pds::VersionNotExist(
+            "fpSlotTable::alias: Version " + std::to_string(target) + " has no slot"
+        );
+
+    pds::version_t slot = mapped == nullptr ? target : *mapped;
+
+    // 'version' may already own a slot (re-written by the same operation).
+    table.erase(version);
+
+    versions_map.add(version, slot);
+}
+
+template <class T>
+void pds::fpSlotTable<T, pds::fpHashSlots>::adopt(const pds::version_t version, const pds::version_t slot, const T& value){
+
+    pds::fpCountGuard guard(*this, counters);
+
+    table.erase(version);
+    table[slot] = value;
+
+    versions_map.add(version, slot);
+}
+
+template <class T>
+std::size_t pds::fpSlotTable<T, pds::fpHashSlots>::versions() const noexcept {
+
+    return versions_map.size() + table.contains(MasterVersion);
+}
+
+template <class T>
+std::size_t pds::fpSlotTable<T, pds::fpHashSlots>::heap_bytes() const noexcept {
+
+    // A node is a link and a value, and a table of one bucket keeps it inside the map.
+    struct Node{
+        void* next;
+        typename decltype(table)::value_type value;
+    };
+    std::size_t buckets = table.bucket_count() > 1 ? table.bucket_count() * sizeof(void*) : 0;
+
+    return table.size() * sizeof(Node) + buckets;
+}
+
+template <class T>
+std::size_t pds::fpSlotTable<T, pds::fpHashSlots>::index_bytes() const noexcept {
+
+    return versions_map.heap_bytes();
+}
+
+template <class T>
+template <class PRED>
+void pds::fpSlotTable<T, pds::fpHashSlots>::retain_if(PRED&& keep){
+
+    pds::fpCountGuard guard(*this, counters);
+
+    versions_map.retain_if(keep);
+
+    std::unordered_set<pds::version_t> used;
+    versions_map.for_each([&used](pds::version_t, pds::version_t slot){ used.insert(slot); });
+
+    if(keep(MasterVersion))
+        used.insert(MasterVersion);
+
+    std::erase_if(table, [&used](const auto& item){ return !used.contains(item.first); });
+    table.rehash(0);
+}
+
+template <class T>
+template <class FUNC>
+void pds::fpSlotTable<T, pds::fpHashSlots>::for_each(FUNC&& func) const {
+
+    if(auto master = table.find(MasterVersion); master != table.end())
+        func(MasterVersion, MasterVersion, master->second);
+
+    versions_map.for_each([this, &func](pds::version_t version, pds::version_t slot){ 
+        func(version, slot, table.at(slot)); 
+    });
+}
+
+
+////////////////////////////////////
+/// fpSlotTable<fpFlatSlots>
+////////////////////////////////////
+
+template <class T, std::size_t INLINE>
+pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::fpSlotTable(std::pmr::memory_resource* resource, pds::fpMemoryCounters* counters) 
+
+    : heap_entries(resource), counters(counters) {
+}
+
+template <class T, std::size_t INLINE>
+pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::fpSlotTable(fpSlotTable&& other) noexcept
+
+    : count(std::exchange(other.count, 0)), inline_entries(std::move(other.inline_entries)), 
+      heap_entries(std::move(other.heap_entries)), counters(std::exchange(other.counters, nullptr)) {
+
+    // The vector took the memory of 'other', so what it counted is counted here.
+}
+
+template <class T, std::size_t INLINE>
+pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>& pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::operator=(fpSlotTable&& other){
+
+    if(this != &other){
+
+        // A vector of another resource copies the entries, so both tables are counted again:
+        if(counters != nullptr)
+            counters->count_out(*this);
+
+        if(other.counters != nullptr)
+            other.counters->count_out(other);
+
+        count = std::exchange(other.count, 0);
+        inline_entries = std::move(other.inline_entries);
+        heap_entries = std::move(other.heap_entries);
+        counters = std::exchange(other.counters, nullptr);
+
+        if(counters != nullptr)
+            counters->count_in(*this);
+    }
+    return *this;
+}
+
+template <class T, std::size_t INLINE>
+pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::~fpSlotTable(){
+
+    if(counters != nullptr)
+        counters->count_out(*this);
+}
+
+template <class T, std::size_t INLINE>
+typename pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::Entry*
+pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::data(){
+
+    return heap_entries.empty() ? inline_entries.data() : heap_entries.data();
+}
+
+template <class T, std::size_t INLINE>
+const typename pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::Entry*
+pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::data() const {
+
+    return heap_entries.empty() ? inline_entries.data() : heap_entries.data();
+}
+
+template <class T, std::size_t INLINE>
+typename pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::Entry*
+pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::find_entry(const pds::version_t version){
+
+    return const_cast<Entry*>(std::as_const(*this).find_entry(version));
+}
+
+template <class T, std::size_t INLINE>
+const typename pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::Entry*
+pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::find_entry(const pds::version_t version) const {
+
+    const Entry* entries = data();
+
+    if(count == 0)
+        return nullptr;
+
+    // New versions are always appended, so the last entry is the hottest one.
+    const pds::version_t last = entries[count - 1].version;
+
+    if(last == version)
+        return &entries[count - 1];
+
+    // A table that holds every version (i.e. the root) is indexed directly.
+    // The versions are unique and sorted, so it is dense iff the last version is 'count - 1'.
+    if(last == count - 1)
+        return version < count ? &entries[version] : nullptr;
+
+    const Entry* it = std::lower_bound(entries, entries + count, version,
+        [](const Entry& e, pds::version_t v){ return e.version < v; });
+
+    return (it != entries + count && it->version == version) ? it : nullptr;
+}
+
+template <class T, std::size_t INLINE>
+typename pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::Entry&
+pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::add_entry(const pds::version_t version){
+
+    if(Entry* e = find_entry(version))
+        return *e;
+
+    if(count == INLINE && heap_entries.empty()){
+
+        heap_entries.reserve(2 * INLINE);
+        std::move(inline_entries.begin(), inline_entries.end(), std::back_inserter(heap_entries));
+        inline_entries = {};
+    }
+
+    if(heap_entries.empty()){
+
+        Entry* pos = std::upper_bound(inline_entries.data(), inline_entries.data() + count, version,
+            [](pds::version_t v, const Entry& e){ return v < e.version; });
+
+        std::move_backward(pos, inline_entries.data() + count, inline_entries.data() + count + 1);
+        *pos = Entry{version, version, T{}};
+        ++count;
+        return *pos;
+    }
+
+    auto pos = std::upper_bound(heap_entries.begin(), heap_entries.end(), version,
+        [](pds::version_t v, const Entry& e){ return v < e.version; });
+
+    ++count;
+    return *heap_entries.insert(pos, Entry{version, version, T{}});
+}
+
+template <class T, std::size_t INLINE>
+pds::version_t pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::map(const pds::version_t version){
+
+    if(version == MasterVersion)
+        return MasterVersion;
+
+    Entry* e = find_entry(version);
+
+    if(e == nullptr)
+        throw pds::VersionNotExist(
+            "fpSlotTable::map: Version " + std::to_string(version) + " has no slot"
+        );
+
+    return e->slot;
+}
+
+template <class T, std::size_t INLINE>
+T* pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::find(const pds::version_t slot){
+
+    return const_cast<T*>(std::as_const(*this).find(slot));
+}
+
+template <class T, std::size_t INLINE>
+const T* pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::find(const pds::version_t slot) const {
+
+    const Entry* e = find_entry(slot);
+
+    return (e == nullptr || e->slot != slot) ? nullptr : &e->value;
+}
+
+template <class T, std::size_t INLINE>
+T* pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::resolve(const pds::version_t version, pds::version_t& slot){
+
+    return const_cast<T*>(std::as_const(*this).resolve(version, slot));
+}
+
+template <class T, std::size_t INLINE>
+const T* pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::resolve(const pds::version_t version, pds::version_t& slot) const {
+
+    const Entry* e = find_entry(version);
+
+    if(e == nullptr)
+        return nullptr;
+
+    slot = e->slot;
+    return &e->value;
+}
+
+template <class T, std::size_t INLINE>
+T& pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::slot(const pds::version_t version){
+
+    pds::fpCountGuard guard(*this, counters);
+
+    Entry& e = add_entry(version);
+    e.slot = version;
+    return e.value;
+}
+
+template <class T, std::size_t INLINE>
+void pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::alias(const pds::version_t version, const pds::version_t target){
+
+    pds::fpCountGuard guard(*this, counters);
+
+    Entry* t = find_entry(target);
+
+    if(t == nullptr)
+        throw pds::VersionNotExist(
+            "fpSlotTable::alias: Version " + std::to_string(target) + " has no slot"
+        );
+
+    // The target slot is sealed, so its value can be copied instead of chasing it on every lookup.
+    pds::version_t slot = t->slot;
+    T value = t->value;
+
+    Entry& e = add_entry(version);
+    e.slot = slot;
+    e.value = std::move(value);
+}
+
+template <class T, std::size_t INLINE>
+void pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::adopt(const pds::version_t version, const pds::version_t slot, const T& value){
+
+    pds::fpCountGuard guard(*this, counters);
+
+    Entry& e = add_entry(version);
+    e.slot = slot;
+    e.value = value;
+}
+
+template <class T, std::size_t INLINE>
+std::size_t pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::versions() const noexcept {
+
+    return count;
+}
+
+template <class T, std::size_t INLINE>
+std::size_t pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::heap_bytes() const noexcept {
+
+    return heap_entries.capacity() * sizeof(Entry);
+}
+
+template <class T, std::size_t INLINE>
+std::size_t pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::index_bytes() const noexcept {
+
+    return 0;
+}
+
+template <class T, std::size_t INLINE>
+template <class PRED>
+void pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::retain_if(PRED&& keep){
+
+    pds::fpCountGuard guard(*this, counters);
+
+    // Every entry holds the value of its slot, so an entry is dropped without looking at the others.
+    Entry* entries = data();
+    count = std::remove_if(entries, entries + count, [&keep](const Entry& e){ return !keep(e.version); }) - entries;
+
+    if(heap_entries.empty())
+        return;
+
+    heap_entries.resize(count);
+
+    if(count <= INLINE){
+
+        std::move(heap_entries.begin(), heap_entries.end(), inline_entries.begin());
+        heap_entries.clear();
+        heap_entries.shrink_to_fit();
+    }
+    else heap_entries.shrink_to_fit();
+}
+
+template <class T, std::size_t INLINE>
+template <class FUNC>
+void pds::fpSlotTable<T, pds::fpFlatSlots<INLINE>>::for_each(FUNC&& func) const {
+
+    const Entry* entries = heap_entries.empty() ? inline_entries.data() : heap_entries.data();
+
+    for(std::size_t i = 0; i < count; ++i)
+        func(entries[i].version, entries[i].slot, entries[i].value);
+}
+
+
+
+////////////////////////////////////
+/// fpSlotTable<fpConcurrentSlots>
+////////////////////////////////////
+
+template <class T, std::size_t INLINE>
+pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::fpSlotTable(std::pmr::memory_resource* resource, pds::fpMemoryCounters* counters) 
+
+    : resource(resource), counters(counters) {
+}
+
+template <class T, std::size_t INLINE>
+pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::fpSlotTable(fpSlotTable&& other) noexcept
+    
+    : count(other.count.load()), inline_entries(other.inline_entries), heap(other.heap.exchange(nullptr)), 
+      block_bytes(std::exchange(other.block_bytes, 0)), resource(other.resource), 
+      counters(std::exchange(other.counters, nullptr)) {
+
+    other.count = 0;
+}
+
+template <class T, std::size_t INLINE>
+pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>& 
+pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::operator=(fpSlotTable&& other) noexcept {
+
+    if(this != &other){
+
+        if(counters != nullptr)
+            counters->count_out(*this);
+
+        free_blocks(heap.exchange(other.heap.exchange(nullptr)));
+        block_bytes = std::exchange(other.block_bytes, 0);
+        resource = other.resource;
+        inline_entries = other.inline_entries;
+        count = other.count.exchange(0);
+
+        // The blocks moved, so what 'other' counted is counted here:
+        counters = std::exchange(other.counters, nullptr);
+    }
+    return *this;
+}
+
+template <class T, std::size_t INLINE>
+pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::~fpSlotTable(){
+
+    if(counters != nullptr)
+        counters->count_out(*this);
+
+    free_blocks(heap.load());
+}
+
+template <class T, std::size_t INLINE>
+typename pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::Block*
+pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::make_block(std::size_t capacity, const Entry* from, std::size_t n, Block* retired){
+
+    static_assert(alignof(Entry) <= alignof(Block), "fpConcurrentSlots: the entries must follow the block header");
+
+    void* memory = resource->allocate(sizeof(Block) + capacity * sizeof(Entry), alignof(Block));
+    Block* block = new (memory) Block{capacity, retired};
+    block_bytes += sizeof(Block) + capacity * sizeof(Entry);
+
+    std::uninitialized_copy_n(from, n, block->entries());
+    std::uninitialized_value_construct_n(block->entries() + n, capacity - n);
+    return block;
+}
+
+template <class T, std::size_t INLINE>
+void pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::free_blocks(Block* block) noexcept {
+
+    while(block != nullptr){
+
+        Block* retired = block->retired;
+        std::size_t bytes = sizeof(Block) + block->capacity * sizeof(Entry);
+
+        std::destroy_n(block->entries(), block->capacity);
+        resource->deallocate(block, bytes, alignof(Block));
+        block_bytes -= bytes;
+        block = retired;
+    }
+}
+
+template <class T, std::size_t INLINE>
+typename pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::Entry*
+pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::find_entry(const pds::version_t version){
+
+    return const_cast<Entry*>(std::as_const(*this).find_entry(version));
+}
+
+template <class T, std::size_t INLINE>
+const typename pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::Entry*
+pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::find_entry(const pds::version_t version) const {
+
+    // 'count' first: every block that is published after it holds at least 'count' entries.
+    const std::size_t n = count.load(std::memory_order_acquire);
+    const Block* block = heap.load(std::memory_order_acquire);
+    const Entry* entries = block == nullptr ? inline_entries.data() : block->entries();
+
+    if(n == 0)
+        return nullptr;
+
+    const pds::version_t last = entries[n - 1].version;
+
+    if(last == version)
+        return &entries[n - 1];
+
+    if(last == n - 1)
+        return version < n ? &entries[version] : nullptr;
+
+    const Entry* it = std::lower_bound(entries, entries + n, version,
+        [](const Entry& e, pds::version_t v){ return e.version < v; });
+
+    return (it != entries + n && it->version == version) ? it : nullptr;
+}
+
+template <class T, std::size_t INLINE>
+typename pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::Entry&
+pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::add_entry(const pds::version_t version, 
+    const pds::version_t slot, const T& value){
+
+    // Re-written by the same operation, before 'version' is published to the readers.
+    if(Entry* e = find_entry(version)){
+
+        e->slot = slot;
+        e->value = value;
+        return *e;
+    }
+
+    const std::size_t n = count.load(std::memory_order_relaxed);
+    Block* block = heap.load(std::memory_order_relaxed);
+    Entry* entries = block == nullptr ? inline_entries.data() : block->entries();
+
+    // The readers search the published entries, so a new version can only be appended.
+    if(n > 0 && entries[n - 1].version > version)
+        throw pds::OperationNotSupported(
+            "fpSlotTable::add_entry: Version " + std::to_string(version) + " is older than Version " 
+            + std::to_string(entries[n - 1].version) + ", and a published entry can not be moved"
+        );
+
+    if(n == (block == nullptr ? INLINE : block->capacity)){
+
+        Block* bigger = make_block(2 * n, entries, n, block);
+
+        heap.store(bigger, std::memory_order_release);
+        entries = bigger->entries();
+    }
+
+    entries[n] = Entry{version, slot, value};
+    count.store(n + 1, std::memory_order_release);
+
+    return entries[n];
+}
+
+template <class T, std::size_t INLINE>
+pds::version_t pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::map(const pds::version_t version){
+
+    if(version == MasterVersion)
+        return MasterVersion;
+
+    Entry* e = find_entry(version);
+
+    if(e == nullptr)
+        throw pds::VersionNotExist(
+            "fpSlotTable::map: Version " + std::to_string(version) + " has no slot"
+        );
+
+    return e->slot;
+}
+
+template <class T, std::size_t INLINE>
+T* pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::find(const pds::version_t slot){
+
+    return const_cast<T*>(std::as_const(*this).find(slot));
+}
+
+template <class T, std::size_t INLINE>
+const T* pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::find(const pds::version_t slot) const {
+
+    const Entry* e = find_entry(slot);
+
+    return (e == nullptr || e->slot != slot) ? nullptr : &e->value;
+}
+
+template <class T, std::size_t INLINE>
+T* pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::resolve(const pds::version_t version, pds::version_t& slot){
+
+    return const_cast<T*>(std::as_const(*this).resolve(version, slot));
+}
+
+template <class T, std::size_t INLINE>
+const T* pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::resolve(const pds::version_t version, pds::version_t& slot) const {
+
+    const Entry* e = find_entry(version);
+
+    if(e == nullptr)
+        return nullptr;
+
+    slot = e->slot;
+    return &e->value;
+}
+
+template <class T, std::size_t INLINE>
+T& pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::slot(const pds::version_t version){
+
+    pds::fpCountGuard guard(*this, counters);
+
+    return add_entry(version, version, T{}).value;
+}
+
+template <class T, std::size_t INLINE>
+void pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::alias(const pds::version_t version, const pds::version_t target){
+
+    pds::fpCountGuard guard(*this, counters);
+
+    Entry* t = find_entry(target);
+
+    if(t == nullptr)
+        throw pds::VersionNotExist(
+            "fpSlotTable::alias: Version " + std::to_string(target) + " has no slot"
+        );
+
+    pds::version_t slot = t->slot;
+    T value = t->value;
+
+    add_entry(version, slot, value);
+}
+
+template <class T, std::size_t INLINE>
+void pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::adopt(const pds::version_t version, const pds::version_t slot, const T& value){
+
+    pds::fpCountGuard guard(*this, counters);
+
+    add_entry(version, slot, value);
+}
+
+template <class T, std::size_t INLINE>
+std::size_t pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::versions() const noexcept {
+
+    return count.load(std::memory_order_relaxed);
+}
+
+template <class T, std::size_t INLINE>
+std::size_t pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::heap_bytes() const noexcept {
+
+    return block_bytes;
+}
+
+template <class T, std::size_t INLINE>
+std::size_t pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::index_bytes() const noexcept {
+
+    return 0;
+}
+
+template <class T, std::size_t INLINE>
+template <class PRED>
+void pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::retain_if(PRED&& keep){
+
+    pds::fpCountGuard guard(*this, counters);
+
+    const std::size_t n = count.load(std::memory_order_relaxed);
+    Block* block = heap.load(std::memory_order_relaxed);
+    Entry* entries = block == nullptr ? inline_entries.data() : block->entries();
+
+    const std::size_t kept = std::remove_if(entries, entries + n, 
+        [&keep](const Entry& e){ return !keep(e.version); }) - entries;
+
+    // No reader holds a block now, so the retired blocks are freed and a mostly empty block is shrunk.
+    if(block != nullptr && kept <= INLINE){
+
+        std::copy(entries, entries + kept, inline_entries.data());
+        heap.store(nullptr, std::memory_order_release);
+        free_blocks(block);
+    }
+    else if(block != nullptr && block->capacity > 2 * kept){
+
+        heap.store(make_block(kept, entries, kept, nullptr), std::memory_order_release);
+        free_blocks(block);
+    }
+    else if(block != nullptr){
+
+        free_blocks(std::exchange(block->retired, nullptr));
+    }
+    count.store(kept, std::memory_order_release);
+}
+
+template <class T, std::size_t INLINE>
+template <class FUNC>
+void pds::fpSlotTable<T, pds::fpConcurrentSlots<INLINE>>::for_each(FUNC&& func) const {
+
+    const std::size_t n = count.load(std::memory_order_acquire);
+    const Block* block = heap.load(std::memory_order_acquire);
+    const Entry* entries = block == nullptr ? inline_entries.data() : block->entries();
+
+    for(std::size_t i = 0; i < n; ++i)
+        func(entries[i].version, entries[i].slot, entries[i].value);
+}
+
+#endif /* FULLY_PERSISTENT_SLOT_TABLE_HPP */
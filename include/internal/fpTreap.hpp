@@ -0,0 +1,674 @@
+/**
+ * @file fpTreap.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief balancing operations of the fully persistent set, applied on fat nodes.
+ * @version 0.1
+ * @date 2024-11-20
+ */
+#ifndef FULLY_PERSISTENT_TREAP_HPP
+#define FULLY_PERSISTENT_TREAP_HPP
+
+#include "fpFatNode.hpp"
+
+namespace pds{
+
+    /**
+     * @brief The weight of an object in the sizes of the subtrees (see @ref pds::fpTreap::View).
+     *
+     * @details Every object weighs 1 by default, so a size is a number of objects.
+     *  A specialization makes the sizes count something else: the characters of the chunks
+     *  of @ref pds::fpString, so a position is found on the way down by its character.
+     */
+    template <class OBJ>
+    struct fpWeight{
+
+        static std::size_t of(const OBJ&) noexcept { return 1; }
+    };
+
+
+    /**
+     * @class fpTreap
+     * @brief Treap operations that write one new version into the fat nodes.
+     *
+     * @details Every fat node has a fixed priority, so the shape of a version is determined by its
+     *  objects only and its depth is O(log(K)) in expectation, whatever the insertion order is.
+     *
+     *  A version of a subtree is described by a View: the fat node and the slot that indexes its children.
+     *  A node that is changed by the new version gets slots of the new version, and its View is
+     *  (node, new version). Unchanged subtrees keep their old Views, so they are shared with the
+     *  older versions without writing anything.
+     *
+     *  Writing to MasterVersion updates the master tree in place.
+     *
+     *  A node whose fat pointers index @ref pds::fpFatNodeCapacity versions is full: the new version 
+     *  is written to a copy of it, which shares the children of the node without writing to them
+     *  (node splitting). The parent of a changed node is changed too, so the copy is linked by the 
+     *  writes that the operation does anyway. The next versions that change the node write to 
+     *  its copy until the copy is full too.
+     *
+     *  The objects are ordered by COMPARE, a strict weak order that the treap is constructed with, and 
+     *  that the static queries take as an argument. The default `std::less<>` is transparent, so a KEY 
+     *  that is compared with OBJ by `operator<` is found without building an OBJ from it.
+     */
+    template <class OBJ, class SLOTS, class COMPARE = std::less<>>
+    class fpTreap{
+
+        using node_ptr = pds::fpFatNode<OBJ, SLOTS>*;
+
+        pds::fpFatNodeArena<OBJ, SLOTS>& arena;   ///< makes the copies of the full nodes.
+        pds::version_t version;   ///< all the writes are done to the slots of this version.
+        [[no_unique_address]] COMPARE compare;   ///< the order of the objects.
+
+    public:
+        struct View{
+            node_ptr node;
+            pds::version_t key;
+            std::size_t size;   ///< number of objects in the subtree, or their weight (see @ref pds::fpWeight).
+
+            /**
+             * @brief same subtree. The key of an empty subtree is meaningless.
+             * @details A subtree of the new version may be changed again under the same key 
+             *  (by another operation of a batch), then only its size tells that its slot must be rewritten.
+             */
+            bool operator==(const View& other) const {
+                return node == other.node && (node == nullptr || (key == other.key && size == other.size));
+            }
+        };
+
+        fpTreap(pds::fpFatNodeArena<OBJ, SLOTS>& arena, pds::version_t new_version, COMPARE compare = COMPARE());
+
+        /// @brief deterministic priority for the 'seq'-th object (splitmix64).
+        static std::uint64_t priority(std::uint64_t seq);
+
+        /// @brief the View of 'version' in 'root'. throws pds::VersionNotExist if 'root' has no slot for it.
+        static View at(pds::fpFatNodePtr<OBJ, SLOTS>& root, pds::version_t version);
+
+        static View left(const View& t);
+        static View right(const View& t);
+
+        /// @brief move down 't' until its root is in (lo, hi) or it is empty. A null bound is unbounded.
+        static void narrow(View& t, const OBJ* lo, const OBJ* hi, const COMPARE& compare = COMPARE());
+
+        /// @brief the node of 'key' in 't', or an empty View. 'key' is an OBJ or any type that is compared with OBJ.
+        template <class KEY>
+        static View find(View t, const KEY& key, const COMPARE& compare = COMPARE());
+
+        static bool contains(View t, const OBJ& obj, const COMPARE& compare = COMPARE());
+
+        /**
+         * @brief the node at 'index' in the in-order of 't', which must be smaller than t.size.
+         * @details 'index' counts the weights of the nodes before it, and is left as the position inside the node.
+         */
+        static View nth(View t, std::size_t& index);
+
+        /// @brief make 't' the new version of the tree under 'root'.
+        void set_root(pds::fpFatNodePtr<OBJ, SLOTS>& root, const View& t);
+
+        /// @brief insert the node 'x' to 't'. The object of 'x' must not be in 't'.
+        View insert(const View& t, const node_ptr& x);
+
+        /// @brief remove 'obj' from 't'. 'obj' must be in 't'. see @ref find for 'KEY'.
+        template <class KEY>
+        View erase(const View& t, const KEY& obj);
+
+        /**
+         * @brief put the node 'x' in the place of the node of the same object in 't', which must be there.
+         * @details 'x' is a new node with the priority of the node it replaces, so the shape of 't' 
+         *  is kept: 'x' takes its children as they are and only its ancestors are relinked.
+         */
+        View replace(const View& t, const node_ptr& x);
+
+        /// @brief split 't' to the objects smaller than 'obj' and the objects bigger than 'obj'.
+        std::pair<View, View> split(const View& t, const OBJ& obj);
+
+        /// @brief split 't' to its longest prefix that weighs at most 'index' and the rest, by the subtree sizes.
+        std::pair<View, View> split_at(const View& t, std::size_t index);
+
+        /// @brief join 'l' and 'r' when all the objects of 'l' are smaller than the objects of 'r'.
+        View join(const View& l, const View& r);
+
+        /// @brief set the children of 'n' in the new version.
+        View link(const node_ptr& n, const View& l, const View& r);
+
+        /**
+         * @brief like link(t.node, l, r) but keeps 't' if its children are not changed.
+         * @details A sequence (see @ref pds::fpList) may hold a subtree twice in one version.
+         *  A node that the new version already placed elsewhere is copied instead of rewritten.
+         */
+        View relink(const View& t, const View& l, const View& r);
+
+        /// @brief the objects of 't' in (lo, hi).
+        View cut(View t, const OBJ* lo, const OBJ* hi);
+
+        /**
+         * @brief the objects of 'x' or 'y'. The subtrees that are shared by 'x' and 'y' are kept.
+         * @details A node can be in both 'x' and 'y', so the sides are not split by the root:
+         *  every recursion narrows both of them into its own range, and a node is written only by 
+         *  the recursion that holds its object. Otherwise a split of one side could change the slot 
+         *  of a node that the other side still reads.
+         */
+        View unite(const View& x, const View& y);
+
+        /// @brief the objects of both 'x' and 'y'. see @ref unite.
+        View intersect(const View& x, const View& y);
+
+        /// @brief the objects of 'x' that are not in 'y'. see @ref unite.
+        View subtract(const View& x, const View& y);
+
+    private:
+        void write(pds::fpFatNodePtr<OBJ, SLOTS>& field, const View& child);
+
+        /// @brief true if writing the new version to 'n' would grow its fat pointers beyond their capacity.
+        bool full(const node_ptr& n) const;
+
+        /// @brief true if 'n' already indexes the new version.
+        bool placed(const node_ptr& n) const;
+
+        /// @brief the size of a subtree of 'n' with the children 'l' and 'r'.
+        static std::size_t size_of(const node_ptr& n, const View& l, const View& r);
+
+        /// @brief a new node of the new version with the object of 'n' and the children 'l' and 'r'.
+        node_ptr copy(const node_ptr& n, const View& l, const View& r);
+
+        /// @brief set the children of a new node 'c' in the new version.
+        void adopt(const node_ptr& c, const View& l, const View& r);
+
+        /// @brief the node that takes the writes of 'n': 'n', or the latest copy of it that is not full.
+        node_ptr latest(const node_ptr& n);
+
+        /*
+            The set operations on the range (lo, hi).
+            'x_in' ('y_in') is true if all the objects of 'x' ('y') are known to be in the range,
+            so a subtree that ends the recursion is kept without cutting it.
+        */
+        View fit(const View& t, bool in, const OBJ* lo, const OBJ* hi);
+        View unite(View x, View y, const OBJ* lo, const OBJ* hi, bool x_in, bool y_in);
+        View intersect(View x, View y, const OBJ* lo, const OBJ* hi, bool x_in, bool y_in);
+        View subtract(View x, View y, const OBJ* lo, const OBJ* hi, bool x_in, bool y_in);
+    };
+};
+
+
+template <class OBJ, class SLOTS, class COMPARE>
+pds::fpTreap<OBJ, SLOTS, COMPARE>::fpTreap(pds::fpFatNodeArena<OBJ, SLOTS>& arena, pds::version_t new_version, COMPARE compare) 
+
+    : arena(arena), version(new_version), compare(std::move(compare)) {
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+std::uint64_t pds::fpTreap<OBJ, SLOTS, COMPARE>::priority(std::uint64_t seq){
+
+    std::uint64_t z = seq + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View
+pds::fpTreap<OBJ, SLOTS, COMPARE>::at(pds::fpFatNodePtr<OBJ, SLOTS>& root, pds::version_t version){
+
+    View t{nullptr, version, 0};
+    pds::fpChild<OBJ, SLOTS>* child = root.resolve(version, t.key);
+
+    if(child == nullptr)
+        throw pds::VersionNotExist(
+            "fpTreap::at: Version " + std::to_string(version) + " is not exist"
+        );
+
+    t.node = child->node;
+    t.size = child->size;
+    return t;
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View pds::fpTreap<OBJ, SLOTS, COMPARE>::left(const View& t){
+
+    return at(t.node->left, t.key);
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View pds::fpTreap<OBJ, SLOTS, COMPARE>::right(const View& t){
+
+    return at(t.node->right, t.key);
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+void pds::fpTreap<OBJ, SLOTS, COMPARE>::narrow(View& t, const OBJ* lo, const OBJ* hi, const COMPARE& compare){
+
+    while(t.node != nullptr){
+
+        if(lo != nullptr && !compare(*lo, t.node->get_obj()))
+            t = right(t);
+
+        else if(hi != nullptr && !compare(t.node->get_obj(), *hi))
+            t = left(t);
+
+        else return;
+    }
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+template <class KEY>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View pds::fpTreap<OBJ, SLOTS, COMPARE>::find(View t, const KEY& key, const COMPARE& compare){
+
+    while(t.node != nullptr){
+
+        if(compare(key, t.node->get_obj()))
+            t = left(t);
+
+        else if(compare(t.node->get_obj(), key))
+            t = right(t);
+
+        else break;
+    }
+    return t;
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+bool pds::fpTreap<OBJ, SLOTS, COMPARE>::contains(View t, const OBJ& obj, const COMPARE& compare){
+
+    return find(t, obj, compare).node != nullptr;
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View pds::fpTreap<OBJ, SLOTS, COMPARE>::nth(View t, std::size_t& index){
+
+    while(true){
+
+        View l = left(t);
+        std::size_t weight = pds::fpWeight<OBJ>::of(t.node->get_obj());
+
+        if(index < l.size)
+            t = l;
+
+        else if(index >= l.size + weight){
+
+            index -= l.size + weight;
+            t = right(t);
+        }
+        else{
+            index -= l.size;
+            return t;
+        }
+    }
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+void pds::fpTreap<OBJ, SLOTS, COMPARE>::write(pds::fpFatNodePtr<OBJ, SLOTS>& field, const View& child){
+
+    if(child.node == nullptr || child.key == version){
+
+        field.slot(version) = {child.node, child.size};
+        return;
+    }
+
+    // An old View can be shared only through the slot that indexes it.
+    pds::fpChild<OBJ, SLOTS>* shared = field.find(child.key);
+
+    if(shared != nullptr && shared->node == child.node){
+
+        field.alias(version, child.key);
+        return;
+    }
+
+    // The old View was moved under another node (rotation):
+    // index its children by the new version too, so it can get a slot of its own.
+    // A node that the new version already placed elsewhere keeps that place, and this View gets a copy.
+    if(full(child.node) || placed(child.node)){
+
+        field.slot(version) = {copy(child.node, left(child), right(child)), child.size};
+        return;
+    }
+    child.node->left.alias(version, child.key);
+    child.node->right.alias(version, child.key);
+    field.slot(version) = {child.node, child.size};
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+bool pds::fpTreap<OBJ, SLOTS, COMPARE>::full(const node_ptr& n) const {
+
+    // The object is copied with the node, a move-only object keeps its fat nodes unbounded.
+    if constexpr(!std::is_copy_constructible_v<OBJ>)
+        return false;
+
+    if(version == MasterVersion)
+        return false;
+
+    if(n->left.versions() < fpFatNodeCapacity && n->right.versions() < fpFatNodeCapacity)
+        return false;
+
+    // A node that already indexes the new version is rewritten in place.
+    pds::version_t slot;
+    return n->left.resolve(version, slot) == nullptr;
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+bool pds::fpTreap<OBJ, SLOTS, COMPARE>::placed(const node_ptr& n) const {
+
+    pds::version_t slot;
+    return n->left.resolve(version, slot) != nullptr;
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+std::size_t pds::fpTreap<OBJ, SLOTS, COMPARE>::size_of(const node_ptr& n, const View& l, const View& r){
+
+    return l.size + r.size + pds::fpWeight<OBJ>::of(n->get_obj());
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::node_ptr 
+pds::fpTreap<OBJ, SLOTS, COMPARE>::copy(const node_ptr& n, const View& l, const View& r){
+
+    // Never called for a move-only object, see full().
+    if constexpr(!std::is_copy_constructible_v<OBJ>)
+        return n;
+
+    else{
+        node_ptr c = arena.make(n->get_obj(), version, n->get_priority());
+        adopt(c, l, r);
+        return c;
+    }
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+void pds::fpTreap<OBJ, SLOTS, COMPARE>::adopt(const node_ptr& c, const View& l, const View& r){
+
+    // The fat pointers of 'c' are new, so they can index the old Views by their own keys.
+    if(l.node != nullptr && l.key != version)
+        c->left.adopt(version, l.key, {l.node, l.size});
+    else
+        c->left.slot(version) = {l.node, l.size};
+
+    if(r.node != nullptr && r.key != version)
+        c->right.adopt(version, r.key, {r.node, r.size});
+    else
+        c->right.slot(version) = {r.node, r.size};
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::node_ptr pds::fpTreap<OBJ, SLOTS, COMPARE>::latest(const node_ptr& n){
+
+    node_ptr w = n;
+
+    while(w->next != nullptr && full(w))
+        w = w->next;
+
+    // The full copies are skipped from now on.
+    if(w != n)
+        n->next = w;
+
+    return w;
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+void pds::fpTreap<OBJ, SLOTS, COMPARE>::set_root(pds::fpFatNodePtr<OBJ, SLOTS>& root, const View& t){
+
+    write(root, t);
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View
+pds::fpTreap<OBJ, SLOTS, COMPARE>::link(const node_ptr& n, const View& l, const View& r){
+
+    node_ptr w = latest(n);
+
+    // An old View of 'w' under 'w' itself (e.g. a sequence joined with itself) needs a copy above it.
+    if(w == l.node || w == r.node)
+        return View{copy(w, l, r), version, size_of(w, l, r)};
+
+    if(full(w)){
+
+        w->next = copy(w, l, r);
+        return View{w->next, version, size_of(w, l, r)};
+    }
+    write(w->left, l);
+    write(w->right, r);
+    return View{w, version, size_of(w, l, r)};
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View
+pds::fpTreap<OBJ, SLOTS, COMPARE>::relink(const View& t, const View& l, const View& r){
+
+    if(left(t) == l && right(t) == r)
+        return t;
+
+    // 't' is an old View of a node whose latest copy the new version already wrote elsewhere.
+    if(t.key != version){
+
+        node_ptr w = latest(t.node);
+
+        if(placed(w))
+            return View{copy(w, l, r), version, size_of(w, l, r)};
+    }
+    return link(t.node, l, r);
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+std::pair<typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View, typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View>
+pds::fpTreap<OBJ, SLOTS, COMPARE>::split(const View& t, const OBJ& obj){
+
+    if(t.node == nullptr)
+        return {t, t};
+
+    if(compare(t.node->get_obj(), obj)){
+
+        auto [l, r] = split(right(t), obj);
+        return {relink(t, left(t), l), r};
+    }
+    auto [l, r] = split(left(t), obj);
+    return {l, relink(t, r, right(t))};
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+std::pair<typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View, typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View>
+pds::fpTreap<OBJ, SLOTS, COMPARE>::split_at(const View& t, std::size_t index){
+
+    if(t.node == nullptr)
+        return {t, t};
+
+    View left_t = left(t);
+    std::size_t weight = pds::fpWeight<OBJ>::of(t.node->get_obj());
+
+    if(left_t.size + weight <= index){
+
+        auto [l, r] = split_at(right(t), index - left_t.size - weight);
+        return {relink(t, left_t, l), r};
+    }
+    auto [l, r] = split_at(left_t, index);
+    return {l, relink(t, r, right(t))};
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View pds::fpTreap<OBJ, SLOTS, COMPARE>::join(const View& l, const View& r){
+
+    if(l.node == nullptr)
+        return r;
+
+    if(r.node == nullptr)
+        return l;
+
+    if(l.node->get_priority() > r.node->get_priority())
+        return relink(l, left(l), join(right(l), r));
+
+    return relink(r, join(l, left(r)), right(r));
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View pds::fpTreap<OBJ, SLOTS, COMPARE>::insert(const View& t, const node_ptr& x){
+
+    if(t.node == nullptr || x->get_priority() > t.node->get_priority()){
+
+        auto [l, r] = split(t, x->get_obj());
+        return link(x, l, r);
+    }
+
+    if(compare(x->get_obj(), t.node->get_obj()))
+        return relink(t, insert(left(t), x), right(t));
+
+    return relink(t, left(t), insert(right(t), x));
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+template <class KEY>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View pds::fpTreap<OBJ, SLOTS, COMPARE>::erase(const View& t, const KEY& obj){
+
+    if(compare(obj, t.node->get_obj()))
+        return relink(t, erase(left(t), obj), right(t));
+
+    if(compare(t.node->get_obj(), obj))
+        return relink(t, left(t), erase(right(t), obj));
+
+    return join(left(t), right(t));
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View pds::fpTreap<OBJ, SLOTS, COMPARE>::replace(const View& t, const node_ptr& x){
+
+    if(compare(x->get_obj(), t.node->get_obj()))
+        return relink(t, replace(left(t), x), right(t));
+
+    if(compare(t.node->get_obj(), x->get_obj()))
+        return relink(t, left(t), replace(right(t), x));
+
+    adopt(x, left(t), right(t));
+    return View{x, version, t.size};
+}
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View pds::fpTreap<OBJ, SLOTS, COMPARE>::cut(View t, const OBJ* lo, const OBJ* hi){
+
+    if(lo == nullptr && hi == nullptr)
+        return t;
+
+    narrow(t, lo, hi, compare);
+
+    if(t.node == nullptr)
+        return t;
+
+    // the left side is smaller than 'hi' and the right side is bigger than 'lo'.
+    return relink(t, cut(left(t), lo, nullptr), cut(right(t), nullptr, hi));
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View 
+pds::fpTreap<OBJ, SLOTS, COMPARE>::fit(const View& t, bool in, const OBJ* lo, const OBJ* hi){
+
+    return in ? t : cut(t, lo, hi);
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View pds::fpTreap<OBJ, SLOTS, COMPARE>::unite(const View& x, const View& y){
+
+    return unite(x, y, nullptr, nullptr, true, true);
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View pds::fpTreap<OBJ, SLOTS, COMPARE>::intersect(const View& x, const View& y){
+
+    return intersect(x, y, nullptr, nullptr, true, true);
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View pds::fpTreap<OBJ, SLOTS, COMPARE>::subtract(const View& x, const View& y){
+
+    return subtract(x, y, nullptr, nullptr, true, true);
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View 
+pds::fpTreap<OBJ, SLOTS, COMPARE>::unite(View x, View y, const OBJ* lo, const OBJ* hi, bool x_in, bool y_in){
+
+    if(!x_in) narrow(x, lo, hi, compare);
+    if(!y_in) narrow(y, lo, hi, compare);
+
+    if(x.node == nullptr)
+        return fit(y, y_in, lo, hi);
+
+    if(y.node == nullptr || x == y)
+        return fit(x, x_in || (x == y && y_in), lo, hi);
+
+    // The root with the higher priority is the root of the union.
+    if(x.node != y.node && x.node->get_priority() < y.node->get_priority()){
+
+        std::swap(x, y);
+        std::swap(x_in, y_in);
+    }
+    const OBJ* obj = &x.node->get_obj();
+
+    if(x.node == y.node)
+        return relink(x, unite(left(x), left(y), lo, obj, x_in, y_in), unite(right(x), right(y), obj, hi, x_in, y_in));
+
+    return relink(x, unite(left(x), y, lo, obj, x_in, false), unite(right(x), y, obj, hi, x_in, false));
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View 
+pds::fpTreap<OBJ, SLOTS, COMPARE>::intersect(View x, View y, const OBJ* lo, const OBJ* hi, bool x_in, bool y_in){
+
+    if(!x_in) narrow(x, lo, hi, compare);
+    if(!y_in) narrow(y, lo, hi, compare);
+
+    if(x.node == nullptr || y.node == nullptr)
+        return View{nullptr, version, 0};
+
+    if(x == y)
+        return fit(x, x_in || y_in, lo, hi);
+
+    if(x.node != y.node && x.node->get_priority() < y.node->get_priority()){
+
+        std::swap(x, y);
+        std::swap(x_in, y_in);
+    }
+    const OBJ* obj = &x.node->get_obj();
+
+    if(x.node == y.node)
+        return relink(x, intersect(left(x), left(y), lo, obj, x_in, y_in), intersect(right(x), right(y), obj, hi, x_in, y_in));
+
+    // 'y' has only lower priorities, so it may hold the root of 'x' only on a tie.
+    bool in_y = x.node->get_priority() == y.node->get_priority() && contains(y, *obj, compare);
+
+    View l = intersect(left(x), y, lo, obj, x_in, false);
+    View r = intersect(right(x), y, obj, hi, x_in, false);
+
+    return in_y ? relink(x, l, r) : join(l, r);
+}
+
+template <class OBJ, class SLOTS, class COMPARE>
+typename pds::fpTreap<OBJ, SLOTS, COMPARE>::View 
+pds::fpTreap<OBJ, SLOTS, COMPARE>::subtract(View x, View y, const OBJ* lo, const OBJ* hi, bool x_in, bool y_in){
+
+    if(!x_in) narrow(x, lo, hi, compare);
+    if(!y_in) narrow(y, lo, hi, compare);
+
+    if(x.node == nullptr || x == y)
+        return View{nullptr, version, 0};
+
+    if(y.node == nullptr)
+        return fit(x, x_in, lo, hi);
+
+    if(x.node == y.node){
+
+        const OBJ* obj = &x.node->get_obj();
+        return join(subtract(left(x), left(y), lo, obj, x_in, y_in), subtract(right(x), right(y), obj, hi, x_in, y_in));
+    }
+
+    if(y.node->get_priority() <= x.node->get_priority()){
+
+        const OBJ* obj = &x.node->get_obj();
+        bool in_y = x.node->get_priority() == y.node->get_priority() && contains(y, *obj, compare);
+
+        View l = subtract(left(x), y, lo, obj, x_in, false);
+        View r = subtract(right(x), y, obj, hi, x_in, false);
+
+        return in_y ? join(l, r) : relink(x, l, r);
+    }
+
+    // The root of 'y' has a higher priority than all of 'x', so it is not in 'x'.
+    const OBJ* obj = &y.node->get_obj();
+    return join(subtract(x, left(y), lo, obj, false, y_in), subtract(x, right(y), obj, hi, false, y_in));
+}
+
+
+#endif /* FULLY_PERSISTENT_TREAP_HPP */
@@ -0,0 +1,161 @@
+/**
+ * @file fpVersionIndex.hpp
+ * @author Assaf Bardugo (https://github.com/AssafBardugo)
+ *
+ * @brief maps the versions that pass through a fat pointer to the slots they share.
+ * @version 0.1
+ * @date 2024-12-10
+ */
+#ifndef FULLY_PERSISTENT_VERSION_INDEX_HPP
+#define FULLY_PERSISTENT_VERSION_INDEX_HPP
+
+#include "Utils.hpp"
+
+namespace pds{
+
+    /**
+     * @class fpVersionIndex
+     * @brief A sorted vector of (version, slot) pairs.
+     *
+     * @details A version is mapped once, when it is created, and it is the newest version then,
+     *  so the pairs are appended in order and a lookup is a binary search
+     *  (or a direct index, when the index holds every version, like the root does).
+     *  Nothing is hashed and a lookup does not change the index.
+     *  MasterVersion is not stored, it is always its own slot.
+     */
+    class fpVersionIndex{
+
+        struct Entry{
+            pds::version_t version;
+            pds::version_t slot;
+        };
+
+        std::pmr::vector<Entry> entries;
+
+        const Entry* find_entry(const pds::version_t version) const;
+
+    public:
+        /// @brief an empty index, that allocates from 'resource'.
+        explicit fpVersionIndex(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        /// @brief the slot of 'version', or nullptr if 'version' is unknown.
+        const pds::version_t* find(const pds::version_t version) const;
+
+        /// @brief the slot of 'version'. throws pds::VersionNotExist if 'version' is unknown.
+        pds::version_t map(const pds::version_t version) const;
+
+        bool contains(const pds::version_t version) const;
+
+        /// @brief number of mapped versions.
+        std::size_t size() const noexcept;
+
+        /// @brief bytes of the allocated entries.
+        std::size_t heap_bytes() const noexcept;
+
+        /// @brief map 'version' to 'slot'. A version that is already mapped is remapped.
+        void add(const pds::version_t version, const pds::version_t slot);
+
+        /// @brief drop the versions for which 'keep(version)' is false, and free the unused capacity.
+        template <class PRED>
+        void retain_if(PRED&& keep);
+
+        /// @brief call 'func(version, slot)' for every mapped version, in order.
+        template <class FUNC>
+        void for_each(FUNC&& func) const;
+    };
+};
+
+
+inline pds::fpVersionIndex::fpVersionIndex(std::pmr::memory_resource* resource) : entries(resource) {
+}
+
+inline const pds::fpVersionIndex::Entry* pds::fpVersionIndex::find_entry(const pds::version_t version) const {
+
+    if(entries.empty())
+        return nullptr;
+
+    const std::size_t count = entries.size();
+    const pds::version_t last = entries[count - 1].version;
+
+    if(last == version)
+        return &entries[count - 1];
+
+    // Versions 1, 2, ..., count are indexed directly.
+    if(last == count)
+        return (version != MasterVersion && version < count) ? &entries[version - 1] : nullptr;
+
+    auto it = std::lower_bound(entries.begin(), entries.end(), version,
+        [](const Entry& e, pds::version_t v){ return e.version < v; });
+
+    return (it != entries.end() && it->version == version) ? &*it : nullptr;
+}
+
+inline const pds::version_t* pds::fpVersionIndex::find(const pds::version_t version) const {
+
+    if(version == MasterVersion)
+        return &MasterVersion;
+
+    const Entry* e = find_entry(version);
+
+    return e == nullptr ? nullptr : &e->slot;
+}
+
+inline pds::version_t pds::fpVersionIndex::map(const pds::version_t version) const {
+
+    const pds::version_t* slot = find(version);
+
+    if(slot == nullptr)
+        throw pds::VersionNotExist(
+            "fpVersionIndex::map: Version " + std::to_string(version) + " has no slot"
+        );
+
+    return *slot;
+}
+
+inline bool pds::fpVersionIndex::contains(const pds::version_t version) const {
+
+    return find(version) != nullptr;
+}
+
+inline std::size_t pds::fpVersionIndex::size() const noexcept {
+
+    return entries.size();
+}
+
+inline std::size_t pds::fpVersionIndex::heap_bytes() const noexcept {
+
+    return entries.capacity() * sizeof(Entry);
+}
+
+inline void pds::fpVersionIndex::add(const pds::version_t version, const pds::version_t slot){
+
+    assert(version != MasterVersion);
+
+    if(Entry* e = const_cast<Entry*>(find_entry(version))){
+
+        e->slot = slot;
+        return;
+    }
+
+    auto pos = std::upper_bound(entries.begin(), entries.end(), version,
+        [](pds::version_t v, const Entry& e){ return v < e.version; });
+
+    entries.insert(pos, Entry{version, slot});
+}
+
+template <class PRED>
+void pds::fpVersionIndex::retain_if(PRED&& keep){
+
+    std::erase_if(entries, [&keep](const Entry& e){ return !keep(e.version); });
+    entries.shrink_to_fit();
+}
+
+template <class FUNC>
+void pds::fpVersionIndex::for_each(FUNC&& func) const {
+
+    for(const Entry& e : entries)
+        func(e.version, e.slot);
+}
+
+
+#endif /* FULLY_PERSISTENT_VERSION_INDEX_HPP */
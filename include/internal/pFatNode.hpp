@@ -8,26 +8,44 @@ namespace pds{
     template <class OBJ>
     struct pFatNodePtr;
 
+    /**
+     * @brief The number of versions that a fat pointer of a node may hold.
+     * @details An update that passes through a node whose fat pointers are full copies the node first
+     *  (see @ref pds::pSetTracker::split), so every fat pointer below the root is searched in O(1).
+     */
+    const std::size_t pFatNodeCapacity = 32;
+
     template <class OBJ>
     class pFatNode{
         const OBJ obj;
     public:
         pds::pFatNodePtr<OBJ> left;
         pds::pFatNodePtr<OBJ> right;
+        std::weak_ptr<pds::pFatNode<OBJ>> next;     ///< the copy that took over when this node was full.
 
-        pFatNode(const OBJ& obj, pds::version_t version);
-        pFatNode(OBJ&& obj, pds::version_t version);
+        /// @brief the fat pointers of the node allocate from 'resource'.
+        pFatNode(const OBJ& obj, pds::version_t version, 
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+        pFatNode(OBJ&& obj, pds::version_t version, 
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
         const OBJ& get_obj() const;
     };
 
     template <class OBJ>
     struct pFatNodePtr{
-        std::unordered_map<pds::version_t, std::shared_ptr<pds::pFatNode<OBJ>>> table;
-        std::vector<pds::version_t> nodes_versions;
+        std::pmr::unordered_map<pds::version_t, std::shared_ptr<pds::pFatNode<OBJ>>> table;
+        std::pmr::vector<pds::version_t> nodes_versions;
 
-        pFatNodePtr(pds::version_t first_version);
+        pFatNodePtr(pds::version_t first_version, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
         pds::version_t map(const pds::version_t version) const;
+
+        /// @brief the memory resource of the tables, and of the nodes that are made for them.
+        std::pmr::memory_resource* get_resource() const noexcept;
+
+        /// @brief a new node for 'version', allocated from the resource of the tables.
+        template <typename T>
+        std::shared_ptr<pds::pFatNode<OBJ>> make_node(T&& obj, pds::version_t version) const;
     };
 };
 
@@ -37,15 +55,15 @@ namespace pds{
 ////////////////////////////////////
 
 template <class OBJ>
-pds::pFatNode<OBJ>::pFatNode(const OBJ& obj, pds::version_t version)
+pds::pFatNode<OBJ>::pFatNode(const OBJ& obj, pds::version_t version, std::pmr::memory_resource* resource)
 
-    : obj(obj), left(version), right(version) {
+    : obj(obj), left(version, resource), right(version, resource) {
 }
 
 template <class OBJ>
-pds::pFatNode<OBJ>::pFatNode(OBJ&& obj, pds::version_t version)
+pds::pFatNode<OBJ>::pFatNode(OBJ&& obj, pds::version_t version, std::pmr::memory_resource* resource)
 
-    : obj(std::move(obj)), left(version), right(version) {
+    : obj(std::move(obj)), left(version, resource), right(version, resource) {
 }
 
 template <class OBJ>
@@ -60,10 +78,26 @@ const OBJ& pds::pFatNode<OBJ>::get_obj() const {
 ////////////////////////////////////
 
 template <class OBJ>
-pds::pFatNodePtr<OBJ>::pFatNodePtr(pds::version_t first_version) 
+pds::pFatNodePtr<OBJ>::pFatNodePtr(pds::version_t first_version, std::pmr::memory_resource* resource) 
             
-    : table{{MasterVersion, nullptr}, {first_version, nullptr}}, 
-        nodes_versions{MasterVersion, first_version} {
+    : table({{MasterVersion, nullptr}, {first_version, nullptr}}, 0, resource), 
+        nodes_versions({MasterVersion, first_version}, resource) {
+}
+
+template <class OBJ>
+std::pmr::memory_resource* pds::pFatNodePtr<OBJ>::get_resource() const noexcept {
+
+    return nodes_versions.get_allocator().resource();
+}
+
+template <class OBJ>
+template <typename T>
+std::shared_ptr<pds::pFatNode<OBJ>> pds::pFatNodePtr<OBJ>::make_node(T&& obj, pds::version_t version) const {
+
+    // The node and its control block are one allocation of the resource.
+    return std::allocate_shared<pds::pFatNode<OBJ>>(
+        std::pmr::polymorphic_allocator<pds::pFatNode<OBJ>>(get_resource()), std::forward<T>(obj), version, get_resource()
+    );
 }
 
 template <class OBJ>
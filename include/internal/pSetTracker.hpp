@@ -5,15 +5,33 @@
 
 namespace pds{
 
-    template <class OBJ>
+    /**
+     * @class pSetTracker
+     * @brief Walks over the pSet tree.
+     *
+     * @tparam CHECKED 
+     *  - true (default): every call validates the tracked slot and throws on failure.
+     *  - false: the *_at reads follow one version that was validated at the API boundary. 
+     *      The node of that version is resolved once on every move, and the tracker only asserts 
+     *      (in debug builds) without exception machinery.
+     */
+    template <class OBJ, bool CHECKED = true>
     class pSetTracker{
 
         pds::pFatNodePtr<OBJ>* ptr;
         pds::version_t track_version;
 
+        pds::pFatNode<OBJ>* read_node;  ///< unchecked reads: the node of 'read_version' in 'ptr'.
+        pds::version_t read_version;
+
+        void resolve_at(const pds::version_t version);
+
     public:
         pSetTracker(pds::pFatNodePtr<OBJ>& root);
 
+        /// @brief a tracker for reading 'version'. 'version' must exist.
+        pSetTracker(pds::pFatNodePtr<OBJ>& root, pds::version_t version);
+
         std::shared_ptr<pds::pFatNode<OBJ>>& operator[](const pds::version_t new_version);
 
         std::shared_ptr<pds::pFatNode<OBJ>> operator*() const;
@@ -28,10 +46,10 @@ namespace pds{
         const OBJ& obj() const;
         const OBJ& obj_at(pds::version_t version) const;
 
-        pSetTracker<OBJ>& left();
-        pSetTracker<OBJ>& right();
-        pSetTracker<OBJ>& left_at(pds::version_t version);
-        pSetTracker<OBJ>& right_at(pds::version_t version);
+        pSetTracker& left();
+        pSetTracker& right();
+        pSetTracker& left_at(pds::version_t version);
+        pSetTracker& right_at(pds::version_t version);
 
         bool left_null() const;
         bool right_null() const;
@@ -43,26 +61,58 @@ namespace pds{
         std::shared_ptr<pFatNode<OBJ>>& set_right(const pds::version_t new_version);
 
         void set_track_version(const pds::version_t new_version);
+
+        /**
+         * @brief Node splitting: if one of the fat pointers of the tracked node is full 
+         *  (see @ref pds::pFatNodeCapacity), 'new_version' will track a copy of the node 
+         *  that holds only its latest children.
+         * @details Called on the way down of an update, before anything is written under the node, 
+         *  so its parent (already split) has room for the copy.
+         *  A node of a move-only OBJ is not copied.
+         */
+        pSetTracker& split(const pds::version_t new_version);
     };
 };
 
-template <class OBJ>
-pds::pSetTracker<OBJ>::pSetTracker(pds::pFatNodePtr<OBJ>& root) 
+template <class OBJ, bool CHECKED>
+pds::pSetTracker<OBJ, CHECKED>::pSetTracker(pds::pFatNodePtr<OBJ>& root) 
         
-    : ptr(&root), track_version(ptr->nodes_versions.back()) {
+    : ptr(&root), track_version(ptr->nodes_versions.back()), 
+        read_node(nullptr), read_version(MasterVersion) {
 }
 
-template <class OBJ>
-std::shared_ptr<pds::pFatNode<OBJ>>& pds::pSetTracker<OBJ>::operator[](const pds::version_t new_version){
+template <class OBJ, bool CHECKED>
+pds::pSetTracker<OBJ, CHECKED>::pSetTracker(pds::pFatNodePtr<OBJ>& root, pds::version_t version) 
+        
+    : pSetTracker(root) {
 
-    if(new_version != MasterVersion){
+    resolve_at(version);
+}
+
+template <class OBJ, bool CHECKED>
+void pds::pSetTracker<OBJ, CHECKED>::resolve_at(const pds::version_t version){
+
+    read_version = version;
+
+    if constexpr(!CHECKED){
+
+        auto node = ptr->table.find(ptr->map(version));
+        assert(node != ptr->table.end());
+        read_node = node->second.get();
+    }
+}
+
+template <class OBJ, bool CHECKED>
+std::shared_ptr<pds::pFatNode<OBJ>>& pds::pSetTracker<OBJ, CHECKED>::operator[](const pds::version_t new_version){
+
+    if(new_version != MasterVersion && ptr->nodes_versions.back() != new_version){
         ptr->nodes_versions.push_back(new_version);
     }
     return ptr->table[new_version];
 }
 
-template <class OBJ>
-std::shared_ptr<pds::pFatNode<OBJ>> pds::pSetTracker<OBJ>::operator*() const {
+template <class OBJ, bool CHECKED>
+std::shared_ptr<pds::pFatNode<OBJ>> pds::pSetTracker<OBJ, CHECKED>::operator*() const {
 
     try{
         return ptr->table.at(track_version);
@@ -75,8 +125,8 @@ std::shared_ptr<pds::pFatNode<OBJ>> pds::pSetTracker<OBJ>::operator*() const {
     }
 }
 
-template <class OBJ>
-std::shared_ptr<pds::pFatNode<OBJ>> pds::pSetTracker<OBJ>::at(pds::version_t version) const {
+template <class OBJ, bool CHECKED>
+std::shared_ptr<pds::pFatNode<OBJ>> pds::pSetTracker<OBJ, CHECKED>::at(pds::version_t version) const {
 
     version = ptr->map(version);
 
@@ -91,8 +141,8 @@ std::shared_ptr<pds::pFatNode<OBJ>> pds::pSetTracker<OBJ>::at(pds::version_t ver
     }
 }
 
-template <class OBJ>
-bool pds::pSetTracker<OBJ>::null() const {
+template <class OBJ, bool CHECKED>
+bool pds::pSetTracker<OBJ, CHECKED>::null() const {
     
     try{
         return ptr->table.at(track_version) == nullptr;
@@ -105,8 +155,14 @@ bool pds::pSetTracker<OBJ>::null() const {
     }
 }
 
-template <class OBJ>
-bool pds::pSetTracker<OBJ>::null_at(pds::version_t version) const {
+template <class OBJ, bool CHECKED>
+bool pds::pSetTracker<OBJ, CHECKED>::null_at(pds::version_t version) const {
+
+    if constexpr(!CHECKED){
+
+        assert(version == read_version);
+        return read_node == nullptr;
+    }
 
     version = ptr->map(version);
     
@@ -121,8 +177,8 @@ bool pds::pSetTracker<OBJ>::null_at(pds::version_t version) const {
     }
 }
 
-template <class OBJ>
-bool pds::pSetTracker<OBJ>::not_null() const {
+template <class OBJ, bool CHECKED>
+bool pds::pSetTracker<OBJ, CHECKED>::not_null() const {
 
     try{
         return ptr->table.at(track_version) != nullptr;
@@ -135,8 +191,14 @@ bool pds::pSetTracker<OBJ>::not_null() const {
     }
 }
 
-template <class OBJ>
-bool pds::pSetTracker<OBJ>::not_null_at(pds::version_t version) const {
+template <class OBJ, bool CHECKED>
+bool pds::pSetTracker<OBJ, CHECKED>::not_null_at(pds::version_t version) const {
+
+    if constexpr(!CHECKED){
+
+        assert(version == read_version);
+        return read_node != nullptr;
+    }
 
     version = ptr->map(version);
 
@@ -151,8 +213,8 @@ bool pds::pSetTracker<OBJ>::not_null_at(pds::version_t version) const {
     }
 }
 
-template <class OBJ>
-const OBJ& pds::pSetTracker<OBJ>::obj() const {
+template <class OBJ, bool CHECKED>
+const OBJ& pds::pSetTracker<OBJ, CHECKED>::obj() const {
 
     PDS_THROW_IF_NULL_TRACKER("obj", track_version);
 
@@ -167,8 +229,14 @@ const OBJ& pds::pSetTracker<OBJ>::obj() const {
     }
 }
 
-template <class OBJ>
-const OBJ& pds::pSetTracker<OBJ>::obj_at(pds::version_t version) const {
+template <class OBJ, bool CHECKED>
+const OBJ& pds::pSetTracker<OBJ, CHECKED>::obj_at(pds::version_t version) const {
+
+    if constexpr(!CHECKED){
+
+        assert(version == read_version && read_node != nullptr);
+        return read_node->get_obj();
+    }
 
     version = ptr->map(version);
 
@@ -185,8 +253,8 @@ const OBJ& pds::pSetTracker<OBJ>::obj_at(pds::version_t version) const {
     }
 }
 
-template <class OBJ>
-pds::pSetTracker<OBJ>& pds::pSetTracker<OBJ>::left(){
+template <class OBJ, bool CHECKED>
+pds::pSetTracker<OBJ, CHECKED>& pds::pSetTracker<OBJ, CHECKED>::left(){
 
     PDS_THROW_IF_NULL_TRACKER("left", track_version);
 
@@ -203,8 +271,8 @@ pds::pSetTracker<OBJ>& pds::pSetTracker<OBJ>::left(){
     return *this;
 }
 
-template <class OBJ>
-pds::pSetTracker<OBJ>& pds::pSetTracker<OBJ>::right(){
+template <class OBJ, bool CHECKED>
+pds::pSetTracker<OBJ, CHECKED>& pds::pSetTracker<OBJ, CHECKED>::right(){
     
     PDS_THROW_IF_NULL_TRACKER("right", track_version);
 
@@ -221,8 +289,16 @@ pds::pSetTracker<OBJ>& pds::pSetTracker<OBJ>::right(){
     return *this;
 }
 
-template <class OBJ>
-pds::pSetTracker<OBJ>& pds::pSetTracker<OBJ>::left_at(pds::version_t version){
+template <class OBJ, bool CHECKED>
+pds::pSetTracker<OBJ, CHECKED>& pds::pSetTracker<OBJ, CHECKED>::left_at(pds::version_t version){
+
+    if constexpr(!CHECKED){
+
+        assert(version == read_version && read_node != nullptr);
+        ptr = &read_node->left;
+        resolve_at(version);
+        return *this;
+    }
 
     version = ptr->map(version);
 
@@ -240,8 +316,16 @@ pds::pSetTracker<OBJ>& pds::pSetTracker<OBJ>::left_at(pds::version_t version){
     return *this;
 }
 
-template <class OBJ>
-pds::pSetTracker<OBJ>& pds::pSetTracker<OBJ>::right_at(pds::version_t version){
+template <class OBJ, bool CHECKED>
+pds::pSetTracker<OBJ, CHECKED>& pds::pSetTracker<OBJ, CHECKED>::right_at(pds::version_t version){
+
+    if constexpr(!CHECKED){
+
+        assert(version == read_version && read_node != nullptr);
+        ptr = &read_node->right;
+        resolve_at(version);
+        return *this;
+    }
 
     version = ptr->map(version);
     
@@ -259,8 +343,8 @@ pds::pSetTracker<OBJ>& pds::pSetTracker<OBJ>::right_at(pds::version_t version){
     return *this;
 }
 
-template <class OBJ>
-bool pds::pSetTracker<OBJ>::left_null() const {
+template <class OBJ, bool CHECKED>
+bool pds::pSetTracker<OBJ, CHECKED>::left_null() const {
 
     PDS_THROW_IF_NULL_TRACKER("left_null", track_version);
     
@@ -276,8 +360,8 @@ bool pds::pSetTracker<OBJ>::left_null() const {
     }
 }
 
-template <class OBJ>
-bool pds::pSetTracker<OBJ>::right_null() const {
+template <class OBJ, bool CHECKED>
+bool pds::pSetTracker<OBJ, CHECKED>::right_null() const {
 
     PDS_THROW_IF_NULL_TRACKER("right_null", track_version);
 
@@ -293,8 +377,8 @@ bool pds::pSetTracker<OBJ>::right_null() const {
     }
 }
 
-template <class OBJ>
-std::shared_ptr<pds::pFatNode<OBJ>> pds::pSetTracker<OBJ>::get_left() const {
+template <class OBJ, bool CHECKED>
+std::shared_ptr<pds::pFatNode<OBJ>> pds::pSetTracker<OBJ, CHECKED>::get_left() const {
 
     PDS_THROW_IF_NULL_TRACKER("get_left", track_version);
 
@@ -310,8 +394,8 @@ std::shared_ptr<pds::pFatNode<OBJ>> pds::pSetTracker<OBJ>::get_left() const {
     }
 }
 
-template <class OBJ>
-std::shared_ptr<pds::pFatNode<OBJ>> pds::pSetTracker<OBJ>::get_right() const {
+template <class OBJ, bool CHECKED>
+std::shared_ptr<pds::pFatNode<OBJ>> pds::pSetTracker<OBJ, CHECKED>::get_right() const {
 
     PDS_THROW_IF_NULL_TRACKER("get_right", track_version);
 
@@ -327,14 +411,18 @@ std::shared_ptr<pds::pFatNode<OBJ>> pds::pSetTracker<OBJ>::get_right() const {
     }
 }
 
-template <class OBJ>
-std::shared_ptr<pds::pFatNode<OBJ>>& pds::pSetTracker<OBJ>::set_left(const pds::version_t new_version){
+template <class OBJ, bool CHECKED>
+std::shared_ptr<pds::pFatNode<OBJ>>& pds::pSetTracker<OBJ, CHECKED>::set_left(const pds::version_t new_version){
 
     PDS_THROW_IF_NULL_TRACKER("set_left", new_version);
 
     try{
-        ptr->table.at(track_version)->left.nodes_versions.push_back(new_version);
-        return ptr->table.at(track_version)->left.table[new_version];
+        pds::pFatNodePtr<OBJ>& left = ptr->table.at(track_version)->left;
+
+        if(left.nodes_versions.back() != new_version){
+            left.nodes_versions.push_back(new_version);
+        }
+        return left.table[new_version];
     }
     catch(const std::out_of_range&){
 
@@ -344,14 +432,18 @@ std::shared_ptr<pds::pFatNode<OBJ>>& pds::pSetTracker<OBJ>::set_left(const pds::
     }
 }
 
-template <class OBJ>
-std::shared_ptr<pds::pFatNode<OBJ>>& pds::pSetTracker<OBJ>::set_right(const pds::version_t new_version){
+template <class OBJ, bool CHECKED>
+std::shared_ptr<pds::pFatNode<OBJ>>& pds::pSetTracker<OBJ, CHECKED>::set_right(const pds::version_t new_version){
 
     PDS_THROW_IF_NULL_TRACKER("set_right", track_version);
 
     try{
-        ptr->table.at(track_version)->right.nodes_versions.push_back(new_version);
-        return ptr->table.at(track_version)->right.table[new_version];
+        pds::pFatNodePtr<OBJ>& right = ptr->table.at(track_version)->right;
+
+        if(right.nodes_versions.back() != new_version){
+            right.nodes_versions.push_back(new_version);
+        }
+        return right.table[new_version];
     }
     catch(const std::out_of_range&){
 
@@ -361,12 +453,35 @@ std::shared_ptr<pds::pFatNode<OBJ>>& pds::pSetTracker<OBJ>::set_right(const pds:
     }
 }
 
-template <class OBJ>
-void pds::pSetTracker<OBJ>::set_track_version(const pds::version_t new_version){
+template <class OBJ, bool CHECKED>
+void pds::pSetTracker<OBJ, CHECKED>::set_track_version(const pds::version_t new_version){
 
     PDS_THROW_IF_NULL_TRACKER("set_track_version", new_version);
 
     track_version = new_version;
 }
 
+template <class OBJ, bool CHECKED>
+pds::pSetTracker<OBJ, CHECKED>& pds::pSetTracker<OBJ, CHECKED>::split(const pds::version_t new_version){
+
+    if constexpr(std::is_copy_constructible_v<OBJ>){
+
+        std::shared_ptr<pds::pFatNode<OBJ>> node = **this;
+
+        if(node == nullptr || (node->left.nodes_versions.size() < pFatNodeCapacity 
+                                && node->right.nodes_versions.size() < pFatNodeCapacity))
+            return *this;
+
+        auto copy = node->left.make_node(node->get_obj(), new_version);
+
+        copy->left.table[new_version] = node->left.table.at(node->left.nodes_versions.back());
+        copy->right.table[new_version] = node->right.table.at(node->right.nodes_versions.back());
+
+        (*this)[new_version] = copy;
+        track_version = new_version;
+        node->next = copy;
+    }
+    return *this;
+}
+
 #endif /* PERSISTENT_SET_TRACKER_HPP */
\ No newline at end of file
@@ -31,12 +31,15 @@ namespace pds{
      * of the set after each modification. Each version is preserved, enabling search and get
      *  methods for any past state of the set.
      * 
-     * @tparam OBJ The object type, which must support `operator<` for sorting and provide
+     * @tparam OBJ The object type, which must be ordered by COMPARE and provide
      *             either copy or move constructors.
      * 
+     * @tparam COMPARE The order of the objects, see @ref pds::fpSet.
+     * 
      * @note Space Complexity: O(N)
      *       - N represents the number of versions maintained (i.e., `last_version`).
-     *       - Every object is saved only once, regardless of how many versions it exists in.
+     *       - An object is saved once, and copied again only when its fat node is full
+     *         (see @ref pds::pFatNodeCapacity).
      * 
      * @example
      * ```
@@ -48,12 +51,13 @@ namespace pds{
      * assert(vrsSet.contains(5, 2) == true);
      * ```
      */
-    template <class OBJ>
+    template <class OBJ, class COMPARE = std::less<>>
     class pSet{
 
         pds::pFatNodePtr<OBJ> root;    ///< root of a BST that save the data
         pds::version_t last_version;    ///< in the range of [1, MAX_size_t]
-        std::vector<pds::version_t> sizes;  ///< keep the size for each version (including 0 for MasterVersion)
+        std::pmr::vector<pds::version_t> sizes;  ///< keep the size for each version (including 0 for MasterVersion)
+        [[no_unique_address]] COMPARE compare;   ///< the order of the objects.
 
     public:
         /**
@@ -62,8 +66,12 @@ namespace pds{
          * @details Also insert two init Versions:
          *  - Version 0: see @ref MasterVersion.
          *  - Version 1: will save the init state version. (will always be empty).
+         * 
+         * @param resource the memory of the nodes, their fat pointers and the sizes. Must outlive the set.
+         * @param compare the order of the objects.
          */
-        pSet();
+        explicit pSet(std::pmr::memory_resource* resource = std::pmr::get_default_resource(), 
+                      COMPARE compare = COMPARE());
 
 
         /**
@@ -162,6 +170,30 @@ namespace pds{
          *  while N is the number of versions, i.e. N is last_version.
          */
         bool contains(const OBJ& obj, pds::version_t version = MasterVersion);
+
+        /// @brief @ref contains of a 'key' that a transparent COMPARE compares with the objects, see @ref pds::fpSet::contains.
+        template <class KEY> requires pds::fpTransparent<COMPARE>
+        bool contains(const KEY& key, pds::version_t version = MasterVersion);
+
+
+        /**
+         * @brief Check if 'obj' exists in 'version', without validating 'version'.
+         * 
+         * The hot path of @ref contains: a single lookup per level and no exception machinery.
+         * 
+         * @param obj the object to query for.
+         * 
+         * @param version version to check for.
+         * @attention 'version' must be in the range [0, curr_version()], otherwise the behavior is undefined.
+         * 
+         * @exception No exceptions (unless COMPARE throws).
+         *
+         * @return true if 'obj' exists in 'version', false otherwise.
+         */
+        bool contains_unchecked(const OBJ& obj, pds::version_t version);
+
+        template <class KEY> requires pds::fpTransparent<COMPARE>
+        bool contains_unchecked(const KEY& key, pds::version_t version);
     
 
         /**
@@ -232,72 +264,87 @@ namespace pds{
          */
         template <typename T>
         pds::version_t insert_impl(T&& obj);
+
+        /// @brief the lookup of @ref contains_unchecked, for an OBJ or a KEY.
+        template <class KEY>
+        bool find_unchecked(const KEY& key, pds::version_t version);
     };
 };
 
 
-template <class OBJ>
-pds::pSet<OBJ>::pSet() : root(1), last_version(1), sizes{0, 0} {
+template <class OBJ, class COMPARE>
+pds::pSet<OBJ, COMPARE>::pSet(std::pmr::memory_resource* resource, COMPARE compare) 
+
+    : root(1, resource), last_version(1), sizes({0, 0}, resource), compare(std::move(compare)) {
 }
 
-template <class OBJ>
-pds::version_t pds::pSet<OBJ>::insert(const OBJ& obj){
+template <class OBJ, class COMPARE>
+pds::version_t pds::pSet<OBJ, COMPARE>::insert(const OBJ& obj){
 
     return insert_impl(obj);
 }
 
-template <class OBJ>
-pds::version_t pds::pSet<OBJ>::insert(OBJ&& obj){
+template <class OBJ, class COMPARE>
+pds::version_t pds::pSet<OBJ, COMPARE>::insert(OBJ&& obj){
 
     return insert_impl(std::move(obj));
 }
 
-template <class OBJ>
+template <class OBJ, class COMPARE>
 template <typename T>
-pds::version_t pds::pSet<OBJ>::insert_impl(T&& obj){
+pds::version_t pds::pSet<OBJ, COMPARE>::insert_impl(T&& obj){
+
+    if(contains_unchecked(obj, last_version))
+        throw pds::ObjectAlreadyExist(
+            "pSet::insert: Version " + std::to_string(last_version) + " already contains this object"
+        );
+
+    pds::version_t new_version = last_version + 1;
 
     pds::pSetTracker<OBJ> tracker(root);
 
-    while(tracker.not_null()){
+    while(tracker.split(new_version).not_null()){
 
-        if(obj < tracker.obj()){
+        if(compare(obj, tracker.obj())){
 
             tracker = tracker.left();
         }
-        else if(tracker.obj() < obj){
-
-            tracker = tracker.right();
-        }
         else{
-            throw pds::ObjectAlreadyExist(
-                "pSet::insert: Version " + std::to_string(last_version) + " already contains this object"
-            );
+            tracker = tracker.right();
         }
     }
 
-    pds::version_t new_version = last_version + 1;
-
     pds::pSetTracker<OBJ> track_master(root);
 
     while(track_master.not_null_at(MasterVersion)){
 
-        if(obj < track_master.obj_at(MasterVersion)){
+        if(compare(obj, track_master.obj_at(MasterVersion))){
 
             track_master = track_master.left_at(MasterVersion);
         }
-        else if(track_master.obj_at(MasterVersion) < obj){
+        else if(compare(track_master.obj_at(MasterVersion), obj)){
 
             track_master = track_master.right_at(MasterVersion);
         }
         else{
-            tracker[new_version] = track_master.at(MasterVersion);
+            std::shared_ptr<pds::pFatNode<OBJ>> master = track_master.at(MasterVersion);
+            std::shared_ptr<pds::pFatNode<OBJ>> node = master;
+
+            // A node that was split is inserted again through its latest copy.
+            for(auto copy = node->next.lock(); copy != nullptr; copy = copy->next.lock()){
+                node = copy;
+            }
+            if(node != master){
+                master->next = node;
+            }
+            tracker[new_version] = node;
             break;
         }
     }
 
     if(track_master.null_at(MasterVersion)){
 
-        track_master[MasterVersion] = std::make_shared<pds::pFatNode<OBJ>>(std::forward<T>(obj), new_version);
+        track_master[MasterVersion] = root.make_node(std::forward<T>(obj), new_version);
 
         ++sizes[MasterVersion];
         tracker[new_version] = track_master.at(MasterVersion);
@@ -305,6 +352,10 @@ pds::version_t pds::pSet<OBJ>::insert_impl(T&& obj){
     else{
         tracker.set_track_version(new_version);
 
+        if(tracker.left_null() == false || tracker.right_null() == false){
+
+            tracker.split(new_version);
+        }
         if(tracker.left_null() == false){
 
             tracker.set_left(new_version) = nullptr;
@@ -320,37 +371,39 @@ pds::version_t pds::pSet<OBJ>::insert_impl(T&& obj){
     return (last_version = new_version);
 }
 
-template <class OBJ>
-pds::version_t pds::pSet<OBJ>::remove(OBJ&& obj){
+template <class OBJ, class COMPARE>
+pds::version_t pds::pSet<OBJ, COMPARE>::remove(OBJ&& obj){
 
     return remove(std::as_const(obj));
 }
 
-template <class OBJ>
-pds::version_t pds::pSet<OBJ>::remove(const OBJ& obj){
+template <class OBJ, class COMPARE>
+pds::version_t pds::pSet<OBJ, COMPARE>::remove(const OBJ& obj){
+
+    if(!contains_unchecked(obj, last_version))
+        throw pds::ObjectNotExist(
+            "pds::pset::remove: Attempting to remove an object but the object is not exists" 
+        );
+
+    pds::version_t new_version = last_version + 1;
 
     pds::pSetTracker<OBJ> tracker(root);
 
-    while(tracker.not_null()){
+    while(true){
+
+        tracker.split(new_version);
 
-        if(obj < tracker.obj()){
+        if(compare(obj, tracker.obj())){
 
             tracker = tracker.left();
         }
-        else if(tracker.obj() < obj){
+        else if(compare(tracker.obj(), obj)){
 
             tracker = tracker.right();
         }
         else break;
     }
 
-    if(tracker.null())
-        throw pds::ObjectNotExist(
-            "pds::pset::remove: Attempting to remove an object but the object is not exists" 
-        );
-
-    pds::version_t new_version = last_version + 1;
-
     pds::pSetTracker<OBJ> to_remove = tracker;
     pds::pSetTracker<OBJ> track_to_leaf = tracker;
 
@@ -363,25 +416,33 @@ pds::version_t pds::pSet<OBJ>::remove(const OBJ& obj){
         to_remove[new_version] = tracker.get_left();
     }
     else{
-        track_to_leaf = track_to_leaf.right();
+        track_to_leaf = track_to_leaf.right().split(new_version);
+
+        // 'tracker' may track the removed node by 'new_version' (if it was split), 
+        // so its children are read before 'new_version' is written over it.
+        std::shared_ptr<pds::pFatNode<OBJ>> removed_left = tracker.get_left();
 
         if(track_to_leaf.left_null()){
 
             to_remove[new_version] = *track_to_leaf;
             to_remove.set_track_version(new_version);
-            to_remove.set_left(new_version) = tracker.get_left();
+            to_remove.set_left(new_version) = removed_left;
         }
         else{
             while(!track_to_leaf.left_null()){
 
-                track_to_leaf = track_to_leaf.left();
+                track_to_leaf = track_to_leaf.left().split(new_version);
             }
+            std::shared_ptr<pds::pFatNode<OBJ>> successor = *track_to_leaf;
+
             track_to_leaf[new_version] = track_to_leaf.get_right();
 
-            to_remove[new_version] = *track_to_leaf;
+            std::shared_ptr<pds::pFatNode<OBJ>> removed_right = tracker.get_right();
+
+            to_remove[new_version] = successor;
             to_remove.set_track_version(new_version);
-            to_remove.set_left(new_version) = tracker.get_left();
-            to_remove.set_right(new_version) = tracker.get_right();
+            to_remove.set_left(new_version) = removed_left;
+            to_remove.set_right(new_version) = removed_right;
         }
     }
     // push the size of the new version
@@ -390,38 +451,67 @@ pds::version_t pds::pSet<OBJ>::remove(const OBJ& obj){
     return (last_version = new_version);
 }
 
-template <class OBJ>
-bool pds::pSet<OBJ>::contains(const OBJ& obj, pds::version_t version) {
+template <class OBJ, class COMPARE>
+bool pds::pSet<OBJ, COMPARE>::contains(const OBJ& obj, pds::version_t version) {
 
     PDS_THROW_IF_VERSION_NOT_EXIST("pSet::contains", version, last_version);
 
-    pds::pSetTracker<OBJ> tracker(root);
+    return contains_unchecked(obj, version);
+}
+
+template <class OBJ, class COMPARE>
+template <class KEY> requires pds::fpTransparent<COMPARE>
+bool pds::pSet<OBJ, COMPARE>::contains(const KEY& key, pds::version_t version) {
+
+    PDS_THROW_IF_VERSION_NOT_EXIST("pSet::contains", version, last_version);
+
+    return find_unchecked(key, version);
+}
+
+template <class OBJ, class COMPARE>
+bool pds::pSet<OBJ, COMPARE>::contains_unchecked(const OBJ& obj, pds::version_t version) {
+
+    return find_unchecked(obj, version);
+}
+
+template <class OBJ, class COMPARE>
+template <class KEY> requires pds::fpTransparent<COMPARE>
+bool pds::pSet<OBJ, COMPARE>::contains_unchecked(const KEY& key, pds::version_t version) {
+
+    return find_unchecked(key, version);
+}
+
+template <class OBJ, class COMPARE>
+template <class KEY>
+bool pds::pSet<OBJ, COMPARE>::find_unchecked(const KEY& key, pds::version_t version) {
+
+    pds::pSetTracker<OBJ, false> tracker(root, version);
 
     while(tracker.not_null_at(version)){
 
-        if(obj < tracker.obj_at(version)){
+        if(compare(key, tracker.obj_at(version))){
 
-            tracker = tracker.left_at(version);
+            tracker.left_at(version);
         }
-        else if(tracker.obj_at(version) < obj){
+        else if(compare(tracker.obj_at(version), key)){
 
-            tracker = tracker.right_at(version);
+            tracker.right_at(version);
         }
         else return true;
     }
     return false; 
 }
 
-template <class OBJ>
-std::vector<OBJ> pds::pSet<OBJ>::to_vector(const pds::version_t version) {
+template <class OBJ, class COMPARE>
+std::vector<OBJ> pds::pSet<OBJ, COMPARE>::to_vector(const pds::version_t version) {
 
     PDS_THROW_IF_VERSION_NOT_EXIST("pSet::to_vector", version, last_version);
 
     std::vector<OBJ> obj_vec;
 
     /*** Inorder Stack Traversal ***/
-    std::stack<pds::pSetTracker<OBJ>> trav_stack;
-    pds::pSetTracker<OBJ> tracker(root);
+    std::stack<pds::pSetTracker<OBJ, false>> trav_stack;
+    pds::pSetTracker<OBJ, false> tracker(root, version);
 
     while(tracker.not_null_at(version) || !trav_stack.empty()){
 
@@ -439,8 +529,8 @@ std::vector<OBJ> pds::pSet<OBJ>::to_vector(const pds::version_t version) {
     return obj_vec;
 }
 
-template <class OBJ>
-std::size_t pds::pSet<OBJ>::size(pds::version_t version) const { 
+template <class OBJ, class COMPARE>
+std::size_t pds::pSet<OBJ, COMPARE>::size(pds::version_t version) const { 
     
     try{
         return sizes.at(version);
@@ -451,14 +541,14 @@ std::size_t pds::pSet<OBJ>::size(pds::version_t version) const {
     }
 }
 
-template <class OBJ>
-pds::version_t pds::pSet<OBJ>::curr_version() const {
+template <class OBJ, class COMPARE>
+pds::version_t pds::pSet<OBJ, COMPARE>::curr_version() const {
 
     return last_version;
 }
 
-template <class OBJ>
-void pds::pSet<OBJ>::print(pds::version_t version){
+template <class OBJ, class COMPARE>
+void pds::pSet<OBJ, COMPARE>::print(pds::version_t version){
 
     PDS_THROW_IF_VERSION_NOT_EXIST("pSet::print", version, last_version);
 